@@ -0,0 +1,130 @@
+#include "durable_file.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>  // NOLINT
+#include <stdexcept>
+#include <utility>
+
+namespace bustub {
+
+namespace {
+
+std::mutex hook_latch;  // NOLINT
+DurabilityHook hook;
+
+auto Failure(std::string_view owner, const char *what, const std::string &path, int error) -> std::runtime_error {
+  return std::runtime_error(std::string(owner) + ": " + what + " " + path + ": " + std::strerror(error));
+}
+
+// Closes a file descriptor and removes the temporary file it was opened for, unless that file was renamed into
+// place
+class TempFile {
+ public:
+  TempFile(std::string path, int fd) : path_(std::move(path)), fd_(fd) {}
+  TempFile(const TempFile &) = delete;
+  auto operator=(const TempFile &) -> TempFile & = delete;
+  ~TempFile() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    if (!kept_) {
+      ::unlink(path_.c_str());
+    }
+  }
+
+  auto Path() const -> const std::string & { return path_; }
+  auto Fd() const -> int { return fd_; }
+
+  // Close the descriptor, reporting a failed write-back. Returns errno, or 0.
+  auto Close() -> int {
+    int result = ::close(fd_);
+    fd_ = -1;
+    return result == 0 ? 0 : errno;
+  }
+
+  void Keep() { kept_ = true; }
+
+ private:
+  std::string path_;
+  int fd_;
+  bool kept_{false};
+};
+
+}  // namespace
+
+void SetDurabilityHook(DurabilityHook new_hook) {
+  std::scoped_lock lock(hook_latch);
+  hook = std::move(new_hook);
+}
+
+void RunDurabilityHook(DurabilityStep step, const std::string &path) {
+  DurabilityHook current;
+  {
+    std::scoped_lock lock(hook_latch);
+    current = hook;
+  }
+  if (current) {
+    current(step, path);
+  }
+}
+
+void WriteFileDurably(const std::string &path, std::string_view data, std::string_view owner) {
+  std::string temp_path = path + ".tmp";
+  int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw Failure(owner, "cannot create", temp_path, errno);
+  }
+  TempFile temp(std::move(temp_path), fd);
+
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t n = ::write(temp.Fd(), data.data() + written, data.size() - written);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      throw Failure(owner, "cannot write", temp.Path(), errno);
+    }
+    written += n;
+  }
+
+  RunDurabilityHook(DurabilityStep::kSyncFile, temp.Path());
+  if (::fsync(temp.Fd()) != 0) {
+    throw Failure(owner, "cannot sync", temp.Path(), errno);
+  }
+  if (int error = temp.Close(); error != 0) {
+    throw Failure(owner, "cannot write", temp.Path(), error);
+  }
+
+  RunDurabilityHook(DurabilityStep::kRename, path);
+  if (std::rename(temp.Path().c_str(), path.c_str()) != 0) {
+    throw Failure(owner, "cannot rename", temp.Path(), errno);
+  }
+  temp.Keep();
+  SyncParentDirectory(path, owner);
+}
+
+void SyncParentDirectory(const std::string &path, std::string_view owner) {
+  std::filesystem::path parent = std::filesystem::path(path).parent_path();
+  const std::string directory = parent.empty() ? std::string(".") : parent.native();
+  RunDurabilityHook(DurabilityStep::kSyncDirectory, directory);
+  int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    throw Failure(owner, "cannot open", directory, errno);
+  }
+  int result = ::fsync(fd);
+  int error = errno;
+  ::close(fd);
+  if (result != 0) {
+    throw Failure(owner, "cannot sync", directory, error);
+  }
+}
+
+}  // namespace bustub
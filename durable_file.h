@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// durable_file.h
+//
+// Identification: src/include/primer/durable_file.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace bustub {
+
+// The steps that make a write survive a crash, in the order `WriteFileDurably` takes them.
+enum class DurabilityStep : uint8_t {
+  // fsync of a fully written temporary file.
+  kSyncFile,
+  // rename of the synced temporary file over its final path.
+  kRename,
+  // fsync of the directory holding the renamed file, which makes the rename itself durable.
+  kSyncDirectory,
+  // Truncation of a write-ahead log whose records a durable checkpoint holds.
+  kTruncateLog,
+  // fdatasync of a write-ahead log after an append, or on request.
+  kSyncLog,
+};
+
+// Called before each step with the path the step applies to. A hook that throws makes the step fail as the I/O
+// would, so a test can both observe the order of the steps and simulate a crash between any two of them.
+using DurabilityHook = std::function<void(DurabilityStep step, const std::string &path)>;
+
+// Install `hook` for every later step, or remove it with nullptr. Meant for tests.
+void SetDurabilityHook(DurabilityHook hook);
+
+// Call the installed hook, if any.
+void RunDurabilityHook(DurabilityStep step, const std::string &path);
+
+// Replace the file at `path` with `data`: write a temporary file next to it, fsync it, rename it over `path` and
+// fsync the directory. A crash leaves either the old file or the whole new one, and once this returns the new one
+// survives a crash. The temporary file is removed if any step fails. Throws std::runtime_error on I/O errors, with
+// messages prefixed by `owner`.
+void WriteFileDurably(const std::string &path, std::string_view data, std::string_view owner);
+
+// fsync the directory holding `path`, so that a create, rename or remove of `path` survives a crash.
+void SyncParentDirectory(const std::string &path, std::string_view owner);
+
+}  // namespace bustub
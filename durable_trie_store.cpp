@@ -0,0 +1,197 @@
+#include "durable_trie_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+
+namespace bustub {
+
+namespace {
+
+// Parse "checkpoint-<generation>-<sequence>" into its two numbers. Temporary files do not match.
+auto ParseCheckpointName(const std::string &name) -> std::optional<std::pair<uint64_t, uint64_t>> {
+  unsigned long long generation = 0;  // NOLINT
+  unsigned long long sequence = 0;    // NOLINT
+  char tail = 0;
+  if (std::sscanf(name.c_str(), "checkpoint-%llu-%llu%c", &generation, &sequence, &tail) != 2) {  // NOLINT
+    return std::nullopt;
+  }
+  return std::make_pair(static_cast<uint64_t>(generation), static_cast<uint64_t>(sequence));
+}
+
+// Every checkpoint file in `directory`: generation -> sequences, both in ascending order.
+auto ListCheckpoints(const std::string &directory) -> std::map<uint64_t, std::vector<uint64_t>> {
+  std::map<uint64_t, std::vector<uint64_t>> checkpoints;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    if (auto parsed = ParseCheckpointName(entry.path().filename().string())) {
+      checkpoints[parsed->first].push_back(parsed->second);
+    }
+  }
+  for (auto &[generation, sequences] : checkpoints) {
+    std::sort(sequences.begin(), sequences.end());
+  }
+  return checkpoints;
+}
+
+}  // namespace
+
+DurableTrieStore::DurableTrieStore(const std::string &directory, WalSyncPolicy sync, TrieLayout layout)
+    : directory_((std::filesystem::create_directories(directory), directory)), wal_(directory_ + "/wal", sync) {
+  // The chain to load is the newest generation whose base made it to disk. A crash while writing a base leaves the
+  // previous generation complete, and one while writing a delta leaves a shorter but consistent chain.
+  Trie trie(layout);
+  auto checkpoints = ListCheckpoints(directory_);
+  for (auto it = checkpoints.rbegin(); it != checkpoints.rend(); ++it) {
+    const auto &[generation, sequences] = *it;
+    std::vector<std::string> paths;
+    for (uint64_t sequence : sequences) {
+      if (sequence != paths.size()) {
+        break;
+      }
+      paths.push_back(CheckpointPath(generation, sequence));
+    }
+    if (paths.empty()) {
+      continue;
+    }
+    auto [loaded, checkpointer] = TrieCheckpointer::Load(paths);
+    trie = std::move(loaded);
+    checkpointer_ = std::move(checkpointer);
+    generation_ = generation;
+    sequence_ = paths.size() - 1;
+    break;
+  }
+
+  // Replay the log over the checkpoint. After a crash between a checkpoint and the truncation of the log, the
+  // checkpoint already holds these writes; replaying them again is harmless, since every key they touch still ends
+  // with its last logged write.
+  WriteBatch batch;
+  stats_.recovered_ = wal_.Recover(batch);
+  if (!batch.Empty()) {
+    trie = trie.Apply(std::move(batch));
+  }
+  store_ = std::make_unique<TrieStore>(std::move(trie));
+}
+
+void DurableTrieStore::Remove(std::string_view key) {
+  WriteBatch batch;
+  batch.Remove(key);
+  Commit(std::move(batch));
+}
+
+void DurableTrieStore::Apply(WriteBatch batch) {
+  if (batch.Empty()) {
+    return;
+  }
+  Commit(std::move(batch));
+}
+
+void DurableTrieStore::Commit(WriteBatch batch) {
+  PendingWrite write;
+  WriteAheadLog::Encode(batch, write.records_);
+  write.batch_ = std::move(batch);
+
+  std::unique_lock<std::mutex> lock(queue_latch_);
+  queue_.push_back(&write);
+  queue_cv_.wait(lock, [&] { return write.done_ || !committing_; });
+  if (write.done_) {
+    // A leader committed our write along with its group
+    if (write.error_) {
+      std::rethrow_exception(write.error_);
+    }
+    return;
+  }
+
+  // Lead the next group: every write queued so far, ours included
+  committing_ = true;
+  std::vector<PendingWrite *> group;
+  group.swap(queue_);
+  lock.unlock();
+
+  std::exception_ptr error;
+  try {
+    std::string records;
+    WriteBatch merged;
+    for (PendingWrite *member : group) {
+      records.append(member->records_);
+      merged.Append(std::move(member->batch_));
+    }
+    // Nothing reaches the store before the log holds it, so a failed append leaves the group entirely undone
+    wal_.Append(records);
+    store_->Apply(std::move(merged));
+  } catch (...) {
+    error = std::current_exception();
+  }
+
+  lock.lock();
+  for (PendingWrite *member : group) {
+    member->done_ = true;
+    member->error_ = error;
+  }
+  if (!error) {
+    stats_.writes_ += group.size();
+    stats_.commits_++;
+  }
+  committing_ = false;
+  lock.unlock();
+  queue_cv_.notify_all();
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void DurableTrieStore::BeginExclusive() {
+  std::unique_lock<std::mutex> lock(queue_latch_);
+  queue_cv_.wait(lock, [&] { return !committing_; });
+  committing_ = true;
+}
+
+void DurableTrieStore::EndExclusive() {
+  {
+    std::scoped_lock lock(queue_latch_);
+    committing_ = false;
+  }
+  queue_cv_.notify_all();
+}
+
+void DurableTrieStore::Checkpoint(bool full) {
+  // No group commits meanwhile, so the snapshot holds exactly the writes the log holds
+  BeginExclusive();
+  try {
+    Trie trie = store_->Snapshot();
+    if (full || generation_ == 0) {
+      uint64_t previous = generation_;
+      checkpointer_.WriteBase(trie, CheckpointPath(previous + 1, 0));
+      generation_ = previous + 1;
+      sequence_ = 0;
+      // The new base is in place: the older chains are no longer needed
+      for (const auto &[generation, sequences] : ListCheckpoints(directory_)) {
+        if (generation < generation_) {
+          for (uint64_t sequence : sequences) {
+            std::filesystem::remove(CheckpointPath(generation, sequence));
+          }
+        }
+      }
+    } else {
+      checkpointer_.WriteDelta(trie, CheckpointPath(generation_, sequence_ + 1));
+      sequence_++;
+    }
+    // The checkpoint and its directory entry are on stable storage by now, so dropping the log loses nothing
+    wal_.Truncate();
+  } catch (...) {
+    EndExclusive();
+    throw;
+  }
+  EndExclusive();
+}
+
+auto DurableTrieStore::GetStats() const -> Stats {
+  std::scoped_lock lock(queue_latch_);
+  return stats_;
+}
+
+auto DurableTrieStore::CheckpointPath(uint64_t generation, uint64_t sequence) const -> std::string {
+  return directory_ + "/checkpoint-" + std::to_string(generation) + "-" + std::to_string(sequence);
+}
+
+}  // namespace bustub
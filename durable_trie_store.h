@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// durable_trie_store.h
+//
+// Identification: src/include/primer/durable_trie_store.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "trie_checkpoint.h"
+#include "trie_snapshot.h"
+#include "trie_store.h"
+#include "trie_wal.h"
+
+namespace bustub {
+
+// A DurableTrieStore is a TrieStore whose writes survive a restart. It keeps its state in a directory holding a
+// write-ahead log and a chain of checkpoints (see TrieCheckpointer).
+//
+// Writes use group commit. A writer encodes its records and queues them. If no commit is in progress, it becomes the
+// leader of a group made of every queued write: it appends all of their records with one write (and, with
+// `WalSyncPolicy::kEveryCommit`, one fdatasync), applies them to the store as a single WriteBatch, i.e. one root swap,
+// and then wakes the group. Writers arriving meanwhile queue up for the next group, so under load the cost of a sync
+// is shared by every writer that waited for it. Reads never touch the log.
+//
+// Opening a store recovers it: the latest checkpoint chain is loaded and the log replayed on top of it through
+// `Trie::Apply`. `Checkpoint` persists the current snapshot and empties the log.
+//
+// Only values a snapshot can hold (uint32_t, uint64_t and std::string) can be stored.
+class DurableTrieStore {
+ public:
+  // Open the store in `directory`, creating it if needed. `layout` is used only when the directory has no checkpoint.
+  explicit DurableTrieStore(const std::string &directory, WalSyncPolicy sync = WalSyncPolicy::kEveryCommit,
+                            TrieLayout layout = TrieLayout::kPerCharacter);
+
+  template <class T>
+  auto Get(std::string_view key) -> std::optional<ValueGuard<T>> {
+    return store_->Get<T>(key);
+  }
+
+  // Put `value` at `key`. With `WalSyncPolicy::kEveryCommit`, the write is durable when this returns.
+  template <class T>
+  void Put(std::string_view key, T value, uint64_t score = 0) {
+    static_assert(sizeof(SnapshotValue<T>) > 0, "the value type cannot be logged");
+    WriteBatch batch;
+    batch.Put<T>(key, std::move(value), score);
+    Commit(std::move(batch));
+  }
+
+  void Remove(std::string_view key);
+
+  // Apply all operations of `batch` atomically and durably. Throws std::invalid_argument, before logging anything, if
+  // a value cannot be logged.
+  void Apply(WriteBatch batch);
+
+  auto Snapshot() const -> Trie { return store_->Snapshot(); }
+
+  // Persist the current snapshot and empty the log. Only the nodes written since the previous checkpoint are saved,
+  // unless `full` is set or there is no checkpoint yet: then a new chain is started with a base file, and the files
+  // of the previous chain are deleted. The log is emptied only once the checkpoint file and its directory entry are
+  // synced, so a crash at any point leaves every committed write in the checkpoints or in the log.
+  void Checkpoint(bool full = false);
+
+  // Force the log to stable storage, for `WalSyncPolicy::kNone`.
+  void Sync() { wal_.Sync(); }
+
+  struct Stats {
+    // Number of Put, Remove and Apply calls committed.
+    uint64_t writes_;
+    // Number of groups committed. Each group is one log append (and sync) and one root swap.
+    uint64_t commits_;
+    // Number of logged operations replayed when the store was opened.
+    uint64_t recovered_;
+  };
+
+  auto GetStats() const -> Stats;
+
+ private:
+  // A write waiting for its group to be committed.
+  struct PendingWrite {
+    WriteBatch batch_;
+    std::string records_;
+    bool done_{false};
+    std::exception_ptr error_;
+  };
+
+  void Commit(WriteBatch batch);
+
+  // Wait until no group is being committed and keep others from committing, or let them again.
+  void BeginExclusive();
+  void EndExclusive();
+
+  auto CheckpointPath(uint64_t generation, uint64_t sequence) const -> std::string;
+
+  std::string directory_;
+
+  // The current checkpoint chain is made of the files "checkpoint-<generation>-<sequence>", sequence 0 being the
+  // base. `sequence_` is the last file of the chain; `generation_` is 0 when there is no checkpoint.
+  TrieCheckpointer checkpointer_;
+  uint64_t generation_{0};
+  uint64_t sequence_{0};
+
+  WriteAheadLog wal_;
+  std::unique_ptr<TrieStore> store_;
+
+  // Protects everything below.
+  mutable std::mutex queue_latch_;
+  std::condition_variable queue_cv_;
+  std::vector<PendingWrite *> queue_;
+  // Set while a leader commits a group, or a checkpoint runs.
+  bool committing_{false};
+  Stats stats_{0, 0, 0};
+};
+
+}  // namespace bustub
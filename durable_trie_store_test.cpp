@@ -0,0 +1,291 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// durable_trie_store_test.cpp
+//
+// Identification: test/primer/durable_trie_store_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "durable_file.h"
+#include "durable_trie_store.h"
+#include "test.h"
+
+namespace bustub {
+
+namespace {
+
+// A fresh, empty directory for one test.
+auto StoreDirectory(const std::string &name) -> std::string {
+  auto path = std::filesystem::temp_directory_path() / ("durable_trie_store_test_" + name);
+  std::filesystem::remove_all(path);
+  return path.string();
+}
+
+// Installs a durability hook for the lifetime of the guard.
+class DurabilityHookGuard {
+ public:
+  explicit DurabilityHookGuard(DurabilityHook hook) { SetDurabilityHook(std::move(hook)); }
+  DurabilityHookGuard(const DurabilityHookGuard &) = delete;
+  auto operator=(const DurabilityHookGuard &) -> DurabilityHookGuard & = delete;
+  ~DurabilityHookGuard() { SetDurabilityHook(nullptr); }
+};
+
+}  // namespace
+
+TEST(DurableTrieStoreTest, RecoveryTest) {
+  auto directory = StoreDirectory("recovery");
+  {
+    DurableTrieStore store(directory);
+    for (uint32_t i = 0; i < 100; i++) {
+      store.Put<uint32_t>("key" + std::to_string(i), i);
+    }
+    store.Put<std::string>("name", "bustub", 7);
+    store.Remove("key42");
+    WriteBatch batch;
+    batch.Put<uint64_t>("big", 1ULL << 40);
+    batch.Remove("key0");
+    store.Apply(std::move(batch));
+  }
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(store.GetStats().recovered_, 104);
+  ASSERT_EQ(**store.Get<std::string>("name"), "bustub");
+  ASSERT_EQ(**store.Get<uint64_t>("big"), 1ULL << 40);
+  ASSERT_EQ(**store.Get<uint32_t>("key99"), 99);
+  ASSERT_TRUE(!store.Get<uint32_t>("key42").has_value());
+  ASSERT_TRUE(!store.Get<uint32_t>("key0").has_value());
+  auto top = store.Snapshot().TopK("", 1);
+  ASSERT_EQ(top.size(), 1);
+  ASSERT_EQ(top[0].first, "name");
+}
+
+TEST(DurableTrieStoreTest, CheckpointTest) {
+  auto directory = StoreDirectory("checkpoint");
+  {
+    DurableTrieStore store(directory, WalSyncPolicy::kNone, TrieLayout::kPathCompressed);
+    for (uint32_t i = 0; i < 100; i++) {
+      store.Put<uint32_t>("key" + std::to_string(i), i);
+    }
+    store.Checkpoint();
+    ASSERT_EQ(std::filesystem::file_size(directory + "/wal"), 0);
+    store.Put<uint32_t>("key1", 1000);
+    store.Checkpoint();
+    store.Remove("key2");
+    store.Sync();
+  }
+
+  {
+    // Two checkpoints, then one logged write
+    DurableTrieStore store(directory);
+    ASSERT_EQ(store.GetStats().recovered_, 1);
+    ASSERT_TRUE(store.Snapshot().GetLayout() == TrieLayout::kPathCompressed);
+    ASSERT_EQ(**store.Get<uint32_t>("key1"), 1000);
+    ASSERT_EQ(**store.Get<uint32_t>("key3"), 3);
+    ASSERT_TRUE(!store.Get<uint32_t>("key2").has_value());
+
+    // A full checkpoint replaces the chain
+    store.Checkpoint(true);
+    store.Put<uint32_t>("key3", 3000);
+  }
+  size_t checkpoints = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    checkpoints += entry.path().filename().string().rfind("checkpoint-", 0) == 0 ? 1 : 0;
+  }
+  ASSERT_EQ(checkpoints, 1);
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(**store.Get<uint32_t>("key1"), 1000);
+  ASSERT_EQ(**store.Get<uint32_t>("key3"), 3000);
+  ASSERT_TRUE(!store.Get<uint32_t>("key2").has_value());
+}
+
+TEST(DurableTrieStoreTest, CheckpointOrderTest) {
+  auto directory = StoreDirectory("order");
+  {
+    DurableTrieStore store(directory, WalSyncPolicy::kNone);
+    store.Put<uint32_t>("a", 1);
+
+    // The checkpoint is synced, renamed into place and its directory synced before the log is dropped
+    std::vector<std::pair<DurabilityStep, std::string>> steps;
+    {
+      DurabilityHookGuard guard([&](DurabilityStep step, const std::string &path) { steps.emplace_back(step, path); });
+      store.Checkpoint();
+    }
+    auto checkpoint = directory + "/checkpoint-1-0";
+    std::vector<std::pair<DurabilityStep, std::string>> expected = {
+        {DurabilityStep::kSyncFile, checkpoint + ".tmp"},
+        {DurabilityStep::kRename, checkpoint},
+        {DurabilityStep::kSyncDirectory, directory},
+        {DurabilityStep::kTruncateLog, directory + "/wal"},
+    };
+    ASSERT_TRUE(steps == expected);
+
+    // A crash before any of these steps completes keeps the log, and leaves no temporary file behind
+    for (auto failing : {DurabilityStep::kSyncFile, DurabilityStep::kRename, DurabilityStep::kSyncDirectory}) {
+      store.Put<uint32_t>("b", static_cast<uint32_t>(failing));
+      DurabilityHookGuard guard([&](DurabilityStep step, const std::string &path) {
+        if (step == failing) {
+          throw std::runtime_error("injected failure at " + path);
+        }
+      });
+      bool thrown = false;
+      try {
+        store.Checkpoint();
+      } catch (const std::runtime_error &) {
+        thrown = true;
+      }
+      ASSERT_TRUE(thrown);
+      ASSERT_TRUE(std::filesystem::file_size(directory + "/wal") > 0);
+      ASSERT_TRUE(!std::filesystem::exists(directory + "/checkpoint-1-1.tmp"));
+    }
+    store.Sync();
+  }
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+  ASSERT_EQ(**store.Get<uint32_t>("b"), static_cast<uint32_t>(DurabilityStep::kSyncDirectory));
+  store.Checkpoint();
+  ASSERT_EQ(std::filesystem::file_size(directory + "/wal"), 0);
+}
+
+TEST(DurableTrieStoreTest, TornLogTest) {
+  auto directory = StoreDirectory("torn");
+  {
+    DurableTrieStore store(directory);
+    store.Put<uint32_t>("a", 1);
+    store.Put<uint32_t>("b", 2);
+  }
+  // Cut the last record short, as a crash in the middle of an append would
+  auto wal = directory + "/wal";
+  std::filesystem::resize_file(wal, std::filesystem::file_size(wal) - 3);
+
+  {
+    DurableTrieStore store(directory);
+    ASSERT_EQ(store.GetStats().recovered_, 1);
+    ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+    ASSERT_TRUE(!store.Get<uint32_t>("b").has_value());
+    // New records follow the last good one
+    store.Put<uint32_t>("c", 3);
+  }
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(store.GetStats().recovered_, 2);
+  ASSERT_EQ(**store.Get<uint32_t>("c"), 3);
+}
+
+TEST(DurableTrieStoreTest, TornBatchTest) {
+  auto directory = StoreDirectory("torn_batch");
+  {
+    DurableTrieStore store(directory);
+    store.Put<uint32_t>("a", 1);
+    WriteBatch batch;
+    batch.Put<uint32_t>("b", 2);
+    batch.Remove("a");
+    batch.Put<std::string>("c", "three");
+    store.Apply(std::move(batch));
+  }
+  // Cut into the last operation of the batch: its first two operations are on disk, yet none of it may be replayed
+  auto wal = directory + "/wal";
+  std::filesystem::resize_file(wal, std::filesystem::file_size(wal) - 2);
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(store.GetStats().recovered_, 1);
+  ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+  ASSERT_TRUE(!store.Get<uint32_t>("b").has_value());
+  ASSERT_TRUE(!store.Get<std::string>("c").has_value());
+}
+
+TEST(DurableTrieStoreTest, FailedAppendTest) {
+  auto directory = StoreDirectory("failed_append");
+  {
+    DurableTrieStore store(directory);
+    store.Put<uint32_t>("a", 1);
+    {
+      // The record is written, but its sync fails: the commit throws and the record is cut off again
+      DurabilityHookGuard guard([](DurabilityStep step, const std::string &path) {
+        if (step == DurabilityStep::kSyncLog) {
+          throw std::runtime_error("injected failure at " + path);
+        }
+      });
+      bool thrown = false;
+      try {
+        store.Put<uint32_t>("b", 2);
+      } catch (const std::runtime_error &) {
+        thrown = true;
+      }
+      ASSERT_TRUE(thrown);
+      ASSERT_TRUE(!store.Get<uint32_t>("b").has_value());
+    }
+    // Later commits follow the last good record
+    store.Put<uint32_t>("c", 3);
+  }
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(store.GetStats().recovered_, 2);
+  ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+  ASSERT_TRUE(!store.Get<uint32_t>("b").has_value());
+  ASSERT_EQ(**store.Get<uint32_t>("c"), 3);
+}
+
+TEST(DurableTrieStoreTest, GroupCommitTest) {
+  auto directory = StoreDirectory("group");
+  constexpr int kThreads = 8;
+  constexpr int kWrites = 200;
+  {
+    DurableTrieStore store(directory);
+    std::vector<std::thread> threads;
+    threads.reserve(kThreads);
+    for (int t = 0; t < kThreads; t++) {
+      threads.emplace_back([&store, t] {
+        for (int i = 0; i < kWrites; i++) {
+          store.Put<uint32_t>(std::to_string(t) + "/" + std::to_string(i), i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto stats = store.GetStats();
+    ASSERT_EQ(stats.writes_, kThreads * kWrites);
+    // Writers waiting on a sync share the next one
+    ASSERT_TRUE(stats.commits_ < stats.writes_);
+  }
+
+  DurableTrieStore store(directory);
+  ASSERT_EQ(store.GetStats().recovered_, kThreads * kWrites);
+  for (int t = 0; t < kThreads; t++) {
+    for (int i = 0; i < kWrites; i++) {
+      ASSERT_EQ(**store.Get<uint32_t>(std::to_string(t) + "/" + std::to_string(i)), i);
+    }
+  }
+}
+
+TEST(DurableTrieStoreTest, UnloggableValueTest) {
+  auto directory = StoreDirectory("unloggable");
+  DurableTrieStore store(directory);
+  WriteBatch batch;
+  batch.Put<uint32_t>("a", 1);
+  batch.Put<int>("b", 2);
+  bool thrown = false;
+  try {
+    store.Apply(std::move(batch));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+  ASSERT_TRUE(!store.Get<uint32_t>("a").has_value());
+  ASSERT_EQ(std::filesystem::file_size(directory + "/wal"), 0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,95 @@
+#include "epoch_manager.h"
+
+#include <functional>
+#include <limits>
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+auto EpochManager::Pin() -> Guard {
+  if (auto guard = TryPin(); guard.has_value()) {
+    return std::move(*guard);
+  }
+  // Every slot is taken, e.g. by long-lived guards. Waiting for one could deadlock a thread that holds them all, so
+  // pin an overflow slot instead. Reclaim scans these under the same latch, so it either sees the pin or ran
+  // entirely before it, when nothing it released was reachable any more.
+  std::lock_guard<std::mutex> guard(overflow_latch_);
+  uint64_t epoch = global_epoch_.load(std::memory_order_seq_cst);
+  for (auto &slot : overflow_) {
+    if (slot.epoch_.load(std::memory_order_relaxed) == 0) {
+      slot.epoch_.store(epoch, std::memory_order_seq_cst);
+      return Guard(&slot.epoch_);
+    }
+  }
+  auto &slot = overflow_.emplace_back();
+  slot.epoch_.store(epoch, std::memory_order_seq_cst);
+  return Guard(&slot.epoch_);
+}
+
+auto EpochManager::TryPin() -> std::optional<Guard> {
+  // Start probing at a per-thread position, so that concurrent readers rarely compete for the same slot
+  thread_local const size_t start = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  for (size_t i = 0; i < kSlots; i++) {
+    auto &slot = slots_[(start + i) % kSlots].epoch_;
+    uint64_t expected = 0;
+    if (slot.load(std::memory_order_relaxed) == 0 &&
+        slot.compare_exchange_strong(expected, global_epoch_.load(std::memory_order_seq_cst),
+                                     std::memory_order_seq_cst)) {
+      // The pin is published before the reader loads anything it protects. Any object the reader can still find
+      // is retired after this point, with an epoch no smaller than the pinned one, so Reclaim keeps it.
+      return Guard(&slot);
+    }
+  }
+  return std::nullopt;
+}
+
+void EpochManager::Retire(std::shared_ptr<const void> object) {
+  uint64_t epoch = global_epoch_.fetch_add(1, std::memory_order_seq_cst);
+  std::lock_guard<std::mutex> guard(retired_latch_);
+  retired_.emplace_back(epoch, std::move(object));
+}
+
+auto EpochManager::Reclaim() -> size_t {
+  uint64_t oldest = std::numeric_limits<uint64_t>::max();
+  auto scan = [&](const Slot &slot) {
+    uint64_t epoch = slot.epoch_.load(std::memory_order_seq_cst);
+    if (epoch != 0 && epoch < oldest) {
+      oldest = epoch;
+    }
+  };
+  for (const auto &slot : slots_) {
+    scan(slot);
+  }
+  {
+    std::lock_guard<std::mutex> guard(overflow_latch_);
+    for (const auto &slot : overflow_) {
+      scan(slot);
+    }
+  }
+
+  // Move the releasable objects out under the latch, and drop them after it: freeing a snapshot can take a while.
+  std::vector<std::shared_ptr<const void>> released;
+  {
+    std::lock_guard<std::mutex> guard(retired_latch_);
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); i++) {
+      if (retired_[i].first < oldest) {
+        released.push_back(std::move(retired_[i].second));
+      } else {
+        if (kept != i) {
+          retired_[kept] = std::move(retired_[i]);
+        }
+        kept++;
+      }
+    }
+    retired_.resize(kept);
+  }
+  return released.size();
+}
+
+auto EpochManager::RetiredCount() const -> size_t {
+  std::lock_guard<std::mutex> guard(retired_latch_);
+  return retired_.size();
+}
+
+}  // namespace bustub
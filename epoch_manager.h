@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// epoch_manager.h
+//
+// Identification: src/include/primer/epoch_manager.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+// An EpochManager implements epoch-based reclamation. A reader `Pin`s the current epoch for as long as it uses
+// objects it found through a shared structure; a writer that unlinks an object `Retire`s it instead of dropping it,
+// and `Reclaim` releases, in bulk, every retired object that no pinned reader can still see.
+//
+// Retired objects are held as `std::shared_ptr<const void>`, so "releasing" one drops the manager's reference: for a
+// retired trie snapshot that frees every node no newer snapshot shares, all at once.
+class EpochManager {
+ public:
+  // Number of readers that can pin an epoch in a slot of their own, without taking a lock, at the same time. Further
+  // readers pin their epoch in an overflow slot, found or added under a latch.
+  static constexpr size_t kSlots = 128;
+
+  class Guard {
+   public:
+    Guard(Guard &&that) noexcept : slot_(std::exchange(that.slot_, nullptr)) {}
+    auto operator=(Guard &&that) noexcept -> Guard & {
+      if (this != &that) {
+        Release();
+        slot_ = std::exchange(that.slot_, nullptr);
+      }
+      return *this;
+    }
+    Guard(const Guard &) = delete;
+    auto operator=(const Guard &) -> Guard & = delete;
+    ~Guard() { Release(); }
+
+   private:
+    friend class EpochManager;
+    explicit Guard(std::atomic<uint64_t> *slot) : slot_(slot) {}
+    void Release() {
+      if (slot_ != nullptr) {
+        slot_->store(0, std::memory_order_release);
+        slot_ = nullptr;
+      }
+    }
+
+    // The epoch of the slot this guard pins, nullptr once released.
+    std::atomic<uint64_t> *slot_;
+  };
+
+  EpochManager() = default;
+  EpochManager(const EpochManager &) = delete;
+  auto operator=(const EpochManager &) -> EpochManager & = delete;
+
+  // Pin the current epoch until the guard is destroyed. Objects retired after this call are not released while the
+  // guard lives. Never waits for a slot: when every slot is taken, an overflow slot is used.
+  auto Pin() -> Guard;
+
+  // Like `Pin`, but returns std::nullopt instead of using an overflow slot when every slot is taken.
+  auto TryPin() -> std::optional<Guard>;
+
+  // Hand `object` over to the manager. It is released by a later `Reclaim` once every reader that might still see
+  // it has unpinned.
+  void Retire(std::shared_ptr<const void> object);
+
+  // Release every retired object no pinned reader can see. Returns the number of objects released.
+  auto Reclaim() -> size_t;
+
+  // Number of objects retired and not yet released.
+  auto RetiredCount() const -> size_t;
+
+ private:
+  struct alignas(64) Slot {
+    // The epoch pinned by the reader owning this slot, 0 if the slot is free.
+    std::atomic<uint64_t> epoch_{0};
+  };
+
+  std::array<Slot, kSlots> slots_;
+  std::atomic<uint64_t> global_epoch_{1};
+
+  mutable std::mutex overflow_latch_;
+  // Slots for the readers beyond `kSlots`. A deque never moves its elements, so guards can point into it. It only
+  // grows, to the largest number of overflow pins held at once.
+  std::deque<Slot> overflow_;
+
+  mutable std::mutex retired_latch_;
+  // Retired objects with the epoch they were retired in.
+  std::vector<std::pair<uint64_t, std::shared_ptr<const void>>> retired_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+#include "node_pool.h"
+
+#include <new>
+
+namespace bustub {
+
+auto NodePool::Create(size_t slab_size) -> std::shared_ptr<NodePool> {
+  // The handle only drops the pool's own reference; blocks still in use keep the pool alive
+  return {new NodePool(slab_size), [](NodePool *pool) { pool->Unref(); }};
+}
+
+NodePool::~NodePool() {
+  for (auto *slab : slabs_) {
+    ::operator delete(slab, std::align_val_t{64});
+  }
+}
+
+void NodePool::Unref() noexcept {
+  if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete this;
+  }
+}
+
+auto NodePool::Allocate(size_t bytes) -> void * {
+  if (bytes == 0 || bytes > kMaxBlockSize) {
+    void *block = ::operator new(bytes);
+    refs_.fetch_add(1, std::memory_order_relaxed);
+    return block;
+  }
+
+  size_t index = (bytes - 1) / kGranularity;
+  size_t block_size = (index + 1) * kGranularity;
+  SizeClass &size_class = classes_[index];
+
+  void *block = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(size_class.latch_);
+    if (size_class.free_ != nullptr) {
+      block = size_class.free_;
+      size_class.free_ = size_class.free_->next_;
+    } else {
+      if (size_class.bump_ == size_class.bump_end_) {
+        // Carve this size class a new slab
+        auto *slab = static_cast<std::byte *>(::operator new(slab_size_, std::align_val_t{64}));
+        {
+          std::lock_guard<std::mutex> slab_guard(slab_latch_);
+          slabs_.push_back(slab);
+        }
+        size_class.bump_ = slab;
+        size_class.bump_end_ = slab + slab_size_ / block_size * block_size;
+      }
+      block = size_class.bump_;
+      size_class.bump_ += block_size;
+    }
+  }
+  refs_.fetch_add(1, std::memory_order_relaxed);
+  return block;
+}
+
+void NodePool::Deallocate(void *block, size_t bytes) noexcept {
+  if (bytes == 0 || bytes > kMaxBlockSize) {
+    ::operator delete(block);
+  } else {
+    SizeClass &size_class = classes_[(bytes - 1) / kGranularity];
+    std::lock_guard<std::mutex> guard(size_class.latch_);
+    auto *free_block = static_cast<FreeBlock *>(block);
+    free_block->next_ = size_class.free_;
+    size_class.free_ = free_block;
+  }
+  Unref();
+}
+
+auto NodePool::GetStats() const -> Stats {
+  std::lock_guard<std::mutex> guard(slab_latch_);
+  return {slabs_.size() * slab_size_, refs_.load(std::memory_order_relaxed) - 1};
+}
+
+}  // namespace bustub
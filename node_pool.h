@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// node_pool.h
+//
+// Identification: src/include/primer/node_pool.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+// A NodePool is a size-class allocator for trie nodes and values. Small blocks are carved out of large slabs and
+// recycled through per-size-class free lists, so a write-heavy trie stops going through malloc for every node and
+// its nodes stay packed in a few slabs instead of fragmenting the heap. All slabs are returned to the system in bulk
+// when the pool goes away.
+//
+// A pool is created with `Create` and shared by the tries that allocate from it. Memory handed out by the pool keeps
+// the pool alive: it is destroyed only once the last handle is gone *and* every block has been returned, so a node
+// may safely outlive every trie that references the pool.
+class NodePool {
+ public:
+  // Blocks up to this size come from the pool; larger requests go to the global allocator.
+  static constexpr size_t kMaxBlockSize = 512;
+  static constexpr size_t kDefaultSlabSize = 64 * 1024;
+
+  // Create a pool carving slabs of `slab_size` bytes, or of `kMaxBlockSize` bytes if that is smaller, so that every
+  // slab holds at least one block of any size class.
+  static auto Create(size_t slab_size = kDefaultSlabSize) -> std::shared_ptr<NodePool>;
+
+  NodePool(const NodePool &) = delete;
+  auto operator=(const NodePool &) -> NodePool & = delete;
+
+  auto Allocate(size_t bytes) -> void *;
+  void Deallocate(void *block, size_t bytes) noexcept;
+
+  struct Stats {
+    // Bytes reserved in slabs.
+    size_t slab_bytes_;
+    // Number of blocks currently handed out.
+    size_t blocks_in_use_;
+  };
+
+  auto GetStats() const -> Stats;
+
+ private:
+  static constexpr size_t kGranularity = 16;
+  static constexpr size_t kNumClasses = kMaxBlockSize / kGranularity;
+
+  struct FreeBlock {
+    FreeBlock *next_;
+  };
+
+  struct alignas(64) SizeClass {
+    std::mutex latch_;
+    FreeBlock *free_{nullptr};
+    std::byte *bump_{nullptr};
+    std::byte *bump_end_{nullptr};
+  };
+
+  explicit NodePool(size_t slab_size) : slab_size_(std::max(slab_size, kMaxBlockSize)) {}
+  ~NodePool();
+
+  void Unref() noexcept;
+
+  const size_t slab_size_;
+  std::array<SizeClass, kNumClasses> classes_;
+
+  mutable std::mutex slab_latch_;
+  std::vector<std::byte *> slabs_;
+
+  // One reference for the handles returned by Create, plus one per block in use.
+  std::atomic<size_t> refs_{1};
+};
+
+// A standard allocator drawing from a NodePool, for use with `std::allocate_shared`.
+template <class T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+
+  explicit PoolAllocator(NodePool *pool) noexcept : pool_(pool) {}
+
+  template <class U>
+  PoolAllocator(const PoolAllocator<U> &that) noexcept : pool_(that.pool_) {}  // NOLINT
+
+  auto allocate(size_t n) -> T * {  // NOLINT
+    static_assert(alignof(T) <= 16, "NodePool blocks are 16-byte aligned");
+    return static_cast<T *>(pool_->Allocate(n * sizeof(T)));
+  }
+  void deallocate(T *p, size_t n) noexcept { pool_->Deallocate(p, n * sizeof(T)); }  // NOLINT
+
+  template <class U>
+  auto operator==(const PoolAllocator<U> &that) const -> bool {
+    return pool_ == that.pool_;
+  }
+
+  NodePool *pool_;
+};
+
+// Create a shared object (node or value) with `pool`, or with `std::make_shared` when `pool` is nullptr. Either
+// way the object and its control block take one allocation.
+template <class T, class... Args>
+auto MakePooled(NodePool *pool, Args &&...args) -> std::shared_ptr<T> {
+  if (pool == nullptr) {
+    return std::make_shared<T>(std::forward<Args>(args)...);
+  }
+  return std::allocate_shared<T>(PoolAllocator<T>(pool), std::forward<Args>(args)...);
+}
+
+}  // namespace bustub
@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// node_pool_test.cpp
+//
+// Identification: test/primer/node_pool_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "epoch_manager.h"
+#include "node_pool.h"
+#include "test.h"
+#include "trie.h"
+#include "trie_builder.h"
+#include "trie_stats.h"
+
+namespace bustub {
+
+TEST(NodePoolTest, RecycleTest) {
+  auto pool = NodePool::Create();
+  void *a = pool->Allocate(40);
+  void *b = pool->Allocate(40);
+  ASSERT_TRUE(a != b);
+  ASSERT_EQ(pool->GetStats().blocks_in_use_, 2);
+  pool->Deallocate(a, 40);
+  // Blocks of the same size class are recycled.
+  void *c = pool->Allocate(48);
+  ASSERT_EQ(c, a);
+  pool->Deallocate(b, 40);
+  pool->Deallocate(c, 48);
+  ASSERT_EQ(pool->GetStats().blocks_in_use_, 0);
+  ASSERT_EQ(pool->GetStats().slab_bytes_, NodePool::kDefaultSlabSize);
+}
+
+TEST(NodePoolTest, SmallSlabTest) {
+  // Slabs smaller than the largest block are grown to fit it
+  auto pool = NodePool::Create(1);
+  std::vector<void *> blocks;
+  for (int i = 0; i < 3; i++) {
+    blocks.push_back(pool->Allocate(NodePool::kMaxBlockSize));
+    std::memset(blocks.back(), i, NodePool::kMaxBlockSize);
+  }
+  ASSERT_EQ(pool->GetStats().slab_bytes_, 3 * NodePool::kMaxBlockSize);
+  for (void *block : blocks) {
+    pool->Deallocate(block, NodePool::kMaxBlockSize);
+  }
+  ASSERT_EQ(pool->GetStats().blocks_in_use_, 0);
+}
+
+TEST(NodePoolTest, PooledTrieTest) {
+  std::shared_ptr<const TrieNode> escaped;
+  {
+    auto pool = NodePool::Create();
+    auto trie = Trie(TrieLayout::kPerCharacter, pool);
+    for (uint32_t i = 0; i < 1000; i++) {
+      trie = trie.Put<std::string>(std::to_string(i), "value-" + std::to_string(i));
+    }
+    for (uint32_t i = 0; i < 1000; i += 2) {
+      trie = trie.Remove(std::to_string(i));
+    }
+    ASSERT_TRUE(trie.GetNodePool() == pool);
+    ASSERT_TRUE(pool->GetStats().blocks_in_use_ > 0);
+    for (uint32_t i = 0; i < 1000; i++) {
+      const auto *value = trie.Get<std::string>(std::to_string(i));
+      if (i % 2 == 0) {
+        ASSERT_EQ(value, nullptr);
+      } else {
+        ASSERT_EQ(*value, "value-" + std::to_string(i));
+      }
+    }
+    escaped = trie.GetRoot();
+  }
+  // Nodes keep their pool alive after every trie using it is gone.
+  ASSERT_EQ(escaped->children_.size(), 9);
+  escaped = nullptr;
+}
+
+TEST(NodePoolTest, PooledBulkWriteTest) {
+  // Batches and builders allocate every node from the pool too: with inline values and no other user of the pool,
+  // the blocks in use are exactly the nodes of the trie
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto pool = NodePool::Create();
+    WriteBatch batch(pool);
+    for (uint32_t i = 0; i < 1000; i++) {
+      batch.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    auto applied = Trie(layout, pool).Apply(std::move(batch));
+    ASSERT_EQ(pool->GetStats().blocks_in_use_, applied.Stats().nodes_);
+    applied = Trie();
+
+    TrieBuilder builder(layout, pool);
+    std::vector<std::pair<std::string, uint32_t>> entries;
+    for (uint32_t i = 0; i < 1000; i++) {
+      builder.Put<uint32_t>("key/" + std::to_string(i), i);
+      entries.emplace_back("key/" + std::to_string(i), i);
+    }
+    std::sort(entries.begin(), entries.end());
+    auto built = builder.Freeze();
+    ASSERT_TRUE(built.GetNodePool() == pool);
+    ASSERT_EQ(pool->GetStats().blocks_in_use_, built.Stats().nodes_);
+    built = Trie();
+    auto parallel = TrieBuilder::BuildParallel(std::move(entries), layout, 4, pool);
+    ASSERT_TRUE(parallel.GetNodePool() == pool);
+    ASSERT_EQ(*parallel.Get<uint32_t>("key/42"), 42);
+    ASSERT_EQ(pool->GetStats().blocks_in_use_, parallel.Stats().nodes_);
+  }
+}
+
+TEST(EpochManagerTest, ReclaimTest) {
+  EpochManager epoch;
+  auto object = std::make_shared<int>(233);
+  std::weak_ptr<int> watch = object;
+  {
+    auto guard = epoch.Pin();
+    epoch.Retire(std::move(object));
+    // A reader pinned before the object was retired may still see it.
+    ASSERT_EQ(epoch.Reclaim(), 0);
+    ASSERT_TRUE(!watch.expired());
+  }
+  ASSERT_EQ(epoch.Reclaim(), 1);
+  ASSERT_TRUE(watch.expired());
+
+  // A reader pinned after the retirement does not hold the object back.
+  epoch.Retire(std::make_shared<int>(2333));
+  auto guard = epoch.Pin();
+  ASSERT_EQ(epoch.Reclaim(), 1);
+  ASSERT_EQ(epoch.RetiredCount(), 0);
+}
+
+TEST(EpochManagerTest, OverflowPinTest) {
+  EpochManager epoch;
+  std::vector<EpochManager::Guard> guards;
+  for (size_t i = 0; i < EpochManager::kSlots; i++) {
+    guards.push_back(epoch.Pin());
+  }
+  ASSERT_TRUE(!epoch.TryPin().has_value());
+
+  // With every slot taken, Pin does not wait: it pins an overflow slot, which holds back only the objects retired
+  // after it.
+  epoch.Retire(std::make_shared<int>(1));
+  auto overflow = epoch.Pin();
+  epoch.Retire(std::make_shared<int>(2));
+  guards.clear();
+  ASSERT_EQ(epoch.Reclaim(), 1);
+  ASSERT_EQ(epoch.RetiredCount(), 1);
+
+  // A released overflow slot is reused with the epoch of its new pin.
+  for (size_t i = 0; i < EpochManager::kSlots; i++) {
+    guards.push_back(epoch.Pin());
+  }
+  { auto released = std::move(overflow); }
+  auto later = epoch.Pin();
+  ASSERT_EQ(epoch.Reclaim(), 1);
+  epoch.Retire(std::make_shared<int>(3));
+  ASSERT_EQ(epoch.Reclaim(), 0);
+  { auto released = std::move(later); }
+  guards.clear();
+  ASSERT_EQ(epoch.Reclaim(), 1);
+}
+
+TEST(EpochManagerTest, ConcurrentPinTest) {
+  EpochManager epoch;
+  std::atomic<bool> stop{false};
+  std::atomic<std::shared_ptr<const int>> current{std::make_shared<const int>(0)};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        auto guard = epoch.Pin();
+        ASSERT_TRUE(*current.load() >= 0);
+      }
+    });
+  }
+  for (int i = 1; i <= 10000; i++) {
+    epoch.Retire(current.exchange(std::make_shared<const int>(i)));
+    if (i % 100 == 0) {
+      epoch.Reclaim();
+    }
+  }
+  stop = true;
+  for (auto &t : readers) {
+    t.join();
+  }
+  epoch.Reclaim();
+  ASSERT_EQ(epoch.RetiredCount(), 0);
+}
+
+}  // namespace bustub
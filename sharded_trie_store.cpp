@@ -0,0 +1,83 @@
+#include "sharded_trie_store.h"
+
+#include <stdexcept>
+
+namespace bustub {
+
+ShardedTrieStore::ShardedTrieStore(size_t shard_count, size_t prefix_bytes, TrieLayout layout)
+    : prefix_bytes_(prefix_bytes) {
+  if (shard_count == 0 || prefix_bytes == 0) {
+    throw std::invalid_argument("ShardedTrieStore: needs at least one shard and one prefix byte");
+  }
+  shards_.reserve(shard_count);
+  for (size_t i = 0; i < shard_count; i++) {
+    shards_.push_back(std::make_unique<Shard>(layout));
+  }
+}
+
+template <class T>
+void ShardedTrieStore::Put(std::string_view key, T value) {
+  // Move the value into its leaf before locking the shard: a slow move (e.g. a `MoveBlocked`) then holds up neither
+  // other writers of the shard nor `Snapshot`. Shards allocate from the global heap, as a default WriteBatch does.
+  WriteBatch batch;
+  batch.Put<T>(key, std::move(value));
+  auto &shard = ShardFor(key);
+  std::lock_guard<std::mutex> guard(shard.write_lock_);
+  shard.store_.Apply(std::move(batch));
+}
+
+void ShardedTrieStore::Remove(std::string_view key) {
+  WriteBatch batch;
+  batch.Remove(key);
+  auto &shard = ShardFor(key);
+  std::lock_guard<std::mutex> guard(shard.write_lock_);
+  shard.store_.Apply(std::move(batch));
+}
+
+void ShardedTrieStore::Apply(WriteBatch batch) {
+  // Split the batch by shard, keeping the order of the operations within each shard
+  std::vector<WriteBatch> parts(shards_.size());
+  for (auto &op : batch.ops_) {
+    parts[ShardOf(op.key_)].ops_.push_back(std::move(op));
+  }
+
+  // Lock the shards involved in shard order, so that concurrent batches and snapshots cannot deadlock
+  std::vector<std::unique_lock<std::mutex>> guards;
+  for (size_t i = 0; i < parts.size(); i++) {
+    if (!parts[i].Empty()) {
+      guards.emplace_back(shards_[i]->write_lock_);
+    }
+  }
+  for (size_t i = 0; i < parts.size(); i++) {
+    if (!parts[i].Empty()) {
+      shards_[i]->store_.Apply(std::move(parts[i]));
+    }
+  }
+}
+
+auto ShardedTrieStore::Snapshot() const -> ShardedTrieSnapshot {
+  std::vector<std::unique_lock<std::mutex>> guards;
+  guards.reserve(shards_.size());
+  for (const auto &shard : shards_) {
+    guards.emplace_back(shard->write_lock_);
+  }
+  std::vector<Trie> roots;
+  roots.reserve(shards_.size());
+  for (const auto &shard : shards_) {
+    roots.push_back(shard->store_.Snapshot());
+  }
+  return {std::move(roots), prefix_bytes_};
+}
+
+// Below are explicit instantiation of template functions.
+
+template void ShardedTrieStore::Put(std::string_view key, uint32_t value);
+template void ShardedTrieStore::Put(std::string_view key, uint64_t value);
+template void ShardedTrieStore::Put(std::string_view key, std::string value);
+
+using Integer = std::unique_ptr<uint32_t>;
+
+template void ShardedTrieStore::Put(std::string_view key, Integer value);
+template void ShardedTrieStore::Put(std::string_view key, MoveBlocked value);
+
+}  // namespace bustub
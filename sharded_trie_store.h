@@ -0,0 +1,215 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sharded_trie_store.h
+//
+// Identification: src/include/primer/sharded_trie_store.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "trie_iterator.h"
+#include "trie_store.h"
+
+namespace bustub {
+
+// The shard holding `key`: keys are spread over `shard_count` shards by a hash of their first `prefix_bytes` bytes,
+// so all keys sharing those bytes (e.g. one tenant's keys) live in the same shard.
+inline auto ShardOfKey(std::string_view key, size_t prefix_bytes, size_t shard_count) -> size_t {
+  return std::hash<std::string_view>{}(key.substr(0, prefix_bytes)) % shard_count;
+}
+
+// An input iterator over the (key, value) pairs of type T of several shards, in key order. Every shard is already
+// sorted and a key lives in a single shard, so this is a k-way merge: a min-heap holds the shards that are not
+// exhausted, ordered by their current key.
+template <class T>
+class ShardedTrieIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<std::string_view, const T &>;
+
+  explicit ShardedTrieIterator(std::vector<TrieIterator<T>> shards) : shards_(std::move(shards)) {
+    for (size_t i = 0; i < shards_.size(); i++) {
+      if (!shards_[i].IsEnd()) {
+        heap_.push_back(i);
+      }
+    }
+    std::make_heap(heap_.begin(), heap_.end(), Later{&shards_});
+  }
+
+  auto IsEnd() const -> bool { return heap_.empty(); }
+
+  // The current key. The view is invalidated when the iterator moves.
+  auto Key() const -> std::string_view { return shards_[heap_.front()].Key(); }
+
+  auto Value() const -> const T & { return shards_[heap_.front()].Value(); }
+
+  auto operator*() const -> value_type { return {Key(), Value()}; }
+  auto operator++() -> ShardedTrieIterator & {
+    Advance();
+    return *this;
+  }
+  void operator++(int) { Advance(); }
+
+  auto operator==(std::default_sentinel_t /*unused*/) const -> bool { return IsEnd(); }
+
+ private:
+  // Heap order: the shard with the smallest current key on top.
+  struct Later {
+    auto operator()(size_t a, size_t b) const -> bool { return (*shards_)[a].Key() > (*shards_)[b].Key(); }
+    const std::vector<TrieIterator<T>> *shards_;
+  };
+
+  void Advance() {
+    std::pop_heap(heap_.begin(), heap_.end(), Later{&shards_});
+    size_t shard = heap_.back();
+    ++shards_[shard];
+    if (shards_[shard].IsEnd()) {
+      heap_.pop_back();
+    } else {
+      std::push_heap(heap_.begin(), heap_.end(), Later{&shards_});
+    }
+  }
+
+  std::vector<TrieIterator<T>> shards_;
+  std::vector<size_t> heap_;
+};
+
+// The result of `ShardedTrieSnapshot::Scan` and `ShardedTrieSnapshot::Range`, to be used in a range-based for loop.
+template <class T>
+class ShardedTrieScan {
+ public:
+  explicit ShardedTrieScan(std::vector<TrieScan<T>> shards) : shards_(std::move(shards)) {}
+
+  auto begin() const -> ShardedTrieIterator<T> {  // NOLINT
+    std::vector<TrieIterator<T>> iterators;
+    iterators.reserve(shards_.size());
+    for (const auto &shard : shards_) {
+      iterators.push_back(shard.begin());
+    }
+    return ShardedTrieIterator<T>(std::move(iterators));
+  }
+  auto end() const -> std::default_sentinel_t { return std::default_sentinel; }  // NOLINT
+
+ private:
+  std::vector<TrieScan<T>> shards_;
+};
+
+// A consistent snapshot of every shard of a ShardedTrieStore, captured together: it holds either all or none of the
+// operations of any `ShardedTrieStore::Apply`. Like a Trie, it is immutable and stays valid regardless of later
+// writes.
+class ShardedTrieSnapshot {
+ public:
+  template <class T>
+  auto Get(std::string_view key) const -> const T * {
+    return shards_[ShardOfKey(key, prefix_bytes_, shards_.size())].Get<T>(key);
+  }
+
+  // Iterate, in key order, over the values of type T whose keys start with `prefix`. A prefix at least as long as
+  // the sharding prefix only visits the one shard that can hold its keys.
+  template <class T>
+  auto Scan(std::string_view prefix) const -> ShardedTrieScan<T> {
+    std::vector<TrieScan<T>> scans;
+    if (prefix.size() >= prefix_bytes_) {
+      scans.push_back(shards_[ShardOfKey(prefix, prefix_bytes_, shards_.size())].Scan<T>(prefix));
+    } else {
+      for (const auto &shard : shards_) {
+        scans.push_back(shard.Scan<T>(prefix));
+      }
+    }
+    return ShardedTrieScan<T>(std::move(scans));
+  }
+
+  // Iterate, in key order, over the values of type T whose keys are in [begin, end).
+  template <class T>
+  auto Range(std::string_view begin, std::string_view end) const -> ShardedTrieScan<T> {
+    std::vector<TrieScan<T>> scans;
+    for (const auto &shard : shards_) {
+      scans.push_back(shard.Range<T>(begin, end));
+    }
+    return ShardedTrieScan<T>(std::move(scans));
+  }
+
+  // The snapshot of each shard.
+  auto GetShards() const -> const std::vector<Trie> & { return shards_; }
+
+ private:
+  friend class ShardedTrieStore;
+
+  ShardedTrieSnapshot(std::vector<Trie> shards, size_t prefix_bytes)
+      : shards_(std::move(shards)), prefix_bytes_(prefix_bytes) {}
+
+  std::vector<Trie> shards_;
+  size_t prefix_bytes_;
+};
+
+// A ShardedTrieStore splits the keyspace over independent TrieStores by a hash of the first bytes of each key. Every
+// shard has its own root and its own write lock, so writes to keys of different shards (e.g. different tenants) run in
+// parallel, and readers of different shards never share a cache line.
+//
+// A write to one key only locks its shard. `Apply` locks every shard its batch touches, in shard order, and publishes
+// all of them before unlocking; `Snapshot` locks every shard the same way, so it sees each batch entirely or not at
+// all. Single-key `Get`s never lock: they see each shard atomically, but may see a batch spanning several shards
+// half-published.
+class ShardedTrieStore {
+ public:
+  static constexpr size_t kDefaultShardCount = 16;
+
+  // Create an empty store of `shard_count` shards, spreading keys by their first `prefix_bytes` bytes. Throws
+  // std::invalid_argument if either is 0.
+  explicit ShardedTrieStore(size_t shard_count = kDefaultShardCount, size_t prefix_bytes = 1,
+                            TrieLayout layout = TrieLayout::kPerCharacter);
+
+  template <class T>
+  auto Get(std::string_view key) -> std::optional<ValueGuard<T>> {
+    return ShardFor(key).store_.Get<T>(key);
+  }
+
+  template <class T>
+  void Put(std::string_view key, T value);
+
+  void Remove(std::string_view key);
+
+  // Apply all operations of `batch` atomically with respect to `Snapshot`.
+  void Apply(WriteBatch batch);
+
+  auto Snapshot() const -> ShardedTrieSnapshot;
+
+  auto ShardCount() const -> size_t { return shards_.size(); }
+
+  // The shard holding `key`.
+  auto ShardOf(std::string_view key) const -> size_t { return ShardOfKey(key, prefix_bytes_, shards_.size()); }
+
+ private:
+  struct Shard {
+    explicit Shard(TrieLayout layout) : store_(layout) {}
+
+    // Held while publishing to this shard. Taken together with other shards' locks in shard order only.
+    std::mutex write_lock_;
+    TrieStore store_;
+  };
+
+  auto ShardFor(std::string_view key) -> Shard & { return *shards_[ShardOf(key)]; }
+
+  // Each shard is allocated on its own, so no two shards share a cache line.
+  std::vector<std::unique_ptr<Shard>> shards_;
+  size_t prefix_bytes_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sharded_trie_store_test.cpp
+//
+// Identification: test/primer/sharded_trie_store_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <future>  // NOLINT
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "sharded_trie_store.h"
+#include "test.h"
+
+namespace bustub {
+
+namespace {
+
+template <class Scan>
+auto CollectKeys(const Scan &scan) -> std::vector<std::string> {
+  std::vector<std::string> keys;
+  for (auto [key, value] : scan) {
+    keys.emplace_back(key);
+  }
+  return keys;
+}
+
+}  // namespace
+
+TEST(ShardedTrieStoreTest, BasicTest) {
+  auto store = ShardedTrieStore(8, 2);
+  ASSERT_EQ(store.ShardCount(), 8);
+  store.Put<uint32_t>("a1/x", 1);
+  store.Put<std::string>("b2/y", "two");
+  store.Put<std::unique_ptr<uint32_t>>("c3/z", std::make_unique<uint32_t>(3));
+  ASSERT_EQ(**store.Get<uint32_t>("a1/x"), 1);
+  ASSERT_EQ(**store.Get<std::string>("b2/y"), "two");
+  ASSERT_EQ(***store.Get<std::unique_ptr<uint32_t>>("c3/z"), 3);
+  store.Remove("a1/x");
+  ASSERT_TRUE(!store.Get<uint32_t>("a1/x").has_value());
+  // Keys sharing the sharding prefix share a shard.
+  ASSERT_EQ(store.ShardOf("a1/x"), store.ShardOf("a1/anything"));
+
+  bool thrown = false;
+  try {
+    ShardedTrieStore(0);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+}
+
+TEST(ShardedTrieStoreTest, BlockedPutTest) {
+  auto store = ShardedTrieStore(1);
+  store.Put<uint32_t>("a", 1);
+  std::promise<int> x;
+
+  // This Put blocks inside MoveBlocked's move constructor, before it takes the shard's write lock
+  std::thread t([&store, &x] { store.Put<MoveBlocked>("b", MoveBlocked(x.get_future())); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Neither other writers of the shard nor snapshots wait for it
+  store.Put<uint32_t>("c", 3);
+  store.Remove("a");
+  auto snapshot = store.Snapshot();
+  ASSERT_TRUE(CollectKeys(snapshot.Scan<uint32_t>("")) == std::vector<std::string>{"c"});
+
+  x.set_value(233);
+  t.join();
+  ASSERT_TRUE(store.Get<MoveBlocked>("b").has_value());
+}
+
+TEST(ShardedTrieStoreTest, MergedScanTest) {
+  auto store = ShardedTrieStore(4, 1);
+  auto trie = Trie();
+  for (uint32_t i = 0; i < 500; i++) {
+    auto key = std::to_string(i * 7919 % 1000);
+    store.Put<uint32_t>(key, i);
+    trie = trie.Put<uint32_t>(key, i);
+  }
+  store.Put<std::string>("1-not-an-integer", "skipped");
+  auto snapshot = store.Snapshot();
+  ASSERT_EQ(snapshot.GetShards().size(), 4);
+  ASSERT_EQ(*snapshot.Get<uint32_t>(std::to_string(7919 % 1000)), 1);
+
+  // Merging the shards gives the same order as a single trie.
+  auto merged = CollectKeys(snapshot.Scan<uint32_t>(""));
+  auto single = CollectKeys(trie.Scan<uint32_t>(""));
+  ASSERT_EQ(merged.size(), 500);
+  ASSERT_TRUE(merged == single);
+  auto merged_prefix = CollectKeys(snapshot.Scan<uint32_t>("12"));
+  auto single_prefix = CollectKeys(trie.Scan<uint32_t>("12"));
+  ASSERT_TRUE(merged_prefix == single_prefix);
+  auto merged_range = CollectKeys(snapshot.Range<uint32_t>("3", "55"));
+  auto single_range = CollectKeys(trie.Range<uint32_t>("3", "55"));
+  ASSERT_TRUE(merged_range == single_range);
+}
+
+TEST(ShardedTrieStoreTest, ConsistentSnapshotTest) {
+  auto store = ShardedTrieStore(16, 1);
+  std::atomic<bool> stop{false};
+
+  // Every batch moves one unit between two keys, usually of different shards: a snapshot must always see the same sum.
+  std::vector<std::string> keys;
+  for (char c = 'a'; c <= 'p'; c++) {
+    keys.emplace_back(1, c);
+    store.Put<uint32_t>(keys.back(), 100);
+  }
+  // Writer t owns the keys i with i % 4 == t, so the values it reads cannot change under it.
+  std::vector<std::thread> writers;
+  for (size_t t = 0; t < 4; t++) {
+    writers.emplace_back([&, t] {
+      for (size_t i = 0; i < 2000; i++) {
+        const auto &from = keys[(i % 4) * 4 + t];
+        const auto &to = keys[((i + 1) % 4) * 4 + t];
+        auto snapshot = store.Snapshot();
+        uint32_t from_value = *snapshot.Get<uint32_t>(from);
+        uint32_t to_value = *snapshot.Get<uint32_t>(to);
+        if (from_value == 0) {
+          continue;
+        }
+        WriteBatch batch;
+        batch.Put<uint32_t>(from, from_value - 1);
+        batch.Put<uint32_t>(to, to_value + 1);
+        store.Apply(std::move(batch));
+      }
+    });
+  }
+  std::thread reader([&] {
+    while (!stop.load()) {
+      auto snapshot = store.Snapshot();
+      uint32_t sum = 0;
+      for (auto [key, value] : snapshot.Scan<uint32_t>("")) {
+        sum += value;
+      }
+      ASSERT_EQ(sum, 1600);
+    }
+  });
+  for (auto &t : writers) {
+    t.join();
+  }
+  stop = true;
+  reader.join();
+}
+
+TEST(ShardedTrieStoreTest, ConcurrentTenantTest) {
+  auto store = ShardedTrieStore(8, 1);
+  std::vector<std::thread> threads;
+  const int keys_per_tenant = 5000;
+  for (int tenant = 0; tenant < 8; tenant++) {
+    threads.emplace_back([&store, tenant] {
+      std::string prefix(1, static_cast<char>('A' + tenant));
+      for (int i = 0; i < keys_per_tenant; i++) {
+        store.Put<uint32_t>(prefix + std::to_string(i), i);
+      }
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+  auto snapshot = store.Snapshot();
+  for (int tenant = 0; tenant < 8; tenant++) {
+    std::string prefix(1, static_cast<char>('A' + tenant));
+    ASSERT_EQ(CollectKeys(snapshot.Scan<uint32_t>(prefix)).size(), keys_per_tenant);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,35 @@
+#include "string_arena.h"
+
+#include <cstring>
+
+namespace bustub {
+
+auto StringArena::Intern(std::string_view value) -> ArenaString {
+  if (value.empty()) {
+    return {};
+  }
+  std::scoped_lock lock(latch_);
+  if (value.size() > chunk_size_ / 4) {
+    std::shared_ptr<char[]> own(new char[value.size()]);
+    std::memcpy(own.get(), value.data(), value.size());
+    allocated_ += value.size();
+    const char *data = own.get();
+    return {std::move(own), data, value.size()};
+  }
+  if (chunk_ == nullptr || used_ + value.size() > chunk_size_) {
+    chunk_.reset(new char[chunk_size_]);
+    used_ = 0;
+    allocated_ += chunk_size_;
+  }
+  char *data = chunk_.get() + used_;
+  std::memcpy(data, value.data(), value.size());
+  used_ += value.size();
+  return {chunk_, data, value.size()};
+}
+
+auto StringArena::BytesAllocated() const -> size_t {
+  std::scoped_lock lock(latch_);
+  return allocated_;
+}
+
+}  // namespace bustub
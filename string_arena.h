@@ -0,0 +1,81 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// string_arena.h
+//
+// Identification: src/include/primer/string_arena.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <string_view>
+
+#include "trie.h"
+
+namespace bustub {
+
+// A string value whose bytes live in a StringArena chunk. It is a view plus a reference to its chunk, so it is
+// stored inline in its trie node (see `kInlineNodeValue`): a `Put<ArenaString>` allocates nothing once the bytes are
+// in the arena, and copying the node along with the value only bumps the chunk's reference count.
+class ArenaString {
+ public:
+  ArenaString() = default;
+
+  auto View() const -> std::string_view { return {data_, size_}; }
+  operator std::string_view() const { return View(); }  // NOLINT
+  auto Size() const -> size_t { return size_; }
+
+  auto operator==(const ArenaString &that) const -> bool { return View() == that.View(); }
+  auto operator==(std::string_view that) const -> bool { return View() == that; }
+
+ private:
+  friend class StringArena;
+
+  ArenaString(std::shared_ptr<const char[]> chunk, const char *data, size_t size)
+      : chunk_(std::move(chunk)), data_(data), size_(size) {}
+
+  std::shared_ptr<const char[]> chunk_;
+  const char *data_{""};
+  size_t size_{0};
+};
+
+template <>
+inline constexpr bool kInlineNodeValue<ArenaString> = true;
+
+// An append-only store for the bytes of ArenaString values. Strings are copied back to back into large chunks, so
+// millions of short strings cost their bytes and one shared allocation per chunk, instead of one allocation (and its
+// header and reference count) each.
+//
+// Chunks are reference counted by the strings in them: a chunk is freed once no trie version holds any of its
+// strings, and the arena itself may be destroyed before them. A chunk holding one live string stays allocated in
+// full, so an arena suits values that are dropped together, like the generations of a store. Thread-safe.
+class StringArena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 64 * 1024;
+
+  explicit StringArena(size_t chunk_size = kDefaultChunkSize) : chunk_size_(chunk_size) {}
+
+  // Copy `value` into the arena. Strings longer than a quarter of a chunk get a chunk of their own, so they do not
+  // waste the rest of the current one.
+  auto Intern(std::string_view value) -> ArenaString;
+
+  // Bytes of all chunks this arena has allocated, freed or not.
+  auto BytesAllocated() const -> size_t;
+
+ private:
+  const size_t chunk_size_;
+  mutable std::mutex latch_;
+  std::shared_ptr<char[]> chunk_;
+  size_t used_{0};
+  size_t allocated_{0};
+};
+
+}  // namespace bustub
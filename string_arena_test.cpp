@@ -0,0 +1,73 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// string_arena_test.cpp
+//
+// Identification: test/primer/string_arena_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "string_arena.h"
+#include "test.h"
+#include "trie_stats.h"
+#include "trie_store.h"
+
+namespace bustub {
+
+TEST(StringArenaTest, InternTest) {
+  StringArena arena(1024);
+  ASSERT_EQ(arena.BytesAllocated(), 0);
+  ASSERT_TRUE(arena.Intern("") == "");
+
+  std::vector<ArenaString> strings;
+  for (int i = 0; i < 1000; i++) {
+    strings.push_back(arena.Intern("value-" + std::to_string(i)));
+  }
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(strings[i].View(), "value-" + std::to_string(i));
+  }
+  // About 8 bytes per string, packed into 1 KB chunks
+  ASSERT_TRUE(arena.BytesAllocated() <= 9 * 1024);
+
+  // A long string gets a chunk of its own, and leaves the current one alone
+  std::string long_value(1000, 'x');
+  auto before = arena.BytesAllocated();
+  ASSERT_TRUE(arena.Intern(long_value) == long_value);
+  ASSERT_EQ(arena.BytesAllocated(), before + 1000);
+}
+
+TEST(StringArenaTest, TrieValueTest) {
+  auto arena = std::make_unique<StringArena>();
+  auto trie = Trie(TrieLayout::kPathCompressed);
+  for (int i = 0; i < 10000; i++) {
+    trie = trie.Put<ArenaString>("key/" + std::to_string(i), arena->Intern("value-" + std::to_string(i)));
+  }
+  auto old = trie;
+  trie = trie.Put<ArenaString>("key/42", arena->Intern("changed"));
+
+  // The strings outlive the arena: the trie versions hold their chunks
+  arena.reset();
+  for (int i = 0; i < 10000; i++) {
+    std::string key = "key/" + std::to_string(i);
+    ASSERT_EQ(old.Get<ArenaString>(key)->View(), "value-" + std::to_string(i));
+  }
+  ASSERT_EQ(trie.Get<ArenaString>("key/42")->View(), "changed");
+  ASSERT_TRUE(trie.Get<std::string>("key/42") == nullptr);
+
+  // Values are inline in their nodes
+  ASSERT_EQ(trie.Stats().value_bytes_, 0);
+
+  StringArena store_arena;
+  TrieStore store;
+  store.Put<ArenaString>("233", store_arena.Intern("2333"));
+  ASSERT_EQ((**store.Get<ArenaString>("233")).View(), "2333");
+}
+
+}  // namespace bustub
@@ -13,11 +13,32 @@
 #include "trie.h"
 #include "test.h"
 #include <format>
+#include <map>
+#include <numeric>
+#include <random>
 
 
 
 namespace bustub {
 
+using Integer = std::unique_ptr<uint32_t>;
+
+// In a path-compressed trie, no value-less node below the root may be left with fewer than two children.
+static bool IsCompact(const TrieNode *node) {
+  if (node == nullptr) {
+    return true;
+  }
+  for (const auto &[ch, child] : node->children_) {
+    if (!child->is_value_node_ && child->children_.size() < 2) {
+      return false;
+    }
+    if (!IsCompact(child.get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
 TEST(TrieTest, ConstructorTest) { auto trie = Trie(); }
 
 TEST(TrieTest, BasicPutTest) {
@@ -281,11 +302,496 @@ TEST(TrieTest, MixedTest) {
 TEST(TrieTest, PointerStability) {
   auto trie = Trie();
   trie = trie.Put<uint32_t>("test", 2333);
-  auto *ptr_before = trie.Get<std::string>("test");
+  const auto *ptr_before = trie.Get<uint32_t>("test");
+  ASSERT_TRUE(ptr_before != nullptr);
+  // Writes above "test" rebuild its ancestors only, so its node, and the value inlined in it, are shared
   trie = trie.Put<uint32_t>("tes", 233);
   trie = trie.Put<uint32_t>("te", 23);
-  auto *ptr_after = trie.Get<std::string>("test");
+  const auto *ptr_after = trie.Get<uint32_t>("test");
   ASSERT_EQ(reinterpret_cast<uint64_t>(ptr_before), reinterpret_cast<uint64_t>(ptr_after));
+  ASSERT_EQ(*ptr_after, 2333);
+}
+
+TEST(TrieTest, InlineValueTest) {
+  ASSERT_TRUE(kInlineNodeValue<uint32_t> && kInlineNodeValue<uint64_t>);
+  ASSERT_TRUE(!kInlineNodeValue<std::string> && !kInlineNodeValue<Integer>);
+
+  // Values stored out of line are shared by the rebuilt nodes of later versions
+  auto trie = Trie().Put<std::string>("test", "2333");
+  const auto *ptr_before = trie.Get<std::string>("test");
+  auto next = trie.Put<uint32_t>("tes", 233).Put<uint32_t>("testing", 23);
+  ASSERT_EQ(next.Get<std::string>("test"), ptr_before);
+
+  // Inline values are copied with their node; a pointer stays valid as long as its version
+  trie = Trie().Put<uint32_t>("a", 1);
+  const auto *inline_before = trie.Get<uint32_t>("a");
+  next = trie.Put<uint32_t>("ab", 2).Put<uint32_t>("a", 3);
+  ASSERT_EQ(*inline_before, 1);
+  ASSERT_EQ(*next.Get<uint32_t>("a"), 3);
+  ASSERT_EQ(*trie.Put<uint32_t>("ab", 2).Get<uint32_t>("a"), 1);
+}
+
+TEST(TrieTest, HighFanOutTest) {
+  // Exercise every child layout: inline, small sorted array and indexed array.
+  auto trie = Trie();
+  for (uint32_t i = 0; i < 256; i++) {
+    std::string key(1, static_cast<char>(i));
+    trie = trie.Put<uint32_t>(key, i);
+    trie = trie.Put<uint32_t>(key + "x", i + 1000);
+  }
+  ASSERT_EQ(trie.GetRoot()->children_.size(), 256);
+  for (uint32_t i = 0; i < 256; i++) {
+    std::string key(1, static_cast<char>(i));
+    ASSERT_EQ(*trie.Get<uint32_t>(key), i);
+    ASSERT_EQ(*trie.Get<uint32_t>(key + "x"), i + 1000);
+  }
+
+  // Children are kept in unsigned byte order.
+  int last = -1;
+  for (const auto &[ch, child] : trie.GetRoot()->children_) {
+    ASSERT_TRUE(static_cast<unsigned char>(ch) > last);
+    last = static_cast<unsigned char>(ch);
+  }
+
+  for (uint32_t i = 0; i < 256; i += 2) {
+    std::string key(1, static_cast<char>(i));
+    trie = trie.Remove(key + "x");
+    trie = trie.Remove(key);
+  }
+  ASSERT_EQ(trie.GetRoot()->children_.size(), 128);
+  for (uint32_t i = 0; i < 256; i++) {
+    std::string key(1, static_cast<char>(i));
+    if (i % 2 == 0) {
+      ASSERT_EQ(trie.Get<uint32_t>(key), nullptr);
+    } else {
+      ASSERT_EQ(*trie.Get<uint32_t>(key + "x"), i + 1000);
+    }
+  }
+}
+
+TEST(TrieTest, PathCompressionStructure) {
+  auto trie = Trie(TrieLayout::kPathCompressed);
+  trie = trie.Put<uint32_t>("tenant/service/cpu", 1);
+  // The whole key is one edge: root -> 't' -> leaf with the rest of the key as its segment.
+  auto root = trie.GetRoot();
+  ASSERT_EQ(root->children_.size(), 1);
+  ASSERT_EQ(root->children_.at('t')->segment_, "enant/service/cpu");
+  ASSERT_TRUE(root->children_.at('t')->is_value_node_);
+
+  // Diverging inside the segment splits it at the first differing byte.
+  trie = trie.Put<uint32_t>("tenant/service/mem", 2);
+  root = trie.GetRoot();
+  auto split = root->children_.at('t');
+  ASSERT_EQ(split->segment_, "enant/service/");
+  ASSERT_TRUE(!split->is_value_node_);
+  ASSERT_EQ(split->children_.size(), 2);
+  ASSERT_EQ(split->children_.at('c')->segment_, "pu");
+  ASSERT_EQ(split->children_.at('m')->segment_, "em");
+
+  // A key ending inside a segment splits it and puts the value on the new node.
+  trie = trie.Put<uint32_t>("tenant", 3);
+  ASSERT_EQ(trie.GetRoot()->children_.at('t')->segment_, "enant");
+  ASSERT_EQ(*trie.Get<uint32_t>("tenant"), 3);
+  ASSERT_EQ(*trie.Get<uint32_t>("tenant/service/cpu"), 1);
+  ASSERT_EQ(*trie.Get<uint32_t>("tenant/service/mem"), 2);
+  ASSERT_EQ(trie.Get<uint32_t>("tenant/service"), nullptr);
+  ASSERT_EQ(trie.Get<uint32_t>("tenant/service/cp"), nullptr);
+  ASSERT_EQ(trie.Get<uint32_t>("tenant/service/cpus"), nullptr);
+
+  // Removing keys merges value-less single-child nodes back into their child.
+  trie = trie.Remove("tenant");
+  trie = trie.Remove("tenant/service/mem");
+  root = trie.GetRoot();
+  ASSERT_EQ(root->children_.size(), 1);
+  ASSERT_EQ(root->children_.at('t')->segment_, "enant/service/cpu");
+  ASSERT_EQ(*trie.Get<uint32_t>("tenant/service/cpu"), 1);
+  trie = trie.Remove("tenant/service/cpu");
+  ASSERT_EQ(trie.GetRoot(), nullptr);
+}
+
+TEST(TrieTest, PathCompressionCopyOnWrite) {
+  auto empty_trie = Trie(TrieLayout::kPathCompressed);
+  auto trie1 = empty_trie.Put<uint32_t>("test", 2333);
+  auto trie2 = trie1.Put<uint32_t>("te", 23);
+  auto trie3 = trie2.Put<uint32_t>("tes", 233);
+  auto trie4 = trie3.Remove("te");
+  auto trie5 = trie3.Remove("tes");
+  auto trie6 = trie3.Remove("test");
+
+  ASSERT_EQ(*trie1.Get<uint32_t>("test"), 2333);
+  ASSERT_EQ(trie1.Get<uint32_t>("te"), nullptr);
+  ASSERT_EQ(*trie3.Get<uint32_t>("te"), 23);
+  ASSERT_EQ(*trie3.Get<uint32_t>("tes"), 233);
+  ASSERT_EQ(*trie3.Get<uint32_t>("test"), 2333);
+  ASSERT_EQ(trie4.Get<uint32_t>("te"), nullptr);
+  ASSERT_EQ(*trie4.Get<uint32_t>("tes"), 233);
+  ASSERT_EQ(trie5.Get<uint32_t>("tes"), nullptr);
+  ASSERT_EQ(*trie5.Get<uint32_t>("test"), 2333);
+  ASSERT_EQ(*trie6.Get<uint32_t>("tes"), 233);
+  ASSERT_EQ(trie6.Get<uint32_t>("test"), nullptr);
+  ASSERT_TRUE(trie6.GetLayout() == TrieLayout::kPathCompressed);
+
+  // Removing a missing key shares the whole trie.
+  ASSERT_EQ(trie3.Remove("tex").GetRoot(), trie3.GetRoot());
+  ASSERT_EQ(trie3.Remove("t").GetRoot(), trie3.GetRoot());
+}
+
+TEST(TrieTest, PathCompressionRandomTest) {
+  // Compare both layouts against std::map on random keys over a small alphabet, so that keys share long prefixes.
+  std::mt19937 rng(2333);
+  std::map<std::string, uint32_t> expected;
+  auto per_char = Trie();
+  auto compressed = Trie(TrieLayout::kPathCompressed);
+  for (uint32_t i = 0; i < 20000; i++) {
+    std::string key(rng() % 12, 'a');
+    for (auto &c : key) {
+      c = static_cast<char>('a' + rng() % 3);
+    }
+    if (rng() % 3 == 0) {
+      expected.erase(key);
+      per_char = per_char.Remove(key);
+      compressed = compressed.Remove(key);
+    } else {
+      expected[key] = i;
+      per_char = per_char.Put<uint32_t>(key, i);
+      compressed = compressed.Put<uint32_t>(key, i);
+    }
+  }
+
+  ASSERT_TRUE(IsCompact(compressed.GetRoot().get()));
+
+  for (uint32_t i = 0; i < 5000; i++) {
+    std::string key(rng() % 12, 'a');
+    for (auto &c : key) {
+      c = static_cast<char>('a' + rng() % 3);
+    }
+    auto it = expected.find(key);
+    if (it == expected.end()) {
+      ASSERT_EQ(per_char.Get<uint32_t>(key), nullptr);
+      ASSERT_EQ(compressed.Get<uint32_t>(key), nullptr);
+    } else {
+      ASSERT_EQ(*per_char.Get<uint32_t>(key), it->second);
+      ASSERT_EQ(*compressed.Get<uint32_t>(key), it->second);
+    }
+  }
+}
+
+TEST(TrieTest, NonCopyableValuePreserved) {
+  // Rebuilding the ancestors of a key must keep values of any type, including move-only ones.
+  auto trie = Trie();
+  trie = trie.Put<Integer>("te", std::make_unique<uint32_t>(23));
+  trie = trie.Put<Integer>("tes", std::make_unique<uint32_t>(233));
+  trie = trie.Put<uint32_t>("test", 2333);
+  ASSERT_EQ(**trie.Get<Integer>("te"), 23);
+  ASSERT_EQ(**trie.Get<Integer>("tes"), 233);
+  ASSERT_EQ(trie.Get<uint32_t>("tes"), nullptr);
+  const Integer *before = trie.Get<Integer>("te");
+  trie = trie.Remove("test");
+  ASSERT_EQ(trie.Get<Integer>("te"), before);
+  ASSERT_EQ(**trie.Get<Integer>("tes"), 233);
+}
+
+TEST(TrieTest, WriteBatchTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    // Apply random batches and compare with applying the same operations one by one.
+    std::mt19937 rng(233);
+    auto sequential = Trie(layout);
+    auto batched = Trie(layout);
+    for (int round = 0; round < 50; round++) {
+      WriteBatch batch;
+      for (int i = 0; i < 200; i++) {
+        std::string key(rng() % 8, 'a');
+        for (auto &c : key) {
+          c = static_cast<char>('a' + rng() % 3);
+        }
+        if (rng() % 3 == 0) {
+          batch.Remove(key);
+          sequential = sequential.Remove(key);
+        } else {
+          uint32_t value = rng();
+          batch.Put<uint32_t>(key, value);
+          sequential = sequential.Put<uint32_t>(key, value);
+        }
+      }
+      batched = batched.Apply(std::move(batch));
+    }
+    if (layout == TrieLayout::kPathCompressed) {
+      ASSERT_TRUE(IsCompact(batched.GetRoot().get()));
+    }
+    for (int i = 0; i < 3000; i++) {
+      std::string key(rng() % 8, 'a');
+      for (auto &c : key) {
+        c = static_cast<char>('a' + rng() % 3);
+      }
+      const auto *expected = sequential.Get<uint32_t>(key);
+      const auto *actual = batched.Get<uint32_t>(key);
+      ASSERT_EQ(expected == nullptr, actual == nullptr);
+      if (expected != nullptr) {
+        ASSERT_EQ(*expected, *actual);
+      }
+    }
+  }
+}
+
+TEST(TrieTest, WriteBatchSharingTest) {
+  auto trie = Trie();
+  trie = trie.Put<uint32_t>("abc", 1);
+  trie = trie.Put<uint32_t>("xyz", 2);
+
+  // The last operation on a key wins, and untouched subtrees are shared with the original trie.
+  WriteBatch batch;
+  batch.Put<uint32_t>("abd", 3);
+  batch.Put<std::string>("abe", "4");
+  batch.Remove("abd");
+  batch.Put<uint32_t>("abd", 5);
+  batch.Remove("missing");
+  auto updated = trie.Apply(std::move(batch));
+  ASSERT_EQ(*updated.Get<uint32_t>("abc"), 1);
+  ASSERT_EQ(*updated.Get<uint32_t>("abd"), 5);
+  ASSERT_EQ(*updated.Get<std::string>("abe"), "4");
+  ASSERT_EQ(updated.GetRoot()->children_.at('x'), trie.GetRoot()->children_.at('x'));
+  ASSERT_EQ(trie.Get<uint32_t>("abd"), nullptr);
+
+  // A batch that changes nothing returns the same root.
+  WriteBatch noop;
+  noop.Remove("ab");
+  noop.Remove("abcd");
+  ASSERT_EQ(updated.Apply(std::move(noop)).GetRoot(), updated.GetRoot());
+
+  WriteBatch clear;
+  clear.Remove("abc");
+  clear.Remove("abd");
+  clear.Remove("abe");
+  clear.Remove("xyz");
+  ASSERT_EQ(updated.Apply(std::move(clear)).GetRoot(), nullptr);
+}
+
+TEST(TrieTest, TopKTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    trie = trie.Put<uint32_t>("car", 1, 30);
+    trie = trie.Put<uint32_t>("cart", 2, 50);
+    trie = trie.Put<uint32_t>("carbon", 3, 10);
+    trie = trie.Put<uint32_t>("cat", 4, 50);
+    trie = trie.Put<std::string>("dog", "5", 99);
+    ASSERT_EQ(trie.GetRoot()->MaxScore(), 99);
+
+    auto top = trie.TopK("ca", 3);
+    std::vector<std::pair<std::string, uint64_t>> expected = {{"cart", 50}, {"cat", 50}, {"car", 30}};
+    ASSERT_TRUE(top == expected);
+    ASSERT_EQ(trie.TopK("car", 10).size(), 3);
+    ASSERT_EQ(trie.TopK("carb", 10)[0].first, "carbon");
+    ASSERT_EQ(trie.TopK("x", 10).size(), 0);
+    ASSERT_EQ(trie.TopK("", 1)[0].first, "dog");
+
+    // The aggregate follows overwrites and removals along the copied path.
+    auto updated = trie.Remove("dog").Put<uint32_t>("cart", 2, 5);
+    ASSERT_EQ(updated.GetRoot()->MaxScore(), 50);
+    ASSERT_EQ(updated.TopK("", 1)[0].first, "cat");
+    ASSERT_EQ(trie.TopK("", 1)[0].first, "dog");
+
+    // Batches keep the scores they were given.
+    WriteBatch batch;
+    batch.Put<uint32_t>("cab", 6, 70);
+    batch.Remove("cat");
+    auto batched = updated.Apply(std::move(batch));
+    expected = {{"cab", 70}, {"car", 30}, {"carbon", 10}, {"cart", 5}};
+    ASSERT_TRUE(batched.TopK("c", 10) == expected);
+  }
+}
+
+TEST(TrieTest, ScoreStorageTest) {
+  // Nodes without value only hold scores when a scored key is below them
+  ASSERT_TRUE(sizeof(ScoredTrieNode) == sizeof(TrieNode) + 2 * sizeof(uint64_t));
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout).Put<uint32_t>("apple", 1).Put<uint32_t>("apply", 2).Put<uint32_t>("banana", 3);
+    ASSERT_TRUE(!trie.GetRoot()->has_scores_);
+    ASSERT_EQ(trie.GetRoot()->NodeBytes(), sizeof(TrieNode));
+    auto scored = trie.Put<uint32_t>("banana", 3, 7);
+    ASSERT_TRUE(scored.GetRoot()->has_scores_);
+    ASSERT_EQ(scored.GetRoot()->MaxScore(), 7);
+    ASSERT_TRUE(!scored.GetRoot()->children_.Lookup('a')->get()->has_scores_);
+    ASSERT_EQ(scored.TopK("", 1)[0].first, "banana");
+    // Rebuilding the path without the scored key turns the nodes back into plain ones
+    ASSERT_TRUE(!scored.Remove("banana").GetRoot()->has_scores_);
+    ASSERT_TRUE(!scored.Put<uint32_t>("banana", 3).GetRoot()->has_scores_);
+  }
+}
+
+TEST(TrieTest, TopKRandomTest) {
+  std::mt19937 gen(2333);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    std::map<std::string, uint64_t> scores;
+    for (uint32_t i = 0; i < 3000; i++) {
+      std::string key;
+      size_t length = gen() % 7;
+      for (size_t j = 0; j < length; j++) {
+        key.push_back(static_cast<char>('a' + gen() % 3));
+      }
+      if (gen() % 5 == 0) {
+        trie = trie.Remove(key);
+        scores.erase(key);
+      } else {
+        uint64_t score = gen() % 100;
+        trie = trie.Put<uint32_t>(key, i, score);
+        scores[key] = score;
+      }
+    }
+
+    for (const char *prefix : {"", "a", "ab", "ccc", "abcab"}) {
+      std::vector<std::pair<std::string, uint64_t>> expected;
+      for (const auto &[key, score] : scores) {
+        if (key.starts_with(prefix)) {
+          expected.emplace_back(key, score);
+        }
+      }
+      std::stable_sort(expected.begin(), expected.end(),
+                       [](const auto &a, const auto &b) { return a.second > b.second; });
+      expected.resize(std::min<size_t>(expected.size(), 10));
+      ASSERT_TRUE(trie.TopK(prefix, 10) == expected);
+    }
+  }
+}
+
+TEST(TrieTest, ChildLookupTest) {
+  std::mt19937 gen(2333);
+  for (uint16_t size = 0; size <= 40; size++) {
+    // Random sorted keys, bytes above 127 included, with a readable tail past the end
+    std::vector<int> bytes(256);
+    std::iota(bytes.begin(), bytes.end(), 0);
+    std::shuffle(bytes.begin(), bytes.end(), gen);
+    bytes.resize(size);
+    std::sort(bytes.begin(), bytes.end());
+    std::vector<char> keys(size + kKeyBlockWidth, 0);
+    std::transform(bytes.begin(), bytes.end(), keys.begin(), [](int b) { return static_cast<char>(b); });
+
+    for (int b = 0; b < 256; b++) {
+      auto c = static_cast<char>(b);
+      int expected = FindKeySlotScalar(keys.data(), 0, size, c);
+      ASSERT_EQ(FindKeySlot(keys.data(), size, c), expected);
+      if (size <= kKeyBlockWidth) {
+        ASSERT_EQ(FindKeySlot16(keys.data(), size, c), expected);
+      }
+    }
+  }
+
+  // ChildArray agrees with std::map through all of its layouts
+  ChildArray<int> children;
+  std::map<unsigned char, int> expected;
+  for (int i = 0; i < 3000; i++) {
+    auto c = static_cast<char>(gen() % 40 + (i / 1000) * 100);
+    if (gen() % 3 == 0) {
+      ASSERT_EQ(children.erase(c), expected.erase(static_cast<unsigned char>(c)));
+    } else {
+      children.insert_or_assign(c, std::make_shared<int>(i));
+      expected[static_cast<unsigned char>(c)] = i;
+    }
+    ASSERT_EQ(children.size(), expected.size());
+    for (int b = 0; b < 256; b++) {
+      const auto *child = children.Lookup(static_cast<char>(b));
+      auto it = expected.find(static_cast<unsigned char>(b));
+      ASSERT_EQ(child != nullptr, it != expected.end());
+      if (child != nullptr && it != expected.end()) {
+        ASSERT_EQ(**child, it->second);
+      }
+    }
+
+    // The copies a write makes agree with copying and then updating
+    auto c2 = static_cast<char>(gen() % 40 + (i / 1000) * 100);
+    auto with = ChildArray<int>::CopyWith(children, c2, std::make_shared<int>(-i));
+    auto without = ChildArray<int>::CopyWithout(children, c2);
+    auto updated = children;
+    updated.insert_or_assign(c2, std::make_shared<int>(-i));
+    ASSERT_EQ(with.size(), updated.size());
+    ASSERT_EQ(without.size(), children.size() - children.count(c2));
+    ASSERT_EQ(without.Lookup(c2), nullptr);
+    for (auto [ch, node] : updated) {
+      ASSERT_EQ(**with.Lookup(ch), *node);
+      ASSERT_TRUE(ch == c2 || **without.Lookup(ch) == *node);
+    }
+  }
+}
+
+TEST(TrieTest, DeepKeyTest) {
+  // Put, Remove, Apply and destroying a trie walk the path without recursing, however deep the key
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    std::string key(20000, 'a');
+    auto trie = Trie(layout).Put<uint32_t>(key, 1).Put<uint32_t>(key.substr(0, 100), 2);
+    trie = trie.Put<uint32_t>(key.substr(0, 10000) + "b", 3);
+    ASSERT_EQ(*trie.Get<uint32_t>(key), 1);
+    ASSERT_EQ(*trie.Get<uint32_t>(key.substr(0, 100)), 2);
+    ASSERT_EQ(*trie.Get<uint32_t>(key.substr(0, 10000) + "b"), 3);
+    trie = trie.Remove(key);
+    ASSERT_EQ(trie.Get<uint32_t>(key), nullptr);
+    ASSERT_EQ(*trie.Get<uint32_t>(key.substr(0, 10000) + "b"), 3);
+    trie = trie.Remove(key.substr(0, 10000) + "b").Remove(key.substr(0, 100));
+    ASSERT_EQ(trie.GetRoot(), nullptr);
+
+    WriteBatch batch;
+    batch.Put<uint32_t>(key, 1);
+    batch.Put<uint32_t>(key + "b", 2);
+    batch.Put<uint32_t>(key.substr(0, 5000), 3);
+    trie = Trie(layout).Apply(std::move(batch));
+    ASSERT_EQ(*trie.Get<uint32_t>(key + "b"), 2);
+    WriteBatch removes;
+    removes.Remove(key);
+    removes.Remove(key.substr(0, 5000));
+    trie = trie.Apply(std::move(removes));
+    ASSERT_EQ(trie.Get<uint32_t>(key), nullptr);
+    ASSERT_EQ(*trie.Get<uint32_t>(key + "b"), 2);
+  }
+}
+
+TEST(TrieTest, RemoveMissingTest) {
+  // Removing a key without a value returns the trie as it was, without building any node
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout).Put<uint32_t>("abcd", 1).Put<uint32_t>("abxy", 2);
+    for (std::string_view key : {"", "a", "ab", "abc", "abcde", "abz", "b", "abxyz"}) {
+      ASSERT_EQ(trie.Remove(key).GetRoot(), trie.GetRoot());
+    }
+    ASSERT_EQ(Trie(layout).Remove("a").GetRoot(), nullptr);
+  }
+}
+
+TEST(TrieTest, MultiGetTest) {
+  std::mt19937 gen(2333);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    std::vector<std::string_view> none{"a", ""};
+    ASSERT_TRUE(trie.MultiGet<uint32_t>(none) == std::vector<const uint32_t *>(2, nullptr));
+
+    std::vector<std::string> keys;
+    for (uint32_t i = 0; i < 2000; i++) {
+      std::string key;
+      size_t length = gen() % 12;
+      for (size_t j = 0; j < length; j++) {
+        key.push_back(static_cast<char>('a' + gen() % 4));
+      }
+      keys.push_back(key);
+      if (gen() % 4 == 0) {
+        trie = trie.Remove(key);
+      } else if (gen() % 8 == 0) {
+        trie = trie.Put<std::string>(key, key);
+      } else {
+        trie = trie.Put<uint32_t>(key, i);
+      }
+    }
+
+    // Present and missing keys, prefixes of keys, type mismatches and duplicates, in one call
+    std::vector<std::string_view> lookups(keys.begin(), keys.end());
+    lookups.emplace_back("abcdabcdabcdabcd");
+    lookups.emplace_back(keys[7]);
+    auto values = trie.MultiGet<uint32_t>(lookups);
+    ASSERT_EQ(values.size(), lookups.size());
+    for (size_t i = 0; i < lookups.size(); i++) {
+      ASSERT_EQ(values[i], trie.Get<uint32_t>(lookups[i]));
+    }
+    auto strings = trie.MultiGet<std::string>(lookups);
+    for (size_t i = 0; i < lookups.size(); i++) {
+      ASSERT_EQ(strings[i], trie.Get<std::string>(lookups[i]));
+    }
+  }
 }
 
 }  // namespace bustub
@@ -0,0 +1,172 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+namespace {
+
+// The queue a thread from outside the pool starts from, spread so that such threads rarely share one
+auto ThreadHome() -> size_t {
+  thread_local const size_t home = std::hash<std::thread::id>{}(std::this_thread::get_id());
+  return home;
+}
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  }
+  // One more queue than workers: the last one is for threads calling ParallelFor from outside the pool
+  for (size_t i = 0; i <= threads; i++) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  workers_.reserve(threads);
+  for (size_t i = 0; i < threads; i++) {
+    workers_.emplace_back([this, i] { WorkerLoop(i); });
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::scoped_lock lock(sleep_latch_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)> &fn) {
+  if (count == 0) {
+    return;
+  }
+  Job job;
+  job.fn_ = &fn;
+  job.remaining_.store(count, std::memory_order_relaxed);
+
+  // Deal the iterations out in contiguous runs, one per queue, so neighbouring iterations usually run on the same
+  // thread. The count goes up first, so that it never drops below the number of queued tasks.
+  {
+    std::scoped_lock lock(sleep_latch_);
+    queued_.fetch_add(count, std::memory_order_relaxed);
+  }
+  size_t run = (count + queues_.size() - 1) / queues_.size();
+  for (size_t q = 0; q < queues_.size() && q * run < count; q++) {
+    std::scoped_lock lock(queues_[q]->latch_);
+    for (size_t i = q * run; i < std::min(count, (q + 1) * run); i++) {
+      queues_[q]->tasks_.push_back({&job, i});
+    }
+  }
+  wake_.notify_all();
+
+  // Help until every iteration of the job has run. Other jobs' tasks may be run too: that only makes this one wait
+  // for them, never deadlock.
+  size_t home = ThreadHome() % queues_.size();
+  Task task;
+  while (job.remaining_.load(std::memory_order_acquire) != 0 && TryTake(home, task)) {
+    Run(task);
+  }
+  // No iteration is queued any more, so the ones left are running on other threads: sleep until the last one is done
+  // and has let go of the job
+  {
+    std::unique_lock<std::mutex> lock(job.done_latch_);
+    job.done_cv_.wait(lock, [&] { return job.done_; });
+  }
+  if (job.error_) {
+    std::rethrow_exception(job.error_);
+  }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+  auto job = std::make_unique<Job>();
+  job->owned_fn_ = [task = std::move(task)](size_t) { task(); };
+  job->fn_ = &job->owned_fn_;
+  job->remaining_.store(1, std::memory_order_relaxed);
+  job->detached_ = true;
+
+  {
+    std::scoped_lock lock(sleep_latch_);
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  auto &queue = *queues_[ThreadHome() % queues_.size()];
+  try {
+    std::scoped_lock lock(queue.latch_);
+    queue.tasks_.push_back({job.get(), 0});
+  } catch (...) {
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    throw;
+  }
+  job.release();
+  wake_.notify_one();
+}
+
+auto ThreadPool::TryTake(size_t home, Task &task) -> bool {
+  {
+    auto &queue = *queues_[home];
+    std::scoped_lock lock(queue.latch_);
+    if (!queue.tasks_.empty()) {
+      task = queue.tasks_.front();
+      queue.tasks_.pop_front();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); i++) {
+    auto &victim = *queues_[(home + i) % queues_.size()];
+    std::scoped_lock lock(victim.latch_);
+    if (!victim.tasks_.empty()) {
+      task = victim.tasks_.back();
+      victim.tasks_.pop_back();
+      queued_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ThreadPool::Run(const Task &task) {
+  Job &job = *task.job_;
+  if (job.detached_) {
+    // Nobody waits for a submitted task, so its exception has nowhere to go; the caller of a ParallelFor that helps
+    // run it must not receive it either
+    std::unique_ptr<Job> owned(&job);
+    [&]() noexcept { (*job.fn_)(task.index_); }();
+    return;
+  }
+  try {
+    (*job.fn_)(task.index_);
+  } catch (...) {
+    std::scoped_lock lock(job.error_latch_);
+    if (!job.error_) {
+      job.error_ = std::current_exception();
+    }
+  }
+  // Only the last decrement may touch the job afterwards: ParallelFor cannot return, and destroy the job, before it
+  // has set `done_` and let go of the latch
+  if (job.remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    std::scoped_lock lock(job.done_latch_);
+    job.done_ = true;
+    job.done_cv_.notify_all();
+  }
+}
+
+void ThreadPool::WorkerLoop(size_t home) {
+  Task task;
+  while (true) {
+    if (TryTake(home, task)) {
+      Run(task);
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_latch_);
+    wake_.wait(lock, [&] { return stop_ || queued_.load(std::memory_order_relaxed) != 0; });
+    // Submitted tasks still queued run before the pool stops
+    if (stop_ && queued_.load(std::memory_order_relaxed) == 0) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// thread_pool.h
+//
+// Identification: src/include/primer/thread_pool.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+// A ThreadPool runs data-parallel loops on a fixed set of worker threads with work stealing. Every worker has a
+// queue of its own: it takes work from the front of its queue, and when that is empty steals from the back of
+// another worker's. `ParallelFor` spreads its iterations over all queues, so uneven iterations even out as idle
+// workers steal from busy ones.
+//
+// The thread calling `ParallelFor` runs iterations too while it waits, so a `ParallelFor` may be nested in another,
+// even on a pool of one worker, without deadlocking. Once none is left to take, it sleeps until the last one ends. `Submit` queues a single task that nobody waits for.
+class ThreadPool {
+ public:
+  // Start `threads` workers, or one per core if 0.
+  explicit ThreadPool(size_t threads = 0);
+  ThreadPool(const ThreadPool &) = delete;
+  auto operator=(const ThreadPool &) -> ThreadPool & = delete;
+  ~ThreadPool();
+
+  auto Size() const -> size_t { return workers_.size(); }
+
+  // Call `fn(i)` for every i in [0, count), in parallel and in no particular order, and return once all calls have
+  // returned. If calls throw, the first exception is rethrown here once all calls are done.
+  void ParallelFor(size_t count, const std::function<void(size_t)> &fn);
+
+  // Queue `task` to run on a worker and return at once. As with std::thread, an exception escaping `task` terminates
+  // the program. Tasks still queued when the pool is destroyed run before the workers stop.
+  void Submit(std::function<void()> task);
+
+ private:
+  // One ParallelFor call, or one submitted task.
+  struct Job {
+    const std::function<void(size_t)> *fn_;
+    std::atomic<size_t> remaining_;
+    std::mutex error_latch_;
+    std::exception_ptr error_;
+    // Set, with `done_latch_` held, by the thread that finishes the last iteration. The caller sleeps on `done_cv_`
+    // once no iteration is left to take.
+    std::mutex done_latch_;
+    std::condition_variable done_cv_;
+    bool done_{false};
+    // Set for a submitted task: the job owns its function, and the task that runs it deletes it.
+    bool detached_{false};
+    std::function<void(size_t)> owned_fn_;
+  };
+
+  struct Task {
+    Job *job_;
+    size_t index_;
+  };
+
+  struct alignas(64) Queue {
+    std::mutex latch_;
+    std::deque<Task> tasks_;
+  };
+
+  // Take a task from queue `home` or, failing that, steal one from another queue.
+  auto TryTake(size_t home, Task &task) -> bool;
+
+  static void Run(const Task &task);
+
+  void WorkerLoop(size_t home);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+
+  // Workers with nothing to do sleep on `wake_` until tasks are queued. `queued_` only changes with `sleep_latch_`
+  // held when it grows, so a sleeping worker never misses new tasks.
+  std::mutex sleep_latch_;
+  std::condition_variable wake_;
+  std::atomic<size_t> queued_{0};
+  bool stop_{false};
+};
+
+}  // namespace bustub
@@ -1,186 +1,809 @@
 #include "trie.h"
 
+#include <array>
+#include <atomic>
+#include <optional>
+#include <vector>
+
+#include "string_arena.h"
+#include "trie_metrics.h"
+#include "typed_trie.h"
+
 namespace bustub {
 
-template <class T>
-auto Trie::Get(std::string_view key) const -> const T * {
-  if (root_ == nullptr) {
-    return nullptr;
+auto NextNodeId() -> uint64_t {
+  static constexpr uint64_t kBlockSize = 1024;
+  static std::atomic<uint64_t> next_block{0};
+  // Ids start at 1, so that 0 never names a node
+  thread_local uint64_t next = 0;
+  thread_local uint64_t end = 0;
+  if (next == end) {
+    next = next_block.fetch_add(kBlockSize, std::memory_order_relaxed) + 1;
+    end = next + kBlockSize;
   }
+  BUSTUB_TRIE_COUNT(kNodesAllocated, 1);
+  return next++;
+}
 
-  const TrieNode *current = root_.get();
-  
+// Follow `key` down from `current` and return the node it ends at, or nullptr. Shared by the lookups of Trie and
+// TypedTrie.
+template <class Node>
+static auto FindNode(const Node *current, std::string_view key) -> const Node * {
   // Traverse the trie following the key
-  for (char c : key) {
-    auto it = current->children_.find(c);
-    if (it == current->children_.end()) {
+  size_t pos = 0;
+  while (pos < key.size()) {
+    BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+    const auto *child = current->children_.Lookup(key[pos]);
+    if (child == nullptr) {
       return nullptr;
     }
-    current = it->second.get();
+    current = child->get();
+    pos++;
+
+    // A path-compressed node consumes its whole segment; the key must contain all of it
+    const std::string &segment = current->segment_;
+    if (!segment.empty()) {
+      if (key.compare(pos, segment.size(), segment) != 0) {
+        return nullptr;
+      }
+      pos += segment.size();
+    }
   }
+  BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+  return current;
+}
 
-  // Check if this is a value node and has the correct type
-  if (!current->is_value_node_) {
+template <class T>
+auto Trie::Get(std::string_view key) const -> const T * {
+  BUSTUB_TRIE_COUNT(kGets, 1);
+  BUSTUB_TRIE_TIMER(kGetNanos);
+  if (root_ == nullptr) {
+    return nullptr;
+  }
+  const TrieNode *current = FindNode(root_.get(), key);
+  if (current == nullptr) {
     return nullptr;
   }
 
-  // Try to cast to TrieNodeWithValue<T>
-  const auto *value_node = dynamic_cast<const TrieNodeWithValue<T> *>(current);
-  if (value_node == nullptr) {
-    return nullptr;  // Type mismatch
+  // Check if this is a value node and has the correct type. The type tag is only set on a TrieNodeWithValue<T>, so a
+  // match makes the static_cast safe.
+  BUSTUB_TRIE_COUNT(kTypeChecks, 1);
+  if (current->value_type_ != GetValueTypeTag<T>()) {
+    return nullptr;  // No value, or type mismatch
   }
 
+  const auto *value_node = static_cast<const TrieNodeWithValue<T> *>(current);
   return value_node->value_.get();
 }
 
-// Helper function to create a node with new children but preserve value if exists
-static std::shared_ptr<const TrieNode> CreateNodeWithNewChildren(
-    std::shared_ptr<const TrieNode> node,
-    std::map<char, std::shared_ptr<const TrieNode>> new_children) {
-  if (node == nullptr || !node->is_value_node_) {
-    // No value to preserve, create regular node
-    return std::make_shared<TrieNode>(new_children);
+// Ask the CPU to start loading `node` into the cache without waiting for it.
+static inline void PrefetchNode(const TrieNode *node) {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(node);
+#endif
+}
+
+template <class T>
+auto Trie::MultiGet(std::span<const std::string_view> keys) const -> std::vector<const T *> {
+  BUSTUB_TRIE_COUNT(kGets, keys.size());
+  std::vector<const T *> results(keys.size(), nullptr);
+  if (root_ == nullptr) {
+    return results;
   }
 
-  // Node has a value, try to preserve it
-  // Try common types used in tests
-  if (const auto *uint32_node = dynamic_cast<const TrieNodeWithValue<uint32_t> *>(node.get())) {
-    return std::make_shared<TrieNodeWithValue<uint32_t>>(new_children, uint32_node->value_);
+  // Keys are looked up in groups, so the cursors of a group stay in the cache while it is walked. A group must be
+  // large enough that the prefetch of a key's next node has landed by the time the round comes back to the key.
+  static constexpr size_t kGroupSize = 16;
+  struct Cursor {
+    const TrieNode *node_;
+    // Position in the key just past the edge leading to `node_`; the segment of `node_` is not checked yet.
+    size_t pos_;
+    size_t index_;
+  };
+  std::array<Cursor, kGroupSize> group;
+
+  for (size_t begin = 0; begin < keys.size(); begin += kGroupSize) {
+    size_t active = 0;
+    for (size_t i = begin; i < std::min(keys.size(), begin + kGroupSize); i++) {
+      group[active++] = {root_.get(), 0, i};
+    }
+    // Every round moves each unfinished key down one level. A key only touches the node it was prefetched into in
+    // the last round, and finished keys are swapped out of the active part of the group.
+    while (active > 0) {
+      for (size_t a = 0; a < active;) {
+        Cursor &cursor = group[a];
+        std::string_view key = keys[cursor.index_];
+        const TrieNode *node = cursor.node_;
+        BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+        bool done = true;
+        const std::string &segment = node->segment_;
+        if (segment.empty() || key.compare(cursor.pos_, segment.size(), segment) == 0) {
+          size_t pos = cursor.pos_ + segment.size();
+          if (pos == key.size()) {
+            BUSTUB_TRIE_COUNT(kTypeChecks, 1);
+            if (node->value_type_ == GetValueTypeTag<T>()) {
+              results[cursor.index_] = static_cast<const TrieNodeWithValue<T> *>(node)->value_.get();
+            }
+          } else if (const auto *child = node->children_.Lookup(key[pos]); child != nullptr) {
+            cursor.node_ = child->get();
+            cursor.pos_ = pos + 1;
+            PrefetchNode(cursor.node_);
+            done = false;
+          }
+        }
+        if (done) {
+          group[a] = group[--active];
+        } else {
+          a++;
+        }
+      }
+    }
+  }
+  return results;
+}
+
+// How the write path builds the nodes of a TypedTrie<T>: the value is a member of the node, so nodes are built
+// directly, without a virtual call. Scores are not kept.
+template <class T>
+struct TypedNodes {
+  using Node = TypedTrieNode<T>;
+
+  static auto HasValue(const Node &node) -> bool { return node.HasValue(); }
+
+  static auto MakeInner(typename Node::Children children, std::string segment, const WriteContext &ctx)
+      -> std::shared_ptr<Node> {
+    return MakePooled<Node>(ctx.pool_, std::move(children), std::move(segment), std::nullopt);
+  }
+
+  static auto MakeLeaf(typename Node::Children children, std::string segment, T value, uint64_t /*score*/,
+                       const WriteContext &ctx) -> std::shared_ptr<Node> {
+    return MakePooled<Node>(ctx.pool_, std::move(children), std::move(segment),
+                            MakeNodeValue<T>(ctx.pool_, std::move(value)));
   }
-  if (const auto *uint64_node = dynamic_cast<const TrieNodeWithValue<uint64_t> *>(node.get())) {
-    return std::make_shared<TrieNodeWithValue<uint64_t>>(new_children, uint64_node->value_);
+
+  static auto WithChildren(const Node &node, typename Node::Children children, const WriteContext &ctx)
+      -> std::shared_ptr<Node> {
+    return MakePooled<Node>(ctx.pool_, std::move(children), node.segment_, node.value_);
   }
-  if (const auto *str_node = dynamic_cast<const TrieNodeWithValue<std::string> *>(node.get())) {
-    return std::make_shared<TrieNodeWithValue<std::string>>(new_children, str_node->value_);
+
+  static auto WithSegment(const Node &node, std::string segment, const WriteContext &ctx) -> std::shared_ptr<Node> {
+    return MakePooled<Node>(ctx.pool_, node.children_, std::move(segment), node.value_);
   }
-  if (const auto *int_node = dynamic_cast<const TrieNodeWithValue<int> *>(node.get())) {
-    return std::make_shared<TrieNodeWithValue<int>>(new_children, int_node->value_);
+};
+
+// Helper function to create a node with new children but preserve value and segment if exists
+template <class Nodes>
+static auto CreateNodeWithNewChildren(const typename Nodes::Node *node, typename Nodes::Node::Children new_children,
+                                      const WriteContext &ctx) -> std::shared_ptr<const typename Nodes::Node> {
+  BUSTUB_TRIE_COUNT(kPathCopies, 1);
+  if (node == nullptr) {
+    // No value to preserve, create regular node
+    return Nodes::MakeInner(std::move(new_children), "", ctx);
   }
-  
-  // For unknown types, clone and manually construct (not ideal but works for tests)
-  // Actually, we can't easily do this, so we'll lose the value
-  // But this shouldn't happen in the test cases
-  return std::make_shared<TrieNode>(new_children);
+  return Nodes::WithChildren(*node, std::move(new_children), ctx);
 }
 
-// Helper function to put a value (recursive, copy-on-write)
-template <class T>
-static std::shared_ptr<const TrieNode> PutHelper(std::shared_ptr<const TrieNode> node, std::string_view key, T value) {
-  // Base case: key is empty, set value at current node
-  if (key.empty()) {
-    std::shared_ptr<T> value_ptr = std::make_shared<T>(std::move(value));
-    
-    if (node == nullptr) {
-      // Create new node with value only
-      return std::make_shared<TrieNodeWithValue<T>>(value_ptr);
+// Helper function to copy a node (children and value shared) with a different segment
+template <class Nodes>
+static auto CreateNodeWithNewSegment(const typename Nodes::Node &node, std::string segment, const WriteContext &ctx)
+    -> std::shared_ptr<const typename Nodes::Node> {
+  BUSTUB_TRIE_COUNT(kPathCopies, 1);
+  return Nodes::WithSegment(node, std::move(segment), ctx);
+}
+
+// Helper function to fold a value-less node with exactly one child into that child (path compression). `segment` and
+// `children` are the segment and the children of the node being folded away.
+template <class Nodes>
+static auto MergeWithOnlyChild(const std::string &segment, const typename Nodes::Node::Children &children,
+                               const WriteContext &ctx) -> std::shared_ptr<const typename Nodes::Node> {
+  const auto &[ch, child] = *children.begin();
+  std::string merged;
+  merged.reserve(segment.size() + 1 + child->segment_.size());
+  merged.append(segment).append(1, ch).append(child->segment_);
+  return CreateNodeWithNewSegment<Nodes>(*child, std::move(merged), ctx);
+}
+
+// The nodes a write walks through on the way to its key, root first, each with the byte of the edge it follows. The
+// walk down only reads the trie, through raw pointers, and the nodes are then rebuilt bottom-up from this path, so
+// neither Put nor Remove recurses, however long the key. Most keys are short enough for the path to stay on the stack.
+template <class Node>
+class WritePath {
+ public:
+  struct Step {
+    const Node *node_;
+    char ch_;
+  };
+
+  void Push(const Node *node, char ch) {
+    if (size_ < kInlineSteps) {
+      inline_[size_] = {node, ch};
+    } else {
+      overflow_.push_back({node, ch});
     }
-    
-    // Node exists, create new node with same children but new value
-    // This replaces any existing value at this node
-    return std::make_shared<TrieNodeWithValue<T>>(node->children_, value_ptr);
+    size_++;
   }
 
-  // Recursive case: traverse or create path
-  char first_char = key[0];
-  std::string_view remaining = key.substr(1);
+  auto Size() const -> size_t { return size_; }
+  auto operator[](size_t i) const -> const Step & { return i < kInlineSteps ? inline_[i] : overflow_[i - kInlineSteps]; }
 
-  std::map<char, std::shared_ptr<const TrieNode>> new_children;
-  
-  if (node != nullptr) {
-    // Copy all existing children (shared_ptr copy, not deep copy - reuse unchanged nodes)
-    new_children = node->children_;
+ private:
+  static constexpr size_t kInlineSteps = 32;
+
+  std::array<Step, kInlineSteps> inline_;
+  std::vector<Step> overflow_;
+  size_t size_{0};
+};
+
+// Helper function to build the new nodes below a missing edge: `tail` is the rest of the key after the edge's byte.
+// A path-compressed trie puts it all in one leaf, a per-character one in a chain of nodes, built from the bottom.
+template <class Nodes, class T>
+static auto NewPath(std::string_view tail, T value, uint64_t score, const WriteContext &ctx)
+    -> std::shared_ptr<const typename Nodes::Node> {
+  using Children = typename Nodes::Node::Children;
+  BUSTUB_TRIE_COUNT(kPathCopies, 1);
+  if (ctx.layout_ == TrieLayout::kPathCompressed) {
+    return Nodes::MakeLeaf(Children(), std::string(tail), std::move(value), score, ctx);
+  }
+  std::shared_ptr<const typename Nodes::Node> node = Nodes::MakeLeaf(Children(), "", std::move(value), score, ctx);
+  for (size_t i = tail.size(); i > 0; i--) {
+    node = CreateNodeWithNewChildren<Nodes>(nullptr, Children::CopyWith(Children(), tail[i - 1], std::move(node)), ctx);
   }
+  return node;
+}
 
-  // Get or create the child node
-  std::shared_ptr<const TrieNode> child;
-  auto it = new_children.find(first_char);
-  if (it != new_children.end()) {
-    // Child exists, recursively update it (copy-on-write)
-    child = PutHelper<T>(it->second, remaining, std::move(value));
-  } else {
-    // Child doesn't exist, create new path
-    child = PutHelper<T>(nullptr, remaining, std::move(value));
+// Helper function to put a value (iterative, copy-on-write). Every node on the path to `key` is rebuilt once, with
+// its new child array built in one step, and every other node is shared with the old trie.
+template <class Nodes, class T>
+static auto PutHelper(const typename Nodes::Node *root, std::string_view key, T value, uint64_t score,
+                      const WriteContext &ctx) -> std::shared_ptr<const typename Nodes::Node> {
+  using Node = typename Nodes::Node;
+  using Children = typename Node::Children;
+
+  // Walk down as far as the key goes. `node` is nullptr only for an empty trie.
+  WritePath<Node> path;
+  const Node *node = root;
+  while (node != nullptr && !key.empty()) {
+    const auto *existing = node->children_.Lookup(key[0]);
+    if (existing == nullptr) {
+      break;
+    }
+    const std::string &segment = (*existing)->segment_;
+    if (key.compare(1, segment.size(), segment) != 0) {
+      break;
+    }
+    BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+    path.Push(node, key[0]);
+    node = existing->get();
+    key.remove_prefix(1 + segment.size());
   }
+  BUSTUB_TRIE_COUNT(kNodesVisited, node != nullptr ? 1 : 0);
 
-  new_children[first_char] = child;
+  // Build the new version of `node`
+  std::shared_ptr<const Node> built;
+  if (key.empty()) {
+    // Set the value at `node` itself, replacing any value it had
+    BUSTUB_TRIE_COUNT(kPathCopies, 1);
+    if (node == nullptr) {
+      built = Nodes::MakeLeaf(Children(), "", std::move(value), score, ctx);
+    } else {
+      BUSTUB_TRIE_COUNT(kNodesReused, node->children_.size());
+      built = Nodes::MakeLeaf(node->children_, node->segment_, std::move(value), score, ctx);
+    }
+  } else {
+    const auto *existing = node != nullptr ? node->children_.Lookup(key[0]) : nullptr;
+    std::shared_ptr<const Node> child;
+    if (existing == nullptr) {
+      child = NewPath<Nodes, T>(key.substr(1), std::move(value), score, ctx);
+    } else {
+      // The key diverges inside the child's segment, or ends in it: split it at the first differing byte. The upper
+      // half becomes a new node, which takes the value or the new path, and the lower half is a copy of the child
+      // with the rest of the segment.
+      const std::string &segment = (*existing)->segment_;
+      std::string_view rest = key.substr(1);
+      size_t common = 0;
+      while (common < segment.size() && common < rest.size() && segment[common] == rest[common]) {
+        common++;
+      }
+      auto lower = CreateNodeWithNewSegment<Nodes>(**existing, segment.substr(common + 1), ctx);
+      rest.remove_prefix(common);
+      BUSTUB_TRIE_COUNT(kPathCopies, 1);
+      if (rest.empty()) {
+        child = Nodes::MakeLeaf(Children::CopyWith(Children(), segment[common], std::move(lower)),
+                                segment.substr(0, common), std::move(value), score, ctx);
+      } else {
+        auto split_children = Children::CopyWith(Children(), segment[common], std::move(lower));
+        split_children = Children::CopyWith(split_children, rest[0],
+                                            NewPath<Nodes, T>(rest.substr(1), std::move(value), score, ctx));
+        child = Nodes::MakeInner(std::move(split_children), segment.substr(0, common), ctx);
+      }
+    }
+    if (node != nullptr) {
+      BUSTUB_TRIE_COUNT(kNodesReused, existing != nullptr ? node->children_.size() - 1 : node->children_.size());
+      built = CreateNodeWithNewChildren<Nodes>(node, Children::CopyWith(node->children_, key[0], std::move(child)),
+                                               ctx);
+    } else {
+      built = CreateNodeWithNewChildren<Nodes>(nullptr, Children::CopyWith(Children(), key[0], std::move(child)),
+                                               ctx);
+    }
+  }
 
-  // Create new node with updated children, preserving value if original node had one
-  return CreateNodeWithNewChildren(node, new_children);
+  // Rebuild the path above it, bottom-up
+  for (size_t i = path.Size(); i > 0; i--) {
+    const auto &[parent, ch] = path[i - 1];
+    BUSTUB_TRIE_COUNT(kNodesReused, parent->children_.size() - 1);
+    built = CreateNodeWithNewChildren<Nodes>(parent, Children::CopyWith(parent->children_, ch, std::move(built)), ctx);
+  }
+  return built;
 }
 
 template <class T>
-auto Trie::Put(std::string_view key, T value) const -> Trie {
-  auto new_root = PutHelper<T>(root_, key, std::move(value));
-  return Trie(new_root);
+auto Trie::Put(std::string_view key, T value, uint64_t score) const -> Trie {
+  BUSTUB_TRIE_COUNT(kPuts, 1);
+  BUSTUB_TRIE_TIMER(kPutNanos);
+  return WithRoot(PutHelper<TrieNodes, T>(root_.get(), key, std::move(value), score, {layout_, pool_.get()}));
 }
 
-// Helper function to remove a key (recursive, copy-on-write)
-static std::shared_ptr<const TrieNode> RemoveHelper(std::shared_ptr<const TrieNode> node, std::string_view key) {
+// Helper function to remove a key (iterative, copy-on-write). Returns `root` itself, without building anything, when
+// the key has no value in the trie.
+template <class Nodes>
+static auto RemoveHelper(const std::shared_ptr<const typename Nodes::Node> &root, std::string_view key,
+                         const WriteContext &ctx) -> std::shared_ptr<const typename Nodes::Node> {
+  using Node = typename Nodes::Node;
+  using Children = typename Node::Children;
+
+  // Walk down to the node of the key, and give up as soon as it is clear there is none
+  WritePath<Node> path;
+  const Node *node = root.get();
   if (node == nullptr) {
-    return nullptr;
+    return root;
+  }
+  while (!key.empty()) {
+    BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+    const auto *existing = node->children_.Lookup(key[0]);
+    if (existing == nullptr) {
+      return root;
+    }
+    const std::string &segment = (*existing)->segment_;
+    if (key.compare(1, segment.size(), segment) != 0) {
+      // The key ends inside, or diverges from, the child's segment
+      return root;
+    }
+    path.Push(node, key[0]);
+    node = existing->get();
+    key.remove_prefix(1 + segment.size());
+  }
+  BUSTUB_TRIE_COUNT(kNodesVisited, 1);
+  if (!Nodes::HasValue(*node)) {
+    // There is no value here, nothing to remove
+    return root;
   }
 
-  // Base case: key is empty, remove value from this node
-  if (key.empty()) {
-    // If node has children, create a new node without value
-    if (!node->children_.empty()) {
-      return std::make_shared<TrieNode>(node->children_);
+  // Build the new version of the node without its value: nothing if it has no children either
+  const bool compressed = ctx.layout_ == TrieLayout::kPathCompressed;
+  std::shared_ptr<const Node> built;
+  if (!node->children_.empty()) {
+    if (compressed && path.Size() > 0 && node->children_.size() == 1) {
+      // A value-less node with a single child is folded into that child
+      built = MergeWithOnlyChild<Nodes>(node->segment_, node->children_, ctx);
+    } else {
+      BUSTUB_TRIE_COUNT(kPathCopies, 1);
+      BUSTUB_TRIE_COUNT(kNodesReused, node->children_.size());
+      built = Nodes::MakeInner(node->children_, node->segment_, ctx);
+    }
+  }
+
+  // Rebuild the path above it, bottom-up, dropping the nodes left empty
+  for (size_t i = path.Size(); i > 0; i--) {
+    const auto &[parent, ch] = path[i - 1];
+    BUSTUB_TRIE_COUNT(kNodesReused, parent->children_.size() - 1);
+    Children new_children = built != nullptr ? Children::CopyWith(parent->children_, ch, std::move(built))
+                                             : Children::CopyWithout(parent->children_, ch);
+    if (Nodes::HasValue(*parent)) {
+      built = CreateNodeWithNewChildren<Nodes>(parent, std::move(new_children), ctx);
+    } else if (new_children.empty()) {
+      built = nullptr;
+    } else if (compressed && i > 1 && new_children.size() == 1) {
+      // A value-less node left with a single child is folded into that child
+      built = MergeWithOnlyChild<Nodes>(parent->segment_, new_children, ctx);
+    } else {
+      built = CreateNodeWithNewChildren<Nodes>(parent, std::move(new_children), ctx);
     }
-    // Node has no children and no value (after removal), return nullptr
+  }
+  return built;
+}
+
+auto Trie::Remove(std::string_view key) const -> Trie {
+  BUSTUB_TRIE_COUNT(kRemoves, 1);
+  BUSTUB_TRIE_TIMER(kRemoveNanos);
+  return WithRoot(RemoveHelper<TrieNodes>(root_, key, {layout_, pool_.get()}));
+}
+
+template <class T>
+auto TypedTrie<T>::Get(std::string_view key) const -> const T * {
+  BUSTUB_TRIE_COUNT(kGets, 1);
+  BUSTUB_TRIE_TIMER(kGetNanos);
+  if (root_ == nullptr) {
+    return nullptr;
+  }
+  const Node *node = FindNode(root_.get(), key);
+  if (node == nullptr || !node->HasValue()) {
     return nullptr;
   }
+  return node->value_->get();
+}
+
+template <class T>
+auto TypedTrie<T>::Put(std::string_view key, T value) const -> TypedTrie {
+  BUSTUB_TRIE_COUNT(kPuts, 1);
+  BUSTUB_TRIE_TIMER(kPutNanos);
+  return WithRoot(PutHelper<TypedNodes<T>, T>(root_.get(), key, std::move(value), 0, {layout_, pool_.get()}));
+}
+
+template <class T>
+auto TypedTrie<T>::Remove(std::string_view key) const -> TypedTrie {
+  BUSTUB_TRIE_COUNT(kRemoves, 1);
+  BUSTUB_TRIE_TIMER(kRemoveNanos);
+  return WithRoot(RemoveHelper<TypedNodes<T>>(root_, key, {layout_, pool_.get()}));
+}
+
+using BatchOp = WriteBatch::Operation;
+
+// Length of the longest common prefix of `a` and `b`.
+static size_t CommonPrefixLength(std::string_view a, std::string_view b) {
+  size_t n = std::min(a.size(), b.size());
+  size_t i = 0;
+  while (i < n && a[i] == b[i]) {
+    i++;
+  }
+  return i;
+}
+
+namespace {
+
+// One node Trie::Apply is rebuilding: the operations [first_, last_) are still to be applied below it
+struct ApplyFrame {
+  std::shared_ptr<const TrieNode> node_;
+  // The node's segment, or the one of the node to build if `node_` is nullptr
+  std::string_view segment_;
+  const BatchOp *first_;
+  const BatchOp *last_;
+  // Length of the path to the node, including its segment
+  size_t depth_;
+  bool is_root_;
+  // The operation on the node's own key, if any
+  const BatchOp *exact_{nullptr};
+  // The new children, once one of them changed
+  TrieNode::Children new_children_;
+  bool children_changed_{false};
+  // The character selecting the child being rebuilt, and the end of the operations it applies
+  char child_key_{0};
+  const BatchOp *group_end_{nullptr};
+
+  auto OldChildren() const -> const TrieNode::Children & {
+    static const TrieNode::Children kNoChildren;
+    return node_ != nullptr ? node_->children_ : kNoChildren;
+  }
+};
+
+}  // namespace
+
+// Start rebuilding `node` from the sorted, de-duplicated operations [first, last), all of whose keys start with the
+// path to `node`; `depth` is the length of that path, including `node`'s segment. When `node` is nullptr, a new node
+// with `segment` is built from the Puts alone.
+static auto StartApply(std::shared_ptr<const TrieNode> node, std::string_view segment, const BatchOp *first,
+                       const BatchOp *last, size_t depth, bool is_root) -> ApplyFrame {
+  if (node != nullptr) {
+    segment = node->segment_;
+  }
+
+  // Puts always follow the path to this node. A Remove may have been routed here even though its key leaves the
+  // path inside this node's segment, in which case it removes nothing. The ops that do follow the path are
+  // contiguous in sorted order, so trim the others from both ends.
+  auto follows_path = [&](const BatchOp &op) {
+    if (op.leaf_ != nullptr) {
+      return true;
+    }
+    return node != nullptr && op.key_.size() >= depth &&
+           op.key_.compare(depth - segment.size(), segment.size(), segment) == 0;
+  };
+  while (first != last && !follows_path(*first)) {
+    first++;
+  }
+  while (last != first && !follows_path(*(last - 1))) {
+    last--;
+  }
+
+  // The operation on this node's own key, if any, sorts first
+  const BatchOp *exact = nullptr;
+  if (first != last && first->key_.size() == depth) {
+    exact = first++;
+    if (exact->leaf_ == nullptr && (node == nullptr || !node->is_value_node_)) {
+      // Removing a value that does not exist
+      exact = nullptr;
+    }
+  }
+
+  return {std::move(node), segment, first, last, depth, is_root, exact, {}, false, 0, nullptr};
+}
+
+// Start rebuilding the child selected by the next character of the operations [first, last), or return std::nullopt
+// if it does not exist (`child` is nullptr) and none of them creates it. `depth` is the key length up to and
+// including that character.
+static auto StartApplyChild(const std::shared_ptr<const TrieNode> &child, const BatchOp *first, const BatchOp *last,
+                            size_t depth, const WriteContext &ctx) -> std::optional<ApplyFrame> {
+  if (child == nullptr) {
+    // Only Puts create nodes. In the compressed layout, the new node takes the longest prefix all of them share; as
+    // they are sorted, that is the common prefix of the first and the last one.
+    const BatchOp *first_put = first;
+    while (first_put != last && first_put->leaf_ == nullptr) {
+      first_put++;
+    }
+    if (first_put == last) {
+      return std::nullopt;
+    }
+    const BatchOp *last_put = last - 1;
+    while (last_put->leaf_ == nullptr) {
+      last_put--;
+    }
+    std::string_view key = first_put->key_;
+    size_t common = 0;
+    if (ctx.layout_ == TrieLayout::kPathCompressed) {
+      common = CommonPrefixLength(key.substr(depth), std::string_view(last_put->key_).substr(depth));
+    }
+    return StartApply(nullptr, key.substr(depth, common), first, last, depth + common, false);
+  }
+
+  // Find how much of the child's segment every Put shares; Removes that leave the segment remove nothing
+  const std::string &segment = child->segment_;
+  size_t common = segment.size();
+  for (const BatchOp *op = first; op != last && common > 0; op++) {
+    if (op->leaf_ != nullptr) {
+      common = std::min(common, CommonPrefixLength(segment, std::string_view(op->key_).substr(depth)));
+    }
+  }
+
+  if (common == segment.size()) {
+    return StartApply(child, "", first, last, depth + common, false);
+  }
+
+  // Some key diverges inside the segment: split it there first, as PutHelper does
+  TrieNode::Children split_children;
+  split_children.insert_or_assign(segment[common],
+                                  CreateNodeWithNewSegment<TrieNodes>(*child, segment.substr(common + 1), ctx));
+  std::shared_ptr<const TrieNode> split = TrieNodes::MakeInner(std::move(split_children), segment.substr(0, common), ctx);
+  return StartApply(std::move(split), "", first, last, depth + common, false);
+}
 
-  // Recursive case: traverse the path
-  char first_char = key[0];
-  std::string_view remaining = key.substr(1);
+// Record `new_child`, the child `frame` was rebuilding, and move on to the next group of operations.
+static void SetAppliedChild(ApplyFrame &frame, std::shared_ptr<const TrieNode> new_child) {
+  const auto &old_children = frame.OldChildren();
+  const auto *existing = old_children.Lookup(frame.child_key_);
+  if (existing == nullptr ? new_child != nullptr : new_child != *existing) {
+    if (!frame.children_changed_) {
+      frame.new_children_ = old_children;
+      frame.children_changed_ = true;
+    }
+    if (new_child != nullptr) {
+      frame.new_children_.insert_or_assign(frame.child_key_, std::move(new_child));
+    } else {
+      frame.new_children_.erase(frame.child_key_);
+    }
+  }
+  frame.first_ = frame.group_end_;
+}
 
-  auto it = node->children_.find(first_char);
-  if (it == node->children_.end()) {
-    // Key doesn't exist, return original node (reuse - copy-on-write optimization)
+// Build the node `frame` rebuilds once all its children are. The result is built once, with its final children, so
+// every node is copied at most once per batch. Returns the node itself when no operation changes it.
+static auto FinishApply(ApplyFrame &frame, const WriteContext &ctx) -> std::shared_ptr<const TrieNode> {
+  const auto &node = frame.node_;
+  const BatchOp *exact = frame.exact_;
+  if (exact == nullptr && !frame.children_changed_ && node != nullptr) {
+    // Nothing changed below us (copy-on-write optimization)
     return node;
   }
+  TrieNode::Children new_children = frame.children_changed_ ? std::move(frame.new_children_) : frame.OldChildren();
+
+  // Pick where the value of the new node comes from
+  const TrieNode *value_source = nullptr;
+  if (exact != nullptr) {
+    value_source = exact->leaf_.get();
+  } else if (node != nullptr && node->is_value_node_) {
+    value_source = node.get();
+  }
+
+  if (value_source == nullptr) {
+    if (new_children.empty()) {
+      // Empty node, remove it
+      return nullptr;
+    }
+    if (ctx.layout_ == TrieLayout::kPathCompressed && !frame.is_root_ && new_children.size() == 1) {
+      return MergeWithOnlyChild<TrieNodes>(std::string(frame.segment_), new_children, ctx);
+    }
+    return TrieNodes::MakeInner(std::move(new_children), std::string(frame.segment_), ctx);
+  }
+
+  if (exact != nullptr && new_children.empty() && frame.segment_.empty()) {
+    // A new leaf: the node recorded by the batch can be used as is
+    return exact->leaf_;
+  }
+  auto new_node = TrieNodes::WithChildren(*value_source, std::move(new_children), ctx);
+  new_node->segment_ = frame.segment_;
+  return new_node;
+}
 
-  // Recursively remove from child (copy-on-write)
-  auto new_child = RemoveHelper(it->second, remaining);
+// Helper function for Trie::Apply (copy-on-write): apply the sorted, de-duplicated operations [first, last) to the
+// trie at `root`. Nodes are rebuilt children first, with an explicit stack: a per-character trie is as deep as its
+// longest key.
+static auto ApplyOps(const std::shared_ptr<const TrieNode> &root, const BatchOp *first, const BatchOp *last,
+                     const WriteContext &ctx) -> std::shared_ptr<const TrieNode> {
+  std::vector<ApplyFrame> stack;
+  stack.push_back(StartApply(root, "", first, last, 0, true));
+  while (true) {
+    ApplyFrame &frame = stack.back();
+    if (frame.first_ != frame.last_) {
+      // Apply the next group of operations sharing the next character to the matching child
+      size_t depth = frame.depth_;
+      char c = frame.first_->key_[depth];
+      const BatchOp *group_end = frame.first_ + 1;
+      while (group_end != frame.last_ && group_end->key_[depth] == c) {
+        group_end++;
+      }
+      frame.child_key_ = c;
+      frame.group_end_ = group_end;
+      const auto *existing = frame.OldChildren().Lookup(c);
+      auto child = StartApplyChild(existing != nullptr ? *existing : nullptr, frame.first_, group_end, depth + 1, ctx);
+      if (child.has_value()) {
+        stack.push_back(std::move(*child));
+      } else {
+        SetAppliedChild(frame, nullptr);
+      }
+      continue;
+    }
 
-  // Build new children map
-  std::map<char, std::shared_ptr<const TrieNode>> new_children;
-  
-  // Copy all children except the one we're modifying (reuse unchanged children)
-  for (const auto &[ch, child] : node->children_) {
-    if (ch != first_char) {
-      new_children[ch] = child;  // Reuse unchanged children
+    auto result = FinishApply(frame, ctx);
+    stack.pop_back();
+    if (stack.empty()) {
+      return result;
     }
+    SetAppliedChild(stack.back(), std::move(result));
   }
-  
-  // Update or remove the modified child
-  if (new_child != nullptr) {
-    new_children[first_char] = new_child;
+}
+
+auto Trie::Apply(WriteBatch batch) const -> Trie {
+  auto &ops = batch.ops_;
+  if (ops.empty()) {
+    return *this;
   }
-  // If new_child is nullptr, we don't add it (already not in map)
 
-  // Check if we need to keep this node
-  if (!node->is_value_node_ && new_children.empty()) {
-    // Empty node, remove it
-    return nullptr;
+  // Sort by key; for repeated keys keep only the last operation
+  std::stable_sort(ops.begin(), ops.end(), [](const BatchOp &a, const BatchOp &b) { return a.key_ < b.key_; });
+  size_t kept = 0;
+  for (size_t i = 0; i < ops.size(); i++) {
+    if (i + 1 < ops.size() && ops[i].key_ == ops[i + 1].key_) {
+      continue;
+    }
+    if (kept != i) {
+      ops[kept] = std::move(ops[i]);
+    }
+    kept++;
   }
+  ops.resize(kept);
 
-  // Create new node with updated children, preserving value if exists
-  return CreateNodeWithNewChildren(node, new_children);
+  auto new_root = ApplyOps(root_, ops.data(), ops.data() + ops.size(), {layout_, pool_.get()});
+  return WithRoot(new_root);
 }
 
-auto Trie::Remove(std::string_view key) const -> Trie {
-  auto new_root = RemoveHelper(root_, key);
-  return Trie(new_root);
+auto Trie::TopK(std::string_view prefix, size_t k) const -> std::vector<std::pair<std::string, uint64_t>> {
+  std::vector<std::pair<std::string, uint64_t>> result;
+  if (root_ == nullptr || k == 0) {
+    return result;
+  }
+
+  // Walk down to the node whose subtree holds exactly the keys starting with `prefix`
+  const TrieNode *start = root_.get();
+  std::string key;
+  size_t pos = 0;
+  while (pos < prefix.size()) {
+    const auto *child = start->children_.Lookup(prefix[pos]);
+    if (child == nullptr) {
+      return result;
+    }
+    const std::string &segment = (*child)->segment_;
+    std::string_view rest = prefix.substr(pos + 1);
+    size_t overlap = std::min(segment.size(), rest.size());
+    if (segment.compare(0, overlap, rest, 0, overlap) != 0) {
+      return result;
+    }
+    key.push_back(prefix[pos]);
+    key.append(segment);
+    pos += 1 + segment.size();
+    start = child->get();
+  }
+
+  // Best-first search. A candidate is either a whole subtree, ranked by its `MaxScore()`, or a single key, ranked by
+  // its score. A key popped from the queue is better than anything left in it, so it is the next result.
+  struct Candidate {
+    uint64_t score_;
+    std::string key_;
+    const TrieNode *subtree_;  // nullptr for a single key
+  };
+  auto worse = [](const Candidate &a, const Candidate &b) {
+    if (a.score_ != b.score_) {
+      return a.score_ < b.score_;
+    }
+    if (a.key_ != b.key_) {
+      return a.key_ > b.key_;
+    }
+    // A key comes before the subtree below it
+    return a.subtree_ != nullptr && b.subtree_ == nullptr;
+  };
+  std::vector<Candidate> queue;
+  auto push = [&](Candidate candidate) {
+    queue.push_back(std::move(candidate));
+    std::push_heap(queue.begin(), queue.end(), worse);
+  };
+  push({start->MaxScore(), std::move(key), start});
+
+  while (!queue.empty() && result.size() < k) {
+    std::pop_heap(queue.begin(), queue.end(), worse);
+    Candidate top = std::move(queue.back());
+    queue.pop_back();
+    if (top.subtree_ == nullptr) {
+      result.emplace_back(std::move(top.key_), top.score_);
+      continue;
+    }
+    const TrieNode *node = top.subtree_;
+    for (const auto &[ch, child] : node->children_) {
+      std::string child_key;
+      child_key.reserve(top.key_.size() + 1 + child->segment_.size());
+      child_key.append(top.key_).append(1, ch).append(child->segment_);
+      push({child->MaxScore(), std::move(child_key), child.get()});
+    }
+    if (node->is_value_node_) {
+      push({node->Score(), std::move(top.key_), nullptr});
+    }
+  }
+  return result;
 }
 
 // Explicit template instantiations
 template auto Trie::Get<uint32_t>(std::string_view key) const -> const uint32_t *;
+template auto Trie::MultiGet<uint32_t>(std::span<const std::string_view> keys) const
+    -> std::vector<const uint32_t *>;
 template auto Trie::Get<uint64_t>(std::string_view key) const -> const uint64_t *;
+template auto Trie::MultiGet<uint64_t>(std::span<const std::string_view> keys) const
+    -> std::vector<const uint64_t *>;
 template auto Trie::Get<std::string>(std::string_view key) const -> const std::string *;
+template auto Trie::MultiGet<std::string>(std::span<const std::string_view> keys) const
+    -> std::vector<const std::string *>;
+
+template auto Trie::Put<uint32_t>(std::string_view key, uint32_t value, uint64_t score) const -> Trie;
+template auto Trie::Put<uint64_t>(std::string_view key, uint64_t value, uint64_t score) const -> Trie;
+template auto Trie::Put<std::string>(std::string_view key, std::string value, uint64_t score) const -> Trie;
+
+template auto Trie::Get<ArenaString>(std::string_view key) const -> const ArenaString *;
+template auto Trie::MultiGet<ArenaString>(std::span<const std::string_view> keys) const
+    -> std::vector<const ArenaString *>;
+template auto Trie::Put<ArenaString>(std::string_view key, ArenaString value, uint64_t score) const -> Trie;
+
+// Non-copyable value types, used by TrieStore.
+using Integer = std::unique_ptr<uint32_t>;
+
+template auto Trie::Get<Integer>(std::string_view key) const -> const Integer *;
+template auto Trie::MultiGet<Integer>(std::span<const std::string_view> keys) const
+    -> std::vector<const Integer *>;
+template auto Trie::Put<Integer>(std::string_view key, Integer value, uint64_t score) const -> Trie;
+
+template auto Trie::Get<MoveBlocked>(std::string_view key) const -> const MoveBlocked *;
+template auto Trie::MultiGet<MoveBlocked>(std::span<const std::string_view> keys) const
+    -> std::vector<const MoveBlocked *>;
+template auto Trie::Put<MoveBlocked>(std::string_view key, MoveBlocked value, uint64_t score) const -> Trie;
 
-template auto Trie::Put<uint32_t>(std::string_view key, uint32_t value) const -> Trie;
-template auto Trie::Put<uint64_t>(std::string_view key, uint64_t value) const -> Trie;
-template auto Trie::Put<std::string>(std::string_view key, std::string value) const -> Trie;
+template class TypedTrie<uint32_t>;
+template class TypedTrie<uint64_t>;
+template class TypedTrie<std::string>;
+template class TypedTrie<ArenaString>;
+template class TypedTrie<Integer>;
+template class TypedTrie<MoveBlocked>;
 
 }  // namespace bustub
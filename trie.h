@@ -13,19 +13,30 @@
 #pragma once
 
 #include <algorithm>
+#include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <future>  // NOLINT
+#include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include <string_view>
 #include <string>
 
+#include "node_pool.h"
+#include "trie_children.h"
+#include "trie_metrics.h"
+
 namespace bustub {
 
 /// A special type that will block the move constructor and move assignment operator. Used in TrieStore tests.
@@ -54,16 +65,49 @@ class MoveBlocked {
   std::future<int> wait_;
 };
 
+// Return a tag that uniquely identifies the value type `T`. Comparing two tags is a pointer comparison, which is what
+// `Trie::Get<T>` uses instead of a `dynamic_cast` to check the type of a value node.
+template <class T>
+struct ValueTypeTag {
+  static constexpr char kId = 0;
+};
+
+template <class T>
+constexpr auto GetValueTypeTag() -> const void * {
+  return &ValueTypeTag<std::remove_cv_t<T>>::kId;
+}
+
+// Bytes `s` holds on the heap, outside the string object: 0 for a string short enough to be stored inline.
+inline auto StringHeapBytes(const std::string &s) -> size_t {
+  const auto *self = reinterpret_cast<const char *>(&s);
+  std::less<const char *> less;
+  bool inline_data = !less(s.data(), self) && less(s.data(), self + sizeof(s));
+  return inline_data ? 0 : s.capacity() + 1;
+}
+
+// Return an id that no other call returns, for stamping a new TrieNode. Ids are handed to each thread in blocks, so
+// creating nodes on several threads does not contend on a shared counter.
+auto NextNodeId() -> uint64_t;
+
 // A TrieNode is a node in a Trie.
 class TrieNode {
  public:
+  // The container mapping the next character of a key to the child TrieNode.
+  using Children = ChildArray<const TrieNode>;
+
   // Create a TrieNode with no children.
   TrieNode() = default;
 
-  // Create a TrieNode with some children.
-  explicit TrieNode(std::map<char, std::shared_ptr<const TrieNode>> children) : children_(std::move(children)) {}
+  // Create a TrieNode with some children. A plain TrieNode holds no scores, so the ones of the children are not
+  // aggregated here: build nodes without value with `MakeInner`, which does.
+  explicit TrieNode(Children children) : children_(std::move(children)) {}
 
-  virtual ~TrieNode() = default;
+  // Create a node without value with the given children from `pool` (the heap if nullptr): a `ScoredTrieNode` if a
+  // key below it has a score, a plain TrieNode otherwise.
+  static auto MakeInner(Children children, NodePool *pool) -> std::shared_ptr<TrieNode>;
+
+  // Releases the children without recursing once per level, see `ReleaseChildren`.
+  virtual ~TrieNode() { ReleaseChildren(children_); }
 
   // Clone returns a copy of this TrieNode. If the TrieNode has a value, the value is copied. The return
   // type of this function is a unique_ptr to a TrieNode.
@@ -72,44 +116,366 @@ class TrieNode {
   // contains a value or not.
   //
   // Note: if you want to convert `unique_ptr` into `shared_ptr`, you can use `std::shared_ptr<T>(std::move(ptr))`.
-  virtual auto Clone() const -> std::unique_ptr<TrieNode> { return std::make_unique<TrieNode>(children_); }
+  virtual auto Clone() const -> std::unique_ptr<TrieNode>;
+
+  // CloneWithChildren returns a copy of this TrieNode whose children are replaced by `children`. The copy keeps the
+  // segment, and shares the value (if any) with this node instead of copying it, so it works for any value type,
+  // including move-only ones. This is how the write path rebuilds the ancestors of a modified key: one virtual call
+  // per level, and the old children are never copied only to be thrown away.
+  //
+  // The copy is allocated from `pool`, or with `make_shared` if `pool` is nullptr, so the node and its control block
+  // take one allocation either way.
+  virtual auto CloneWithChildren(Children children, NodePool *pool) const -> std::shared_ptr<TrieNode> {
+    auto node = MakeInner(std::move(children), pool);
+    node->segment_ = segment_;
+    return node;
+  }
+
+  // Bytes this node takes in memory, including the heap bytes of its segment, but not its children's block (see
+  // `ChildArray::HeapBytes`) nor its value. Allocator and reference count overhead is not included.
+  virtual auto NodeBytes() const -> size_t { return sizeof(TrieNode) + StringHeapBytes(segment_); }
+
+  // Bytes taken by this node's value, 0 for a node without value.
+  virtual auto ValueBytes() const -> size_t { return 0; }
+
+  // Whether `other` holds the same value as this node: a value of the same type, that is either shared with this node
+  // or, if values of its type are inlined, equal to this node's. False if either node has no value. `Diff` uses this to
+  // tell a key that was written from one whose node was only rebuilt on the way to another key.
+  virtual auto SameValue(const TrieNode & /*other*/) const -> bool { return false; }
+
+  // The score of this node's value, as given to `Put`. 0 for a node without value.
+  auto Score() const -> uint64_t;
+
+  // The largest score in the subtree rooted at this node, this node included. See `ScoredTrieNode::max_score_`.
+  auto MaxScore() const -> uint64_t;
 
   // A map of children, where the key is the next character in the key, and the value is the next TrieNode.
-  // You MUST store the children information in this structure. You are NOT allowed to remove the `const` from
-  // the structure.
-  std::map<char, std::shared_ptr<const TrieNode>> children_;
+  // It is an ordered, compact array rather than a `std::map`; see `ChildArray` for the layout. You are NOT allowed
+  // to remove the `const` from the structure.
+  Children children_;
 
   // Indicates if the node is the terminal node.
   bool is_value_node_{false};
 
+  // Whether this node is a `ScoredTrieNode`. It fits in the padding after `is_value_node_`.
+  bool has_scores_{false};
+
+  // The `GetValueTypeTag<T>()` of the value of a `TrieNodeWithValue<T>`, nullptr for a node without value.
+  const void *value_type_{nullptr};
+
+  // The key bytes consumed when entering this node, after the character that selected it in the parent. It is
+  // always empty in a `TrieLayout::kPerCharacter` trie. In a `TrieLayout::kPathCompressed` trie, a chain of nodes
+  // that have one child and no value is collapsed into a single node carrying the chain's bytes here. The root never
+  // has a segment.
+  std::string segment_;
+
+  // The identity of this node, unique for the lifetime of the process. A node is immutable, so two snapshots that
+  // hold a node with the same id share the whole subtree below it. `TrieCheckpointer` relies on this to persist
+  // only the nodes a snapshot does not share with the previous checkpoint.
+  const uint64_t id_{NextNodeId()};
+
   // You can add additional fields and methods here except storing children. But in general, you don't need to add extra
   // fields to complete this project.
 };
 
+// A ScoredTrieNode is a TrieNode with the scores `Trie::TopK` ranks keys by. Every value node is one, and so is a node
+// without value that has a scored key below it; every other node is a plain TrieNode, so a trie that never uses
+// scores does not pay for them.
+class ScoredTrieNode : public TrieNode {
+ public:
+  ScoredTrieNode() { has_scores_ = true; }
+
+  // Create a node with some children, aggregating their scores.
+  explicit ScoredTrieNode(Children children) : TrieNode(std::move(children)) {
+    has_scores_ = true;
+    for (const auto &[ch, child] : children_) {
+      max_score_ = std::max(max_score_, child->MaxScore());
+    }
+  }
+
+  auto NodeBytes() const -> size_t override { return sizeof(ScoredTrieNode) + StringHeapBytes(segment_); }
+
+  // Set the score of this node's value and fold it into `max_score_`. Only call this on a node that is being built:
+  // the aggregate is computed from the children by the constructor, and from the node's own score here.
+  void SetScore(uint64_t score) {
+    score_ = score;
+    max_score_ = std::max(max_score_, score);
+  }
+
+  // The score of this node's value, as given to `Put`. 0 for a node without value.
+  uint64_t score_{0};
+
+  // The largest score in the subtree rooted at this node, this node included. Every node computes it when it is
+  // built, from its own score and the `MaxScore()` of its children, so a write keeps it up to date along the path it
+  // copies. `Trie::TopK` uses it to skip subtrees that cannot contain a better key.
+  uint64_t max_score_{0};
+};
+
+inline auto TrieNode::MakeInner(Children children, NodePool *pool) -> std::shared_ptr<TrieNode> {
+  for (const auto &[ch, child] : children) {
+    if (child->MaxScore() > 0) {
+      return MakePooled<ScoredTrieNode>(pool, std::move(children));
+    }
+  }
+  return MakePooled<TrieNode>(pool, std::move(children));
+}
+
+inline auto TrieNode::Clone() const -> std::unique_ptr<TrieNode> {
+  std::unique_ptr<TrieNode> node =
+      has_scores_ ? std::make_unique<ScoredTrieNode>(children_) : std::make_unique<TrieNode>(children_);
+  node->segment_ = segment_;
+  return node;
+}
+
+inline auto TrieNode::Score() const -> uint64_t {
+  return has_scores_ ? static_cast<const ScoredTrieNode *>(this)->score_ : 0;
+}
+
+inline auto TrieNode::MaxScore() const -> uint64_t {
+  return has_scores_ ? static_cast<const ScoredTrieNode *>(this)->max_score_ : 0;
+}
+
+// Values of these types are stored inside their TrieNodeWithValue. Copying them along with the node, when a write
+// rebuilds it, is cheaper than a separate allocation per value and the extra indirection on every Get. Other small
+// copyable types can opt in with a specialization, as `ArenaString` does.
+template <class T>
+inline constexpr bool kInlineNodeValue = std::is_trivially_copyable_v<T> && sizeof(T) <= 16;
+
+// The value of a TrieNodeWithValue. A value that is not inlined lives in an allocation of its own, which holds its
+// reference count too, and is shared by every copy of the node: a pointer to it stays the same across all versions
+// of the trie that keep the value. An inlined value is copied with its node, so a pointer to it is valid as long as
+// the version it was read from, but a later version that rebuilt the node holds a copy elsewhere.
+template <class T, bool Inline = kInlineNodeValue<T>>
+class NodeValue {
+ public:
+  explicit NodeValue(std::shared_ptr<T> value) : value_(std::move(value)) {}
+
+  auto get() const -> const T * { return value_.get(); }  // NOLINT
+  auto operator*() const -> const T & { return *value_; }
+
+ private:
+  std::shared_ptr<T> value_;
+};
+
+template <class T>
+class NodeValue<T, true> {
+ public:
+  explicit NodeValue(T value) : value_(std::move(value)) {}
+  explicit NodeValue(const std::shared_ptr<T> &value) : value_(*value) {}
+
+  auto get() const -> const T * { return &value_; }  // NOLINT
+  auto operator*() const -> const T & { return value_; }
+
+ private:
+  T value_;
+};
+
+// Store `value` the way a TrieNodeWithValue<T> holds it: inline, or in an allocation from `pool` (or the heap if
+// `pool` is nullptr).
+template <class T>
+auto MakeNodeValue(NodePool *pool, T value) -> NodeValue<T> {
+  if constexpr (kInlineNodeValue<T>) {
+    return NodeValue<T>(std::move(value));
+  } else {
+    return NodeValue<T>(MakePooled<T>(pool, std::move(value)));
+  }
+}
+
 // A TrieNodeWithValue is a TrieNode that also has a value of type T associated with it.
 template <class T>
-class TrieNodeWithValue : public TrieNode {
+class TrieNodeWithValue : public ScoredTrieNode {
  public:
   // Create a trie node with no children and a value.
-  explicit TrieNodeWithValue(std::shared_ptr<T> value) : value_(std::move(value)) { this->is_value_node_ = true; }
+  explicit TrieNodeWithValue(NodeValue<T> value) : value_(std::move(value)) {
+    this->is_value_node_ = true;
+    this->value_type_ = GetValueTypeTag<T>();
+  }
+  explicit TrieNodeWithValue(std::shared_ptr<T> value) : TrieNodeWithValue(NodeValue<T>(std::move(value))) {}
 
   // Create a trie node with children and a value.
-  TrieNodeWithValue(std::map<char, std::shared_ptr<const TrieNode>> children, std::shared_ptr<T> value)
-      : TrieNode(std::move(children)), value_(std::move(value)) {
+  TrieNodeWithValue(Children children, NodeValue<T> value)
+      : ScoredTrieNode(std::move(children)), value_(std::move(value)) {
     this->is_value_node_ = true;
+    this->value_type_ = GetValueTypeTag<T>();
   }
+  TrieNodeWithValue(Children children, std::shared_ptr<T> value)
+      : TrieNodeWithValue(std::move(children), NodeValue<T>(std::move(value))) {}
 
   // Override the Clone method to also clone the value.
   //
   // Note: if you want to convert `unique_ptr` into `shared_ptr`, you can use `std::shared_ptr<T>(std::move(ptr))`.
   auto Clone() const -> std::unique_ptr<TrieNode> override {
-    return std::make_unique<TrieNodeWithValue<T>>(children_, value_);
+    auto node = std::make_unique<TrieNodeWithValue<T>>(children_, value_);
+    node->segment_ = segment_;
+    node->SetScore(score_);
+    return node;
+  }
+
+  // Override the CloneWithChildren method to share the value with the new node (or copy it, if it is inlined).
+  auto CloneWithChildren(Children children, NodePool *pool) const -> std::shared_ptr<TrieNode> override {
+    auto node = MakePooled<TrieNodeWithValue<T>>(pool, std::move(children), value_);
+    node->segment_ = segment_;
+    node->SetScore(score_);
+    return node;
+  }
+
+  auto NodeBytes() const -> size_t override { return sizeof(TrieNodeWithValue<T>) + StringHeapBytes(segment_); }
+
+  // An inlined value is counted in the node's bytes.
+  auto ValueBytes() const -> size_t override {
+    if constexpr (kInlineNodeValue<T>) {
+      return 0;
+    } else if constexpr (std::is_same_v<T, std::string>) {
+      return sizeof(T) + StringHeapBytes(*value_);
+    } else {
+      return sizeof(T);
+    }
+  }
+
+  auto SameValue(const TrieNode &other) const -> bool override {
+    if (other.value_type_ != this->value_type_) {
+      return false;
+    }
+    const T *theirs = static_cast<const TrieNodeWithValue<T> &>(other).value_.get();
+    if constexpr (!kInlineNodeValue<T>) {
+      return theirs == value_.get();
+    } else if constexpr (std::equality_comparable<T>) {
+      return *theirs == *value_;
+    } else {
+      return std::memcmp(theirs, value_.get(), sizeof(T)) == 0;
+    }
   }
 
   // The value associated with this trie node.
-  std::shared_ptr<T> value_;
+  NodeValue<T> value_;
+};
+
+// How a Trie lays out its nodes.
+enum class TrieLayout : uint8_t {
+  // One node per key character. This is the representation the original trie tests inspect through `GetRoot()`.
+  kPerCharacter,
+  // Radix (Patricia) layout: value-less chains with a single child are collapsed into one node whose `segment_`
+  // holds the chain's bytes. `Put` splits a segment where a new key diverges and `Remove` merges a node back into its
+  // only child, so a long key costs O(number of branch points) nodes instead of O(key length).
+  kPathCompressed,
+};
+
+// What the write path needs to know about the trie being written: how to lay out nodes and where to allocate them.
+struct WriteContext {
+  TrieLayout layout_;
+  NodePool *pool_;
+};
+
+// How the write path builds the nodes of a Trie. A node holds a value of any type, and rebuilds itself with one
+// virtual call. The write helpers of trie.cpp are written against this interface, so that they also build a
+// TypedTrie's nodes (see `TypedNodes`), and `WriteBatch` and `TrieBuilder` build their nodes through it too, so that
+// every node of a trie comes from its pool:
+//  - `HasValue(node)`;
+//  - `MakeInner(children, segment, ctx)`, a node without value;
+//  - `MakeLeaf(children, segment, value, score, ctx)`, a node with a value;
+//  - `WithChildren(node, children, ctx)` and `WithSegment(node, segment, ctx)`, copies of a node, its value shared,
+//    with other children or another segment.
+struct TrieNodes {
+  using Node = TrieNode;
+
+  static auto HasValue(const TrieNode &node) -> bool { return node.is_value_node_; }
+
+  static auto MakeInner(TrieNode::Children children, std::string segment, const WriteContext &ctx)
+      -> std::shared_ptr<TrieNode> {
+    auto node = TrieNode::MakeInner(std::move(children), ctx.pool_);
+    node->segment_ = std::move(segment);
+    return node;
+  }
+
+  template <class T>
+  static auto MakeLeaf(TrieNode::Children children, std::string segment, T value, uint64_t score,
+                       const WriteContext &ctx) -> std::shared_ptr<TrieNode> {
+    auto node = MakePooled<TrieNodeWithValue<T>>(ctx.pool_, std::move(children),
+                                                 MakeNodeValue<T>(ctx.pool_, std::move(value)));
+    node->segment_ = std::move(segment);
+    node->SetScore(score);
+    return node;
+  }
+
+  // The node knows its own value type, so it rebuilds itself in one virtual call
+  static auto WithChildren(const TrieNode &node, TrieNode::Children children, const WriteContext &ctx)
+      -> std::shared_ptr<TrieNode> {
+    BUSTUB_TRIE_COUNT(kVirtualClones, 1);
+    return node.CloneWithChildren(std::move(children), ctx.pool_);
+  }
+
+  static auto WithSegment(const TrieNode &node, std::string segment, const WriteContext &ctx)
+      -> std::shared_ptr<TrieNode> {
+    BUSTUB_TRIE_COUNT(kVirtualClones, 1);
+    std::shared_ptr<TrieNode> copy = node.CloneWithChildren(node.children_, ctx.pool_);
+    copy->segment_ = std::move(segment);
+    return copy;
+  }
+};
+
+// A WriteBatch collects Put and Remove operations that `Trie::Apply` performs in a single copy-on-write pass. Ops may
+// be added in any order; when a key appears several times, the last operation on it wins.
+//
+// Applying n operations to a trie rebuilds every affected node exactly once, however many of the keys pass through
+// it, instead of rebuilding the whole root-to-leaf path n times as n separate `Put`s would.
+class WriteBatch {
+ public:
+  WriteBatch() = default;
+
+  // Create a batch whose leaves and values are allocated from `pool`, which should be the one of the tries it is
+  // applied to (see `Trie::GetNodePool`).
+  explicit WriteBatch(std::shared_ptr<NodePool> pool) : pool_(std::move(pool)) {}
+
+  // Record a Put of `value` at `key` with the given score. The value is moved into its trie node right away.
+  template <class T>
+  void Put(std::string_view key, T value, uint64_t score = 0) {
+    // A leaf has no segment, so the layout does not matter
+    auto leaf = TrieNodes::MakeLeaf(TrieNode::Children(), "", std::move(value), score,
+                                    {TrieLayout::kPerCharacter, pool_.get()});
+    ops_.push_back({std::string(key), std::move(leaf)});
+  }
+
+  // Record a Remove of `key`.
+  void Remove(std::string_view key) { ops_.push_back({std::string(key), nullptr}); }
+
+  // Record all operations of `other` after the ones of this batch.
+  void Append(WriteBatch other) {
+    if (ops_.empty()) {
+      ops_ = std::move(other.ops_);
+      return;
+    }
+    ops_.insert(ops_.end(), std::make_move_iterator(other.ops_.begin()), std::make_move_iterator(other.ops_.end()));
+  }
+
+  auto Size() const -> size_t { return ops_.size(); }
+  auto Empty() const -> bool { return ops_.empty(); }
+  void Clear() { ops_.clear(); }
+
+  // One recorded operation.
+  struct Operation {
+    std::string key_;
+    // A childless node holding the value to put, or nullptr for a Remove.
+    std::shared_ptr<const TrieNode> leaf_;
+  };
+
+  // The recorded operations, in the order they were added.
+  auto Operations() const -> const std::vector<Operation> & { return ops_; }
+
+ private:
+  friend class Trie;
+  friend class ShardedTrieStore;
+
+  std::vector<Operation> ops_;
+  std::shared_ptr<NodePool> pool_{nullptr};
 };
 
+template <class T>
+class TrieScan;
+
+class ThreadPool;
+struct TrieStats;
+struct TrieSharing;
+
 // A Trie is a data structure that maps strings to values of type T. All operations on a Trie should not
 // modify the trie itself. It should reuse the existing nodes as much as possible, and create new nodes to
 // represent the new trie.
@@ -117,26 +483,101 @@ class TrieNodeWithValue : public TrieNode {
 // You are NOT allowed to remove any `const` in this project, or use `mutable` to bypass the const checks.
 class Trie {
  private:
+  friend class TrieBuilder;
+  friend class TrieCheckpointer;
+
   // The root of the trie.
   std::shared_ptr<const TrieNode> root_{nullptr};
 
+  // The node layout. Every trie derived from this one by `Put` and `Remove` keeps it.
+  TrieLayout layout_{TrieLayout::kPerCharacter};
+
+  // The pool new nodes and values are allocated from, nullptr to use `std::make_shared`. Every trie derived from
+  // this one keeps it.
+  std::shared_ptr<NodePool> pool_{nullptr};
+
   // Create a new trie with the given root.
-  explicit Trie(std::shared_ptr<const TrieNode> root) : root_(std::move(root)) {}
+  Trie(std::shared_ptr<const TrieNode> root, TrieLayout layout, std::shared_ptr<NodePool> pool = nullptr)
+      : root_(std::move(root)), layout_(layout), pool_(std::move(pool)) {}
+
+  // Create a trie with the given root and the same layout and pool as this one.
+  auto WithRoot(std::shared_ptr<const TrieNode> root) const -> Trie { return Trie(std::move(root), layout_, pool_); }
 
  public:
   // Create an empty trie.
   Trie() = default;
 
+  // Create an empty trie with the given node layout.
+  explicit Trie(TrieLayout layout) : layout_(layout) {}
+
+  // Create an empty trie with the given node layout, whose nodes and values are allocated from `pool`.
+  Trie(TrieLayout layout, std::shared_ptr<NodePool> pool) : layout_(layout), pool_(std::move(pool)) {}
+
   template <class T>
   auto Get(std::string_view key) const -> const T *;
 
+  // Look up all `keys` at once: element i of the result is what `Get<T>(keys[i])` returns. The lookups walk the
+  // trie in lockstep, one level per round, and prefetch the node each key moves to, so that the cache misses of
+  // different keys overlap instead of being paid one after another.
+  template <class T>
+  auto MultiGet(std::span<const std::string_view> keys) const -> std::vector<const T *>;
+
+  // Put `value` at `key`, replacing any previous value and its score. `score` ranks the key for `TopK`.
   template <class T>
-  auto Put(std::string_view key, T value) const -> Trie;
+  auto Put(std::string_view key, T value, uint64_t score = 0) const -> Trie;
 
   auto Remove(std::string_view key) const -> Trie;
 
+  // Iterate, in key order, over the values of type T whose keys start with `prefix`. Values of other types are
+  // skipped. Defined in trie_iterator.h.
+  template <class T>
+  auto Scan(std::string_view prefix) const -> TrieScan<T>;
+
+  // Iterate, in key order, over the values of type T whose keys are in [begin, end). Defined in trie_iterator.h.
+  template <class T>
+  auto Range(std::string_view begin, std::string_view end) const -> TrieScan<T>;
+
+  // Call `fn(key, value)`, on the threads of `pool`, for every value of type T whose key starts with `prefix`. Calls
+  // run concurrently and in no particular order. Defined in trie_parallel.h.
+  template <class T, class Fn>
+  void ParallelForEach(std::string_view prefix, Fn fn, ThreadPool &pool) const;
+
+  // Fold the values of type T whose keys start with `prefix` into one result, on the threads of `pool`: each value
+  // is mapped with `map(key, value) -> R` and results are combined with `combine(R, R) -> R`, in key order. `combine`
+  // must be associative and `init` must be its identity; it need not be commutative. Defined in trie_parallel.h.
+  template <class T, class R, class Map, class Combine>
+  auto ParallelReduce(std::string_view prefix, R init, Map map, Combine combine, ThreadPool &pool) const -> R;
+
+  // Apply all operations of `batch` and return the resulting trie. The result is the same as performing the
+  // operations one by one in the order they were added.
+  auto Apply(WriteBatch batch) const -> Trie;
+
+  // Return the (at most) `k` keys starting with `prefix` that have the highest scores, with their scores, best
+  // first. Keys with equal scores are returned in key order. The search is best-first over `MaxScore()`, so it
+  // visits a number of nodes that depends on `k` and the depth and fan-out of the trie, not on the size of the
+  // subtree under `prefix`.
+  auto TopK(std::string_view prefix, size_t k) const -> std::vector<std::pair<std::string, uint64_t>>;
+
+  // Count the nodes of this trie and the memory they take. Defined in trie_stats.cpp.
+  auto Stats() const -> TrieStats;
+
+  // Count the nodes reachable from both this trie and `other`, and the memory they take: what keeping `other` alive
+  // costs on top of this trie is `other.Stats().TotalBytes() - SharedWith(other).bytes_`. Defined in
+  // trie_stats.cpp.
+  auto SharedWith(const Trie &other) const -> TrieSharing;
+
+  // Write this trie to `path` in the flat snapshot format that `TrieView` maps (see trie_snapshot.h). Values must be
+  // uint32_t, uint64_t or std::string. Throws std::invalid_argument for other value types and std::runtime_error if
+  // the file cannot be written. The file is replaced atomically and durably (see `WriteFileDurably`). Defined in
+  // trie_snapshot.cpp.
+  void Serialize(const std::string &path) const;
+
   // Get the root of the trie, should only be used in test cases.
   auto GetRoot() const -> std::shared_ptr<const TrieNode> { return root_; }
+
+  auto GetLayout() const -> TrieLayout { return layout_; }
+
+  auto GetNodePool() const -> const std::shared_ptr<NodePool> & { return pool_; }
 };
 
 }  // namespace bustub
\ No newline at end of file
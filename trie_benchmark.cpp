@@ -0,0 +1,394 @@
+// Throughput and latency benchmarks for the trie and TrieStore. Every result is printed as one JSON object per line:
+//
+//   {"benchmark":"get","keys":"dense","value":"uint32","layout":"compressed","threads":1,"ops":100000,
+//    "ops_per_sec":...,"p50_ns":...,"p99_ns":...}
+//
+// Usage: trie_benchmark [--keys=N] [--threads=1,2,4,8] [--filter=SUBSTRING]
+//
+// Latencies are taken per operation (per batch for batched benchmarks), so throughput includes the cost of reading
+// the clock; compare numbers from the same binary only.
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "trie.h"
+#include "trie_frozen.h"
+#include "trie_iterator.h"
+#include "trie_store.h"
+#include "typed_trie.h"
+
+namespace bustub {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchmarkOptions {
+  size_t keys_{100000};
+  std::vector<size_t> threads_{1, 2, 4, 8};
+  std::string filter_;
+};
+
+// Operations per batch in the batched benchmarks.
+static constexpr size_t kBatchSize = 64;
+
+// A named way of generating `count` distinct keys.
+struct KeyDistribution {
+  const char *name_;
+  std::vector<std::string> (*generate_)(size_t count, std::mt19937_64 &gen);
+};
+
+// Zero-padded decimal numbers, the densest case: every node has up to ten children and the keys are short.
+static auto DenseKeys(size_t count, std::mt19937_64 &gen) -> std::vector<std::string> {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  char buffer[32];
+  for (size_t i = 0; i < count; i++) {
+    std::snprintf(buffer, sizeof(buffer), "%05zu", i);
+    keys.emplace_back(buffer);
+  }
+  std::shuffle(keys.begin(), keys.end(), gen);
+  return keys;
+}
+
+// Long paths that share a deep common prefix and only fan out at the end, like hierarchical metric names.
+static auto SharedPrefixKeys(size_t count, std::mt19937_64 &gen) -> std::vector<std::string> {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  char buffer[96];
+  for (size_t i = 0; i < count; i++) {
+    std::snprintf(buffer, sizeof(buffer), "cluster-01/region-eu-west/service-frontend/host-%03zu/metric-%06zu",
+                  i % 100, i);
+    keys.emplace_back(buffer);
+  }
+  std::shuffle(keys.begin(), keys.end(), gen);
+  return keys;
+}
+
+// Random bytes of random length, with the full fan-out of 256 near the root.
+static auto RandomKeys(size_t count, std::mt19937_64 &gen) -> std::vector<std::string> {
+  std::vector<std::string> keys;
+  keys.reserve(count);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_int_distribution<size_t> length(8, 24);
+  for (size_t i = 0; i < count; i++) {
+    std::string key(length(gen), '\0');
+    for (auto &c : key) {
+      c = static_cast<char>(byte(gen));
+    }
+    keys.push_back(std::move(key));
+  }
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  std::shuffle(keys.begin(), keys.end(), gen);
+  return keys;
+}
+
+template <class T>
+auto MakeValue(size_t i) -> T;
+
+template <>
+auto MakeValue<uint32_t>(size_t i) -> uint32_t {
+  return static_cast<uint32_t>(i);
+}
+
+template <>
+auto MakeValue<std::string>(size_t i) -> std::string {
+  return "value-" + std::to_string(i) + std::string(24, 'x');
+}
+
+template <class T>
+auto ValueTypeName() -> const char *;
+
+template <>
+auto ValueTypeName<uint32_t>() -> const char * {
+  return "uint32";
+}
+
+template <>
+auto ValueTypeName<std::string>() -> const char * {
+  return "string";
+}
+
+// Collects the latencies of one benchmark and prints its result line.
+class Recorder {
+ public:
+  Recorder(const BenchmarkOptions &options, std::string benchmark, std::string keys, std::string value,
+           TrieLayout layout, size_t threads = 1)
+      : benchmark_(std::move(benchmark)),
+        keys_(std::move(keys)),
+        value_(std::move(value)),
+        layout_(layout == TrieLayout::kPathCompressed ? "compressed" : "per_character"),
+        threads_(threads) {
+    std::string name = benchmark_ + "/" + keys_ + "/" + value_ + "/" + layout_;
+    enabled_ = options.filter_.empty() || name.find(options.filter_) != std::string::npos;
+  }
+
+  auto Enabled() const -> bool { return enabled_; }
+
+  // Run `fn` once as one operation covering `ops` operations, and record its latency.
+  template <class Fn>
+  void Time(Fn &&fn, size_t ops = 1) {
+    auto start = Clock::now();
+    fn();
+    latencies_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    ops_ += ops;
+  }
+
+  // Merge the latencies another thread recorded for the same benchmark.
+  void Merge(const Recorder &that) {
+    latencies_.insert(latencies_.end(), that.latencies_.begin(), that.latencies_.end());
+    ops_ += that.ops_;
+  }
+
+  void Start() { start_ = Clock::now(); }
+
+  void Report() {
+    if (!enabled_ || latencies_.empty()) {
+      return;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+    std::sort(latencies_.begin(), latencies_.end());
+    auto p50 = latencies_[latencies_.size() / 2];
+    auto p99 = latencies_[std::min(latencies_.size() - 1, latencies_.size() * 99 / 100)];
+    std::printf(
+        "{\"benchmark\":\"%s\",\"keys\":\"%s\",\"value\":\"%s\",\"layout\":\"%s\",\"threads\":%zu,\"ops\":%zu,"
+        "\"ops_per_sec\":%.0f,\"p50_ns\":%lld,\"p99_ns\":%lld}\n",
+        benchmark_.c_str(), keys_.c_str(), value_.c_str(), layout_, threads_, ops_, static_cast<double>(ops_) / seconds,
+        static_cast<long long>(p50), static_cast<long long>(p99));  // NOLINT
+    std::fflush(stdout);
+  }
+
+ private:
+  std::string benchmark_;
+  std::string keys_;
+  std::string value_;
+  const char *layout_;
+  size_t threads_;
+  bool enabled_;
+  size_t ops_{0};
+  Clock::time_point start_{Clock::now()};
+  std::vector<int64_t> latencies_;
+};
+
+// Single-threaded benchmarks of the persistent Trie: every operation produces a new version.
+template <class T>
+void BenchmarkTrie(const BenchmarkOptions &options, const KeyDistribution &distribution,
+                   const std::vector<std::string> &keys, TrieLayout layout) {
+  const std::string name = distribution.name_;
+  const std::string value = ValueTypeName<T>();
+  std::mt19937_64 gen(42);
+
+  Trie trie(layout);
+  Recorder put(options, "put", name, value, layout);
+  for (size_t i = 0; i < keys.size(); i++) {
+    put.Time([&] { trie = trie.Put<T>(keys[i], MakeValue<T>(i)); });
+  }
+  put.Report();
+
+  std::vector<size_t> order(keys.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  std::shuffle(order.begin(), order.end(), gen);
+
+  Recorder get(options, "get", name, value, layout);
+  if (get.Enabled()) {
+    size_t found = 0;
+    get.Start();
+    for (size_t i : order) {
+      get.Time([&] { found += trie.Get<T>(keys[i]) != nullptr ? 1 : 0; });
+    }
+    get.Report();
+    if (found != keys.size()) {
+      std::fprintf(stderr, "get: found %zu of %zu keys\n", found, keys.size());
+    }
+  }
+
+  Recorder multi_get(options, "multi_get", name, value, layout);
+  if (multi_get.Enabled()) {
+    std::vector<std::string_view> batch;
+    multi_get.Start();
+    for (size_t begin = 0; begin < order.size(); begin += kBatchSize) {
+      batch.clear();
+      for (size_t i = begin; i < std::min(order.size(), begin + kBatchSize); i++) {
+        batch.emplace_back(keys[order[i]]);
+      }
+      multi_get.Time([&] { trie.MultiGet<T>(batch); }, batch.size());
+    }
+    multi_get.Report();
+  }
+
+  // The same lookups on a frozen copy of the trie
+  Recorder frozen_get(options, "frozen_get", name, value, layout);
+  if (frozen_get.Enabled()) {
+    auto frozen = Freeze(trie);
+    size_t found = 0;
+    frozen_get.Start();
+    for (size_t i : order) {
+      frozen_get.Time([&] { found += frozen.Get<T>(keys[i]).has_value() ? 1 : 0; });
+    }
+    frozen_get.Report();
+    if (found != keys.size()) {
+      std::fprintf(stderr, "frozen_get: found %zu of %zu keys\n", found, keys.size());
+    }
+  }
+
+  // The same writes and lookups on a TypedTrie, which skips the virtual calls and type checks
+  Recorder typed_put(options, "typed_put", name, value, layout);
+  Recorder typed_get(options, "typed_get", name, value, layout);
+  if (typed_put.Enabled() || typed_get.Enabled()) {
+    TypedTrie<T> typed(layout);
+    typed_put.Start();
+    for (size_t i = 0; i < keys.size(); i++) {
+      typed_put.Time([&] { typed = typed.Put(keys[i], MakeValue<T>(i)); });
+    }
+    typed_put.Report();
+    size_t found = 0;
+    typed_get.Start();
+    for (size_t i : order) {
+      typed_get.Time([&] { found += typed.Get(keys[i]) != nullptr ? 1 : 0; });
+    }
+    typed_get.Report();
+    if (found != keys.size()) {
+      std::fprintf(stderr, "typed_get: found %zu of %zu keys\n", found, keys.size());
+    }
+  }
+
+  // A scan reads the keys that share all but the last two bytes of a random key.
+  Recorder scan(options, "scan", name, value, layout);
+  if (scan.Enabled()) {
+    size_t scanned = 0;
+    scan.Start();
+    for (size_t n = 0; n < std::max<size_t>(keys.size() / 100, 1); n++) {
+      const std::string &key = keys[order[n]];
+      std::string_view prefix(key.data(), key.size() - std::min<size_t>(key.size(), 2));
+      scan.Time([&] {
+        for (auto entry : trie.Scan<T>(prefix)) {
+          (void)entry;
+          scanned++;
+        }
+      });
+    }
+    scan.Report();
+  }
+
+  Recorder batch(options, "batch_put", name, value, layout);
+  if (batch.Enabled()) {
+    Trie batched(layout);
+    batch.Start();
+    for (size_t begin = 0; begin < keys.size(); begin += kBatchSize) {
+      size_t end = std::min(keys.size(), begin + kBatchSize);
+      batch.Time(
+          [&] {
+            WriteBatch ops;
+            for (size_t i = begin; i < end; i++) {
+              ops.Put<T>(keys[i], MakeValue<T>(i));
+            }
+            batched = batched.Apply(std::move(ops));
+          },
+          end - begin);
+    }
+    batch.Report();
+  }
+
+  Recorder remove(options, "remove", name, value, layout);
+  if (remove.Enabled()) {
+    remove.Start();
+    for (size_t i : order) {
+      remove.Time([&] { trie = trie.Remove(keys[i]); });
+    }
+    remove.Report();
+  }
+}
+
+// Concurrent readers and writers on one TrieStore: every thread does 90% Get and 10% Put on random keys.
+void BenchmarkStore(const BenchmarkOptions &options, const KeyDistribution &distribution,
+                    const std::vector<std::string> &keys) {
+  static constexpr size_t kWritePercent = 10;
+  for (size_t threads : options.threads_) {
+    Recorder total(options, "store_get_put_mix", distribution.name_, ValueTypeName<uint32_t>(),
+                   TrieLayout::kPathCompressed, threads);
+    if (!total.Enabled()) {
+      continue;
+    }
+    TrieStore store(TrieLayout::kPathCompressed);
+    WriteBatch load;
+    for (size_t i = 0; i < keys.size(); i++) {
+      load.Put<uint32_t>(keys[i], MakeValue<uint32_t>(i));
+    }
+    store.Apply(std::move(load));
+
+    std::vector<Recorder> recorders(threads, total);
+    std::vector<std::thread> workers;
+    total.Start();
+    for (size_t t = 0; t < threads; t++) {
+      workers.emplace_back([&, t] {
+        std::mt19937_64 gen(t);
+        for (size_t n = 0; n < keys.size() / threads; n++) {
+          size_t i = gen() % keys.size();
+          if (gen() % 100 < kWritePercent) {
+            recorders[t].Time([&] { store.Put<uint32_t>(keys[i], MakeValue<uint32_t>(n)); });
+          } else {
+            recorders[t].Time([&] { store.Get<uint32_t>(keys[i]); });
+          }
+        }
+      });
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (const auto &recorder : recorders) {
+      total.Merge(recorder);
+    }
+    total.Report();
+  }
+}
+
+static auto ParseOptions(int argc, char **argv) -> BenchmarkOptions {
+  BenchmarkOptions options;
+  for (int i = 1; i < argc; i++) {
+    std::string_view arg(argv[i]);
+    if (arg.starts_with("--keys=")) {
+      options.keys_ = std::strtoull(argv[i] + 7, nullptr, 10);
+    } else if (arg.starts_with("--threads=")) {
+      options.threads_.clear();
+      std::stringstream list(std::string(arg.substr(10)));
+      std::string count;
+      while (std::getline(list, count, ',')) {
+        options.threads_.push_back(std::max<size_t>(std::strtoull(count.c_str(), nullptr, 10), 1));
+      }
+    } else if (arg.starts_with("--filter=")) {
+      options.filter_ = std::string(arg.substr(9));
+    } else {
+      std::fprintf(stderr, "usage: %s [--keys=N] [--threads=1,2,4,8] [--filter=SUBSTRING]\n", argv[0]);
+      std::exit(2);
+    }
+  }
+  return options;
+}
+
+}  // namespace bustub
+
+auto main(int argc, char **argv) -> int {
+  using bustub::TrieLayout;
+  auto options = bustub::ParseOptions(argc, argv);
+  const bustub::KeyDistribution distributions[] = {
+      {"dense", bustub::DenseKeys}, {"shared_prefix", bustub::SharedPrefixKeys}, {"random", bustub::RandomKeys}};
+  for (const auto &distribution : distributions) {
+    std::mt19937_64 gen(2333);
+    auto keys = distribution.generate_(options.keys_, gen);
+    for (auto layout : {TrieLayout::kPathCompressed, TrieLayout::kPerCharacter}) {
+      bustub::BenchmarkTrie<uint32_t>(options, distribution, keys, layout);
+      bustub::BenchmarkTrie<std::string>(options, distribution, keys, layout);
+    }
+    bustub::BenchmarkStore(options, distribution, keys);
+  }
+  return 0;
+}
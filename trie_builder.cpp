@@ -0,0 +1,189 @@
+#include "trie_builder.h"
+
+#include <stdexcept>
+#include <vector>
+
+namespace bustub {
+
+void TrieBuilder::PutLeaf(std::string_view key, std::shared_ptr<const TrieNode> leaf) {
+  Node *current = &root_;
+  for (char c : key) {
+    auto *child = current->children_.Lookup(c);
+    if (child == nullptr) {
+      current->children_.insert_or_assign(c, std::make_unique<Node>());
+      child = current->children_.Lookup(c);
+    }
+    current = child->get();
+  }
+  current->leaf_ = std::move(leaf);
+}
+
+void TrieBuilder::Remove(std::string_view key) {
+  // Only the value is dropped here; nodes left without value or children are pruned by Freeze
+  Node *current = &root_;
+  for (char c : key) {
+    auto *child = current->children_.Lookup(c);
+    if (child == nullptr) {
+      return;
+    }
+    current = child->get();
+  }
+  current->leaf_ = nullptr;
+}
+
+// One builder node being frozen, with the frozen nodes of the children before `next_`
+struct TrieBuilder::FreezeFrame {
+  const Node *node_;
+  std::string segment_;
+  bool is_root_;
+  TrieNode::Children children_;
+  ChildArray<Node, std::unique_ptr<Node>>::const_iterator next_;
+};
+
+auto TrieBuilder::StartFreeze(const Node *node, bool is_root) const -> FreezeFrame {
+  // In the compressed layout, fold a chain of value-less single-child nodes into this node's segment
+  std::string segment;
+  if (layout_ == TrieLayout::kPathCompressed && !is_root) {
+    while (node->leaf_ == nullptr && node->children_.size() == 1) {
+      const auto &[ch, child] = *node->children_.begin();
+      segment.push_back(ch);
+      node = child.get();
+    }
+  }
+  TrieNode::Children children;
+  children.reserve(node->children_.size());
+  return {node, std::move(segment), is_root, std::move(children), node->children_.begin()};
+}
+
+auto TrieBuilder::FinishFreeze(FreezeFrame &frame) const -> std::shared_ptr<const TrieNode> {
+  const Node *node = frame.node_;
+  auto &children = frame.children_;
+  auto &segment = frame.segment_;
+  if (node->leaf_ == nullptr) {
+    if (children.empty()) {
+      // Every key below was removed
+      return nullptr;
+    }
+    if (layout_ == TrieLayout::kPathCompressed && !frame.is_root_ && children.size() == 1) {
+      // Removals left this node with a single child: fold it into that child as well
+      const auto &[ch, child] = *children.begin();
+      segment.push_back(ch);
+      segment.append(child->segment_);
+      return TrieNodes::WithSegment(*child, std::move(segment), Context());
+    }
+    return TrieNodes::MakeInner(std::move(children), std::move(segment), Context());
+  }
+
+  if (children.empty() && segment.empty()) {
+    // A leaf: the node recorded by Put can be used as is
+    return node->leaf_;
+  }
+  auto frozen = TrieNodes::WithChildren(*node->leaf_, std::move(children), Context());
+  frozen->segment_ = std::move(segment);
+  return frozen;
+}
+
+auto TrieBuilder::FreezeNode(const Node *root) const -> std::shared_ptr<const TrieNode> {
+  // Children first, with an explicit stack: a per-character trie is as deep as its longest key
+  std::vector<FreezeFrame> stack;
+  stack.push_back(StartFreeze(root, true));
+  while (true) {
+    FreezeFrame &frame = stack.back();
+    if (frame.next_ != frame.node_->children_.end()) {
+      const Node *child = frame.next_->second.get();
+      stack.push_back(StartFreeze(child, false));
+      continue;
+    }
+    auto frozen = FinishFreeze(frame);
+    stack.pop_back();
+    if (stack.empty()) {
+      return frozen;
+    }
+    FreezeFrame &parent = stack.back();
+    if (frozen != nullptr) {
+      parent.children_.insert_or_assign(parent.next_->first, std::move(frozen));
+    }
+    ++parent.next_;
+  }
+}
+
+auto TrieBuilder::Freeze() -> Trie {
+  auto root = FreezeNode(&root_);
+  ReleaseChildren(root_.children_);
+  root_.children_ = {};
+  root_.leaf_ = nullptr;
+  return Trie(std::move(root), layout_, pool_);
+}
+
+auto TrieBuilder::Partition(const std::vector<std::string_view> &keys, size_t parts)
+    -> std::pair<size_t, std::vector<size_t>> {
+  std::vector<size_t> bounds{0};
+  if (keys.empty()) {
+    return {0, bounds};
+  }
+  for (size_t i = 1; i < keys.size(); i++) {
+    if (keys[i] < keys[i - 1]) {
+      throw std::invalid_argument("TrieBuilder::BuildParallel: keys are not sorted");
+    }
+  }
+
+  // In sorted input, the common prefix of all keys is the one of the first and last keys
+  const auto &first = keys.front();
+  const auto &last = keys.back();
+  size_t prefix_size = std::mismatch(first.begin(), first.end(), last.begin(), last.end()).first - first.begin();
+
+  // Cut only where the byte after the prefix changes. The key equal to the prefix, if any, sorts first and stays in
+  // the first partition, which then holds the value of the node at the prefix.
+  size_t target = (keys.size() + parts - 1) / parts;
+  for (size_t i = 1; i < keys.size(); i++) {
+    bool new_group = keys[i - 1].size() == prefix_size || keys[i - 1][prefix_size] != keys[i][prefix_size];
+    if (new_group && i - bounds.back() >= target) {
+      bounds.push_back(i);
+    }
+  }
+  bounds.push_back(keys.size());
+  return {prefix_size, bounds};
+}
+
+auto TrieBuilder::Stitch(std::string_view prefix, std::vector<Trie> parts, const Trie &target) -> Trie {
+  const WriteContext ctx{target.layout_, target.pool_.get()};
+  TrieNode::Children children;
+  const TrieNode *value_node = nullptr;
+  for (const auto &part : parts) {
+    if (part.root_ == nullptr) {
+      continue;
+    }
+    if (part.root_->is_value_node_) {
+      value_node = part.root_.get();
+    }
+    for (const auto &[ch, child] : part.root_->children_) {
+      children.insert_or_assign(ch, child);
+    }
+  }
+  if (value_node == nullptr && children.empty()) {
+    return target;
+  }
+  std::shared_ptr<TrieNode> node = value_node != nullptr ? TrieNodes::WithChildren(*value_node, std::move(children), ctx)
+                                                         : TrieNodes::MakeInner(std::move(children), "", ctx);
+  if (prefix.empty()) {
+    return target.WithRoot(std::move(node));
+  }
+
+  // Add the path down to the node at `prefix`. No key branches off it, so in the compressed layout the whole path is
+  // the node's segment.
+  std::shared_ptr<const TrieNode> current;
+  size_t path_size = prefix.size();
+  if (ctx.layout_ == TrieLayout::kPathCompressed) {
+    node->segment_ = std::string(prefix.substr(1));
+    path_size = 1;
+  }
+  current = std::move(node);
+  for (size_t i = path_size; i-- > 0;) {
+    TrieNode::Children path;
+    path.insert_or_assign(prefix[i], std::move(current));
+    current = TrieNodes::MakeInner(std::move(path), "", ctx);
+  }
+  return target.WithRoot(std::move(current));
+}
+
+}  // namespace bustub
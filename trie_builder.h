@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_builder.h
+//
+// Identification: src/include/primer/trie_builder.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+// A TrieBuilder builds a Trie from scratch in place. Unlike `Trie::Put`, which copies the whole root-to-leaf path of
+// every key, the builder owns every node uniquely and mutates it directly: a Put walks down the existing path, adds
+// the missing nodes and stores the value, without copying anything or touching a reference count.
+//
+// `Freeze` then turns the builder's nodes into immutable `TrieNode`s in one bottom-up pass, allocating every node
+// exactly once with its final children, and returns the resulting trie. The frozen trie has exactly the node format
+// that `Put` produces for the chosen layout.
+//
+// `BuildParallel` bulk-loads sorted input on several threads: keys are partitioned by the byte that follows their
+// common prefix, each partition builds its disjoint subtrees with a builder of its own, and the subtrees are stitched
+// under one root at the end.
+class TrieBuilder {
+ public:
+  // Create a builder of tries with the given layout, whose nodes and values are allocated from `pool` if not nullptr.
+  explicit TrieBuilder(TrieLayout layout = TrieLayout::kPerCharacter, std::shared_ptr<NodePool> pool = nullptr)
+      : layout_(layout), pool_(std::move(pool)) {}
+
+  // Set the value of `key` and its score, replacing any previous value.
+  template <class T>
+  void Put(std::string_view key, T value, uint64_t score = 0) {
+    PutLeaf(key, TrieNodes::MakeLeaf(TrieNode::Children(), "", std::move(value), score, Context()));
+  }
+
+  // Remove the value of `key`, if any.
+  void Remove(std::string_view key);
+
+  // Build the immutable trie holding everything put so far. The builder is left empty and can be reused.
+  auto Freeze() -> Trie;
+
+  // Build the trie holding `entries`, which must be sorted by key (duplicate keys keep the last value), on up to
+  // `threads` threads, or one per core if 0, allocating from `pool` if not nullptr. The result is the trie sequential
+  // Puts would build. Throws std::invalid_argument if the keys are not sorted.
+  //
+  // The keys are split into contiguous partitions of similar size, each made of whole groups of keys sharing the byte
+  // after the common prefix of all keys, so partitions never share a node below that point. A single group larger
+  // than a partition is built by one thread.
+  template <class T>
+  static auto BuildParallel(std::vector<std::pair<std::string, T>> entries,
+                            TrieLayout layout = TrieLayout::kPerCharacter, size_t threads = 0,
+                            const std::shared_ptr<NodePool> &pool = nullptr) -> Trie {
+    std::vector<std::string_view> keys;
+    keys.reserve(entries.size());
+    for (const auto &entry : entries) {
+      keys.emplace_back(entry.first);
+    }
+    if (threads == 0) {
+      threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    auto [prefix_size, bounds] = Partition(keys, threads);
+
+    std::vector<Trie> parts(bounds.size() - 1, Trie(layout, pool));
+    std::vector<std::exception_ptr> errors(parts.size());
+    auto build = [&](size_t part) {
+      try {
+        TrieBuilder builder(layout, pool);
+        for (size_t i = bounds[part]; i < bounds[part + 1]; i++) {
+          builder.Put<T>(keys[i].substr(prefix_size), std::move(entries[i].second));
+        }
+        parts[part] = builder.Freeze();
+      } catch (...) {
+        errors[part] = std::current_exception();
+      }
+    };
+    std::vector<std::thread> workers;
+    workers.reserve(parts.size());
+    for (size_t part = 1; part < parts.size(); part++) {
+      workers.emplace_back(build, part);
+    }
+    if (!parts.empty()) {
+      build(0);
+    }
+    for (auto &worker : workers) {
+      worker.join();
+    }
+    for (const auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    return Stitch(keys.empty() ? std::string_view() : keys.front().substr(0, prefix_size), std::move(parts),
+                  Trie(layout, pool));
+  }
+
+ private:
+  struct Node {
+    Node() = default;
+    Node(const Node &) = delete;
+    auto operator=(const Node &) -> Node & = delete;
+    // Releases the children without recursing once per level, see `ReleaseChildren`.
+    ~Node() { ReleaseChildren(children_); }
+
+    ChildArray<Node, std::unique_ptr<Node>> children_;
+    // A childless node holding this node's value, as `WriteBatch` records it; nullptr if there is no value.
+    std::shared_ptr<const TrieNode> leaf_;
+  };
+
+  void PutLeaf(std::string_view key, std::shared_ptr<const TrieNode> leaf);
+
+  auto Context() const -> WriteContext { return {layout_, pool_.get()}; }
+
+  struct FreezeFrame;
+
+  // Build the immutable trie holding the keys of the builder trie at `root`, without recursing.
+  auto FreezeNode(const Node *root) const -> std::shared_ptr<const TrieNode>;
+  auto StartFreeze(const Node *node, bool is_root) const -> FreezeFrame;
+  auto FinishFreeze(FreezeFrame &frame) const -> std::shared_ptr<const TrieNode>;
+
+  // Check that `keys` are sorted, and split them into at most `parts` partitions for `BuildParallel`. Returns the
+  // size of the common prefix of all keys and the partition boundaries: partition i is [bounds[i], bounds[i + 1]).
+  static auto Partition(const std::vector<std::string_view> &keys, size_t parts)
+      -> std::pair<size_t, std::vector<size_t>>;
+
+  // Build the trie whose node at `prefix` holds the union of the roots of `parts`, which have disjoint children. The
+  // new nodes use the layout and the pool of `target`, an empty trie.
+  static auto Stitch(std::string_view prefix, std::vector<Trie> parts, const Trie &target) -> Trie;
+
+  TrieLayout layout_;
+  std::shared_ptr<NodePool> pool_;
+  Node root_;
+};
+
+}  // namespace bustub
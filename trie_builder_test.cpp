@@ -0,0 +1,179 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_builder_test.cpp
+//
+// Identification: test/primer/trie_builder_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+#include "trie_builder.h"
+
+namespace bustub {
+
+namespace {
+
+// Whether two tries have the same nodes, segments and values.
+auto SameShape(const TrieNode *a, const TrieNode *b) -> bool {
+  if (a == nullptr || b == nullptr) {
+    return a == b;
+  }
+  if (a->segment_ != b->segment_ || a->is_value_node_ != b->is_value_node_ ||
+      a->children_.size() != b->children_.size() || a->MaxScore() != b->MaxScore()) {
+    return false;
+  }
+  if (a->is_value_node_ && *static_cast<const TrieNodeWithValue<uint32_t> *>(a)->value_ !=
+                               *static_cast<const TrieNodeWithValue<uint32_t> *>(b)->value_) {
+    return false;
+  }
+  for (const auto &[ch, child] : a->children_) {
+    const auto *other = b->children_.Lookup(ch);
+    if (other == nullptr || !SameShape(child.get(), other->get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(TrieBuilderTest, StructureTest) {
+  // A frozen trie has the same shape as one built with Put.
+  TrieBuilder builder;
+  builder.Put<uint32_t>("test", 233);
+  builder.Put<std::string>("te", "23");
+  auto trie = builder.Freeze();
+  ASSERT_EQ(*trie.Get<uint32_t>("test"), 233);
+  ASSERT_EQ(*trie.Get<std::string>("te"), "23");
+  auto root = trie.GetRoot();
+  ASSERT_EQ(root->children_.size(), 1);
+  ASSERT_EQ(root->children_.at('t')->children_.at('e')->children_.size(), 1);
+  ASSERT_TRUE(root->children_.at('t')->children_.at('e')->is_value_node_);
+  ASSERT_TRUE(!root->children_.at('t')->is_value_node_);
+
+  // The builder is empty after Freeze, and the frozen trie can be written as usual.
+  ASSERT_EQ(builder.Freeze().GetRoot(), nullptr);
+  trie = trie.Put<uint32_t>("tes", 23);
+  ASSERT_EQ(*trie.Get<uint32_t>("tes"), 23);
+  ASSERT_EQ(*trie.Get<uint32_t>("test"), 233);
+}
+
+TEST(TrieBuilderTest, MatchesPutTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    std::mt19937 rng(2333);
+    TrieBuilder builder(layout);
+    auto expected = Trie(layout);
+    for (uint32_t i = 0; i < 20000; i++) {
+      std::string key(rng() % 10, 'a');
+      for (auto &c : key) {
+        c = static_cast<char>('a' + rng() % 3);
+      }
+      if (rng() % 4 == 0) {
+        builder.Remove(key);
+        expected = expected.Remove(key);
+      } else {
+        builder.Put<uint32_t>(key, i);
+        expected = expected.Put<uint32_t>(key, i);
+      }
+    }
+    auto trie = builder.Freeze();
+    ASSERT_TRUE(trie.GetLayout() == layout);
+    for (uint32_t i = 0; i < 5000; i++) {
+      std::string key(rng() % 10, 'a');
+      for (auto &c : key) {
+        c = static_cast<char>('a' + rng() % 3);
+      }
+      const auto *want = expected.Get<uint32_t>(key);
+      const auto *got = trie.Get<uint32_t>(key);
+      ASSERT_EQ(want == nullptr, got == nullptr);
+      if (want != nullptr) {
+        ASSERT_EQ(*want, *got);
+      }
+    }
+  }
+}
+
+TEST(TrieBuilderTest, CompressedLayoutTest) {
+  TrieBuilder builder(TrieLayout::kPathCompressed);
+  builder.Put<uint32_t>("tenant/service/cpu", 1);
+  builder.Put<uint32_t>("tenant/service/mem", 2);
+  builder.Put<uint32_t>("tenant/other", 3);
+  builder.Remove("tenant/other");
+  auto trie = builder.Freeze();
+  auto split = trie.GetRoot()->children_.at('t');
+  ASSERT_EQ(split->segment_, "enant/service/");
+  ASSERT_EQ(split->children_.at('c')->segment_, "pu");
+  ASSERT_EQ(*trie.Get<uint32_t>("tenant/service/mem"), 2);
+  ASSERT_EQ(trie.Get<uint32_t>("tenant/other"), nullptr);
+}
+
+TEST(TrieBuilderTest, DeepKeyTest) {
+  // Freezing and dropping a builder do not recurse once per key byte
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    std::string key(20000, 'a');
+    TrieBuilder builder(layout);
+    builder.Put<uint32_t>(key, 1);
+    builder.Put<uint32_t>(key.substr(0, 10000) + "b", 2);
+    auto trie = builder.Freeze();
+    ASSERT_EQ(*trie.Get<uint32_t>(key), 1);
+    ASSERT_EQ(*trie.Get<uint32_t>(key.substr(0, 10000) + "b"), 2);
+
+    TrieBuilder dropped(layout);
+    dropped.Put<uint32_t>(key, 1);
+  }
+}
+
+TEST(TrieBuilderTest, ParallelBuildTest) {
+  std::mt19937 rng(233);
+  std::vector<std::vector<std::string>> inputs = {{}, {""}, {"single"}, {"", "a", "b"}, {"ab", "abc", "abd"}};
+  inputs.emplace_back();
+  // A large input behind a common prefix, with duplicates and the prefix itself as a key
+  for (uint32_t i = 0; i < 20000; i++) {
+    std::string key = "tenant/";
+    key.resize(key.size() + rng() % 6, 'a');
+    for (size_t c = 7; c < key.size(); c++) {
+      key[c] = static_cast<char>('a' + rng() % 26);
+    }
+    inputs.back().push_back(key);
+  }
+  std::sort(inputs.back().begin(), inputs.back().end());
+
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    for (const auto &keys : inputs) {
+      for (size_t threads : {1, 3, 8}) {
+        std::vector<std::pair<std::string, uint32_t>> entries;
+        TrieBuilder builder(layout);
+        for (uint32_t i = 0; i < keys.size(); i++) {
+          entries.emplace_back(keys[i], i);
+          builder.Put<uint32_t>(keys[i], i);
+        }
+        auto expected = builder.Freeze();
+        auto trie = TrieBuilder::BuildParallel(std::move(entries), layout, threads);
+        ASSERT_TRUE(trie.GetLayout() == layout);
+        ASSERT_TRUE(SameShape(trie.GetRoot().get(), expected.GetRoot().get()));
+      }
+    }
+  }
+
+  bool thrown = false;
+  try {
+    std::vector<std::pair<std::string, uint32_t>> unsorted = {{"b", 1}, {"a", 2}};
+    TrieBuilder::BuildParallel(std::move(unsorted));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+}
+
+}  // namespace bustub
@@ -0,0 +1,296 @@
+#include "trie_checkpoint.h"
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+#include "durable_file.h"
+#include "trie_snapshot.h"
+
+namespace bustub {
+
+struct TrieCheckpointer::Header {
+  static constexpr char kMagic[8] = {'B', 'T', 'C', 'K', 'P', 'T', '0', '1'};
+  static constexpr uint32_t kVersion = 1;
+
+  char magic_[8];
+  uint32_t version_;
+  uint8_t layout_;
+  // 1 for a base file, 0 for a delta
+  uint8_t base_;
+  uint16_t reserved_;
+  // Number of the first node in this file
+  uint64_t first_number_;
+  uint64_t node_count_;
+  // Number of the root of the saved snapshot, 0 for an empty trie
+  uint64_t root_number_;
+};
+
+namespace {
+
+template <class V>
+void Append(std::string &out, const V &value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+// Appends the nodes of one snapshot that are not in `persisted` to `out`, children first
+class CheckpointWriter {
+ public:
+  CheckpointWriter(std::string &out, const std::unordered_map<uint64_t, uint64_t> &persisted, uint64_t next_number)
+      : out_(out), persisted_(persisted), next_number_(next_number) {}
+
+  // Write `root` and its subtree unless the chain already holds them, and return the number of `root`. Children are
+  // written first, with an explicit stack: a per-character trie is as deep as its longest key.
+  auto WriteNode(const TrieNode *root) -> uint64_t {
+    if (auto it = persisted_.find(root->id_); it != persisted_.end()) {
+      // The whole subtree is shared with a snapshot the chain already holds
+      return it->second;
+    }
+    // A node being written, with the numbers of its children before `next_`
+    struct Frame {
+      const TrieNode *node_;
+      std::vector<uint64_t> children_;
+      TrieNode::Children::const_iterator next_;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({root, {}, root->children_.begin()});
+    while (true) {
+      Frame &frame = stack.back();
+      if (frame.next_ != frame.node_->children_.end()) {
+        const TrieNode *child = frame.next_->second.get();
+        if (auto it = persisted_.find(child->id_); it != persisted_.end()) {
+          frame.children_.push_back(it->second);
+          ++frame.next_;
+        } else {
+          stack.push_back({child, {}, child->children_.begin()});
+        }
+        continue;
+      }
+      uint64_t number = WriteRecord(*frame.node_, frame.children_);
+      stack.pop_back();
+      if (stack.empty()) {
+        return number;
+      }
+      stack.back().children_.push_back(number);
+      ++stack.back().next_;
+    }
+  }
+
+  auto NextNumber() const -> uint64_t { return next_number_; }
+  auto Written() -> std::vector<std::pair<uint64_t, uint64_t>> & { return written_; }
+
+ private:
+  std::string &out_;
+  const std::unordered_map<uint64_t, uint64_t> &persisted_;
+  uint64_t next_number_;
+  // (id, number) of every node written to this file
+  std::vector<std::pair<uint64_t, uint64_t>> written_;
+
+  // Append the record of `node`, whose children have the given numbers, and return the number of the node
+  auto WriteRecord(const TrieNode &node, const std::vector<uint64_t> &children) -> uint64_t {
+    auto [value_type, value_size] = SnapshotFormat::ValueInfo(node);
+    Append(out_, value_type);
+    Append(out_, static_cast<uint16_t>(node.children_.size()));
+    Append(out_, static_cast<uint32_t>(node.segment_.size()));
+    Append(out_, node.Score());
+    for (const auto &[ch, child] : node.children_) {
+      out_.push_back(ch);
+    }
+    for (uint64_t number : children) {
+      Append(out_, number);
+    }
+    out_.append(node.segment_);
+    size_t value_offset = out_.size();
+    out_.resize(value_offset + value_size);
+    SnapshotFormat::EncodeValue(node, reinterpret_cast<std::byte *>(out_.data() + value_offset));
+
+    uint64_t number = next_number_++;
+    written_.emplace_back(node.id_, number);
+    return number;
+  }
+};
+
+// Reads the records of one file, checking every size and reference against what has been read so far
+class CheckpointReader {
+ public:
+  explicit CheckpointReader(std::string_view data) : data_(data) {}
+
+  auto Remaining() const -> size_t { return data_.size() - pos_; }
+
+  template <class V>
+  auto Read() -> V {
+    V value;
+    std::memcpy(&value, Take(sizeof(V)), sizeof(V));
+    return value;
+  }
+
+  auto Take(size_t size) -> const char * {
+    if (Remaining() < size) {
+      throw std::runtime_error("TrieCheckpointer: truncated checkpoint");
+    }
+    const char *data = data_.data() + pos_;
+    pos_ += size;
+    return data;
+  }
+
+ private:
+  std::string_view data_;
+  size_t pos_{0};
+};
+
+}  // namespace
+
+auto TrieCheckpointer::Write(const Trie &trie, const std::string &path, bool base) -> size_t {
+  static const std::unordered_map<uint64_t, uint64_t> kNothingPersisted;
+  const auto &persisted = base ? kNothingPersisted : persisted_;
+  uint64_t first_number = base ? 1 : next_number_;
+
+  std::string image(sizeof(Header), '\0');
+  CheckpointWriter writer(image, persisted, first_number);
+  uint64_t root_number = trie.root_ == nullptr ? 0 : writer.WriteNode(trie.root_.get());
+
+  Header header{};
+  std::memcpy(header.magic_, Header::kMagic, sizeof(header.magic_));
+  header.version_ = Header::kVersion;
+  header.layout_ = static_cast<uint8_t>(trie.layout_);
+  header.base_ = base ? 1 : 0;
+  header.first_number_ = first_number;
+  header.node_count_ = writer.NextNumber() - first_number;
+  header.root_number_ = root_number;
+  std::memcpy(image.data(), &header, sizeof(header));
+
+  // Never a torn file in the chain, and nothing a crash could lose once the chain counts on the file
+  WriteFileDurably(path, image, "TrieCheckpointer");
+
+  // The file is in place: only now does the chain hold its nodes
+  if (base) {
+    persisted_.clear();
+  }
+  for (const auto &[id, number] : writer.Written()) {
+    persisted_.emplace(id, number);
+  }
+  next_number_ = writer.NextNumber();
+  started_ = true;
+  if (base) {
+    reached_ = persisted_.size();
+  } else if (persisted_.size() > 2 * reached_) {
+    Prune(trie);
+  }
+  return header.node_count_;
+}
+
+void TrieCheckpointer::Prune(const Trie &trie) {
+  // Every node of `trie` was just written or found in `persisted_`, so the walk finds each of them
+  std::unordered_map<uint64_t, uint64_t> reached;
+  std::vector<const TrieNode *> stack;
+  if (trie.root_ != nullptr) {
+    stack.push_back(trie.root_.get());
+  }
+  while (!stack.empty()) {
+    const TrieNode *node = stack.back();
+    stack.pop_back();
+    auto it = persisted_.find(node->id_);
+    if (it == persisted_.end() || !reached.emplace(*it).second) {
+      continue;
+    }
+    for (const auto &[ch, child] : node->children_) {
+      stack.push_back(child.get());
+    }
+  }
+  persisted_ = std::move(reached);
+  reached_ = persisted_.size();
+}
+
+auto TrieCheckpointer::WriteBase(const Trie &trie, const std::string &path) -> size_t {
+  return Write(trie, path, true);
+}
+
+auto TrieCheckpointer::WriteDelta(const Trie &trie, const std::string &path) -> size_t {
+  if (!started_) {
+    throw std::logic_error("TrieCheckpointer: a delta needs a base");
+  }
+  return Write(trie, path, false);
+}
+
+auto TrieCheckpointer::Load(const std::vector<std::string> &paths) -> std::pair<Trie, TrieCheckpointer> {
+  if (paths.empty()) {
+    throw std::runtime_error("TrieCheckpointer: no checkpoint to load");
+  }
+
+  // Every node of the chain by number; nodes[0] stands for the empty trie
+  std::vector<std::shared_ptr<const TrieNode>> nodes(1);
+  std::shared_ptr<const TrieNode> root;
+  TrieLayout layout = TrieLayout::kPerCharacter;
+
+  for (size_t i = 0; i < paths.size(); i++) {
+    std::ifstream in(paths[i], std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!in.good() && !in.eof()) {
+      throw std::runtime_error("TrieCheckpointer: cannot read " + paths[i]);
+    }
+
+    CheckpointReader reader(data);
+    auto header = reader.Read<Header>();
+    if (std::memcmp(header.magic_, Header::kMagic, sizeof(header.magic_)) != 0 ||
+        header.version_ != Header::kVersion || header.layout_ > static_cast<uint8_t>(TrieLayout::kPathCompressed)) {
+      throw std::runtime_error("TrieCheckpointer: not a checkpoint: " + paths[i]);
+    }
+    if ((header.base_ == 1) != (i == 0) || header.first_number_ != nodes.size() ||
+        (i > 0 && static_cast<TrieLayout>(header.layout_) != layout)) {
+      throw std::runtime_error("TrieCheckpointer: " + paths[i] + " does not continue the chain");
+    }
+    layout = static_cast<TrieLayout>(header.layout_);
+
+    for (uint64_t k = 0; k < header.node_count_; k++) {
+      auto value_type = reader.Read<uint8_t>();
+      auto child_count = reader.Read<uint16_t>();
+      auto segment_size = reader.Read<uint32_t>();
+      auto score = reader.Read<uint64_t>();
+      const char *keys = reader.Take(child_count);
+
+      TrieNode::Children children;
+      children.reserve(child_count);
+      for (uint16_t c = 0; c < child_count; c++) {
+        auto number = reader.Read<uint64_t>();
+        if (number == 0 || number >= nodes.size()) {
+          throw std::runtime_error("TrieCheckpointer: corrupt checkpoint " + paths[i]);
+        }
+        children.insert_or_assign(keys[c], nodes[number]);
+      }
+      std::string segment(reader.Take(segment_size), segment_size);
+
+      const auto *value = reinterpret_cast<const std::byte *>(data.data() + data.size() - reader.Remaining());
+      auto node = SnapshotFormat::DecodeNode(value_type, value, reader.Remaining(), std::move(children));
+      if (node == nullptr) {
+        throw std::runtime_error("TrieCheckpointer: corrupt checkpoint " + paths[i]);
+      }
+      reader.Take(SnapshotFormat::ValueInfo(*node).second);
+      node->segment_ = std::move(segment);
+      if (score != 0) {
+        if (!node->is_value_node_) {
+          throw std::runtime_error("TrieCheckpointer: corrupt checkpoint " + paths[i]);
+        }
+        static_cast<ScoredTrieNode &>(*node).SetScore(score);
+      }
+      nodes.push_back(std::move(node));
+    }
+
+    if (header.root_number_ >= nodes.size()) {
+      throw std::runtime_error("TrieCheckpointer: corrupt checkpoint " + paths[i]);
+    }
+    root = nodes[header.root_number_];
+  }
+
+  TrieCheckpointer checkpointer;
+  for (uint64_t number = 1; number < nodes.size(); number++) {
+    checkpointer.persisted_.emplace(nodes[number]->id_, number);
+  }
+  checkpointer.next_number_ = nodes.size();
+  checkpointer.started_ = true;
+  return {Trie(std::move(root), layout), std::move(checkpointer)};
+}
+
+}  // namespace bustub
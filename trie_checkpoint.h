@@ -0,0 +1,79 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_checkpoint.h
+//
+// Identification: src/include/primer/trie_checkpoint.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+// A TrieCheckpointer persists successive snapshots of a trie as a chain of files. A base file holds every node of
+// one snapshot. Each later delta file holds only the nodes of its snapshot that no earlier file of the chain holds,
+// plus the snapshot's root: since `Put` and `Remove` share every node off the path they rewrite, a delta costs
+// O(nodes written since the previous checkpoint), not O(size of the trie). `Load` replays a chain.
+//
+// Nodes are recognized by `TrieNode::id_`, so any snapshot may be checkpointed, in any order; a delta simply writes
+// whatever the chain is missing. The checkpointer remembers the id of every node the chain holds, so a delta never
+// walks the unchanged part of a snapshot. Once those ids outnumber twice the nodes of the last snapshot walked, a
+// delta walks its whole snapshot and forgets the nodes it no longer reaches: the walk is paid for by the deltas
+// since the previous one, and the memory stays proportional to the size of the trie. Writing a new base resets it.
+//
+// File format: a header, then the new nodes in post-order (children first), numbered consecutively along the whole
+// chain starting from 1. A node refers to its children by number. Values are encoded as in trie_snapshot.h, so
+// only uint32_t, uint64_t and std::string values can be checkpointed.
+class TrieCheckpointer {
+ public:
+  TrieCheckpointer() = default;
+
+  // Start a new chain: write every node of `trie` to `path`. Returns the number of nodes written.
+  auto WriteBase(const Trie &trie, const std::string &path) -> size_t;
+
+  // Write the nodes of `trie` that the chain does not hold yet, and its root, to `path`. Returns the number of
+  // nodes written. Throws std::logic_error if no base was written or loaded.
+  auto WriteDelta(const Trie &trie, const std::string &path) -> size_t;
+
+  // Rebuild the trie saved by the last file of a chain: a base file followed by its deltas, in the order they were
+  // written. The returned checkpointer continues the chain, so the next delta can be written after the last file.
+  // Throws std::runtime_error if a file cannot be read, is corrupt, or does not continue the chain.
+  static auto Load(const std::vector<std::string> &paths) -> std::pair<Trie, TrieCheckpointer>;
+
+  // Number of nodes the chain holds that this checkpointer knows of.
+  auto PersistedNodeCount() const -> size_t { return persisted_.size(); }
+
+ private:
+  struct Header;
+
+  auto Write(const Trie &trie, const std::string &path, bool base) -> size_t;
+
+  // Forget every persisted node that `trie`, just written, does not reach. A later delta writes such a node again
+  // if a snapshot still holds it.
+  void Prune(const Trie &trie);
+
+  bool started_{false};
+
+  // `TrieNode::id_` of every node written to the chain, mapped to its number in the chain.
+  std::unordered_map<uint64_t, uint64_t> persisted_;
+
+  // Size of `persisted_` when it last held only the nodes of one snapshot.
+  size_t reached_{0};
+
+  // Number of the next node written to the chain.
+  uint64_t next_number_{1};
+};
+
+}  // namespace bustub
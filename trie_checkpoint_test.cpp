@@ -0,0 +1,199 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_checkpoint_test.cpp
+//
+// Identification: test/primer/trie_checkpoint_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "trie_checkpoint.h"
+
+namespace bustub {
+
+namespace {
+
+auto CheckpointPath(const std::string &name) -> std::string {
+  return (std::filesystem::temp_directory_path() / ("trie_checkpoint_test_" + name)).string();
+}
+
+}  // namespace
+
+TEST(TrieCheckpointTest, DeltaTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      trie = trie.Put<uint32_t>("key/" + std::to_string(i), i, i % 17);
+    }
+    std::vector<std::string> paths = {CheckpointPath("base"), CheckpointPath("delta1"), CheckpointPath("delta2")};
+
+    TrieCheckpointer checkpointer;
+    size_t base_nodes = checkpointer.WriteBase(trie, paths[0]);
+    ASSERT_EQ(checkpointer.PersistedNodeCount(), base_nodes);
+
+    // A single Put only adds the nodes on its path.
+    trie = trie.Put<std::string>("key/17", "seventeen");
+    size_t delta_nodes = checkpointer.WriteDelta(trie, paths[1]);
+    ASSERT_TRUE(delta_nodes > 0);
+    ASSERT_TRUE(delta_nodes <= 7);
+
+    trie = trie.Remove("key/5").Put<uint64_t>("other", 233);
+    checkpointer.WriteDelta(trie, paths[2]);
+
+    auto [loaded, resumed] = TrieCheckpointer::Load(paths);
+    ASSERT_TRUE(loaded.GetLayout() == layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      auto key = "key/" + std::to_string(i);
+      if (i == 5) {
+        ASSERT_EQ(loaded.Get<uint32_t>(key), nullptr);
+      } else if (i == 17) {
+        ASSERT_EQ(*loaded.Get<std::string>(key), "seventeen");
+      } else {
+        ASSERT_EQ(*loaded.Get<uint32_t>(key), i);
+      }
+    }
+    ASSERT_EQ(*loaded.Get<uint64_t>("other"), 233);
+    ASSERT_TRUE(loaded.TopK("key/", 5) == trie.TopK("key/", 5));
+
+    // The loaded checkpointer continues the chain: a delta of the loaded trie writes only the changed path.
+    auto next = loaded.Put<uint32_t>("key/999", 0);
+    paths.push_back(CheckpointPath("delta3"));
+    ASSERT_TRUE(resumed.WriteDelta(next, paths[3]) <= 8);
+    auto reloaded = TrieCheckpointer::Load(paths).first;
+    ASSERT_EQ(*reloaded.Get<uint32_t>("key/999"), 0);
+    ASSERT_EQ(*reloaded.Get<uint32_t>("key/998"), 998);
+
+    // Nothing changed: the delta only records the root.
+    ASSERT_EQ(resumed.WriteDelta(next, paths[3]), 0);
+
+    for (const auto &path : paths) {
+      std::filesystem::remove(path);
+    }
+  }
+}
+
+TEST(TrieCheckpointTest, ChainTest) {
+  auto base = CheckpointPath("chain_base");
+  auto delta = CheckpointPath("chain_delta");
+
+  bool thrown = false;
+  try {
+    TrieCheckpointer().WriteDelta(Trie(), delta);
+  } catch (const std::logic_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+
+  TrieCheckpointer checkpointer;
+  checkpointer.WriteBase(Trie(), base);
+  checkpointer.WriteDelta(Trie().Put<uint32_t>("a", 1), delta);
+  ASSERT_EQ(*TrieCheckpointer::Load({base, delta}).first.Get<uint32_t>("a"), 1);
+  ASSERT_EQ(TrieCheckpointer::Load({base}).first.GetRoot(), nullptr);
+
+  // A delta cannot be loaded without its base, and a truncated file is rejected.
+  thrown = false;
+  try {
+    TrieCheckpointer::Load({delta});
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+
+  std::filesystem::resize_file(delta, std::filesystem::file_size(delta) - 1);
+  thrown = false;
+  try {
+    TrieCheckpointer::Load({base, delta});
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+
+  // So is a file of an unknown layout: the byte after the magic and the version
+  {
+    std::fstream file(base, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(12);
+    file.put('\x7f');
+  }
+  thrown = false;
+  try {
+    TrieCheckpointer::Load({base});
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+
+  std::filesystem::remove(base);
+  std::filesystem::remove(delta);
+}
+
+TEST(TrieCheckpointTest, DeepKeyTest) {
+  auto base = CheckpointPath("deep_base");
+  auto delta = CheckpointPath("deep_delta");
+  std::string key(20000, 'a');
+  TrieCheckpointer checkpointer;
+  checkpointer.WriteBase(Trie().Put<uint32_t>(key, 1), base);
+  checkpointer.WriteDelta(Trie().Put<uint32_t>(key, 1).Put<uint32_t>(key + "b", 2), delta);
+  auto loaded = TrieCheckpointer::Load({base, delta}).first;
+  ASSERT_EQ(*loaded.Get<uint32_t>(key), 1);
+  ASSERT_EQ(*loaded.Get<uint32_t>(key + "b"), 2);
+  std::filesystem::remove(base);
+  std::filesystem::remove(delta);
+}
+
+TEST(TrieCheckpointTest, PruneTest) {
+  auto base = CheckpointPath("prune_base");
+  auto delta = CheckpointPath("prune_delta");
+
+  // A value type that cannot be checkpointed fails the write without leaving a file behind.
+  TrieCheckpointer checkpointer;
+  bool thrown = false;
+  try {
+    checkpointer.WriteBase(Trie().Put<std::unique_ptr<uint32_t>>("a", std::make_unique<uint32_t>(1)), base);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+  ASSERT_TRUE(!std::filesystem::exists(base));
+  ASSERT_TRUE(!std::filesystem::exists(base + ".tmp"));
+
+  // Rewriting the same keys over and over keeps the remembered nodes within a bound of the trie's size, and the
+  // chain still loads.
+  auto trie = Trie();
+  for (uint32_t i = 0; i < 100; i++) {
+    trie = trie.Put<uint32_t>("key/" + std::to_string(i), i);
+  }
+  size_t base_nodes = checkpointer.WriteBase(trie, base);
+  std::vector<std::string> paths = {base};
+  for (uint32_t round = 0; round < 200; round++) {
+    trie = trie.Put<uint32_t>("key/" + std::to_string(round % 100), round);
+    paths.push_back(delta + std::to_string(round));
+    checkpointer.WriteDelta(trie, paths.back());
+    ASSERT_TRUE(checkpointer.PersistedNodeCount() <= 2 * base_nodes + 8);
+  }
+  auto [loaded, resumed] = TrieCheckpointer::Load(paths);
+  for (uint32_t i = 0; i < 100; i++) {
+    ASSERT_EQ(*loaded.Get<uint32_t>("key/" + std::to_string(i)), 100 + i);
+  }
+
+  // A node forgotten by a prune is written again if a later snapshot holds it.
+  paths.push_back(delta + "_old");
+  checkpointer.WriteDelta(Trie().Put<uint32_t>("key/0", 0), paths.back());
+  ASSERT_EQ(*TrieCheckpointer::Load(paths).first.Get<uint32_t>("key/0"), 0);
+
+  for (const auto &path : paths) {
+    std::filesystem::remove(path);
+  }
+}
+
+}  // namespace bustub
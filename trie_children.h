@@ -0,0 +1,523 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_children.h
+//
+// Identification: src/include/primer/trie_children.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// BUSTUB_TRIE_SIMD (the TRIE_SIMD_LOOKUP CMake option) compares a search byte against 16 keys at once, with SSE2 or
+// NEON, whichever the target has. Without either, lookups fall back to the scalar loop.
+#if defined(BUSTUB_TRIE_SIMD) && defined(__SSE2__)
+#include <emmintrin.h>
+#define BUSTUB_TRIE_SIMD_SSE2
+#elif defined(BUSTUB_TRIE_SIMD) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define BUSTUB_TRIE_SIMD_NEON
+#endif
+
+namespace bustub {
+
+// Number of keys `FindKeySlot16` compares at once.
+inline constexpr uint16_t kKeyBlockWidth = 16;
+
+// Find the slot of `c` in the sorted key array `keys[0, size)`, scanning one key at a time.
+inline auto FindKeySlotScalar(const char *keys, uint16_t from, uint16_t size, char c) -> int {
+  const auto target = static_cast<unsigned char>(c);
+  for (uint16_t i = from; i < size; i++) {
+    const auto key = static_cast<unsigned char>(keys[i]);
+    if (key == target) {
+      return i;
+    }
+    if (key > target) {
+      break;
+    }
+  }
+  return -1;
+}
+
+// Find the slot of `c` among the first `size` (at most 16) keys at `keys`, or -1 if it is absent. All 16 bytes at
+// `keys` must be readable, even past `size`: the bytes past it are loaded but never match.
+inline auto FindKeySlot16(const char *keys, uint16_t size, char c) -> int {
+#if defined(BUSTUB_TRIE_SIMD_SSE2)
+  __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(keys));
+  auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8(c))));
+  mask &= (uint32_t{1} << size) - 1;
+  return mask == 0 ? -1 : std::countr_zero(mask);
+#elif defined(BUSTUB_TRIE_SIMD_NEON)
+  // NEON has no movemask: narrowing the 16 byte results to 4 bits each gives a 64-bit mask instead
+  uint8x16_t equal = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t *>(keys)), vdupq_n_u8(static_cast<uint8_t>(c)));
+  uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(equal), 4)), 0);
+  if (size < kKeyBlockWidth) {
+    mask &= (uint64_t{1} << (4 * size)) - 1;
+  }
+  return mask == 0 ? -1 : std::countr_zero(mask) / 4;
+#else
+  return FindKeySlotScalar(keys, 0, size, c);
+#endif
+}
+
+// Find the slot of `c` in the sorted key array `keys[0, size)`, or -1 if it is absent. Keys are ordered as unsigned
+// bytes, which is the order `std::string` comparison uses. Only `keys[0, size)` is read.
+inline auto FindKeySlot(const char *keys, uint16_t size, char c) -> int {
+#if defined(BUSTUB_TRIE_SIMD_SSE2) || defined(BUSTUB_TRIE_SIMD_NEON)
+  // Skip whole blocks of smaller keys; the key, if present, is in the first block that ends with one not smaller
+  const auto target = static_cast<unsigned char>(c);
+  uint16_t from = 0;
+  for (; from + kKeyBlockWidth <= size; from += kKeyBlockWidth) {
+    if (static_cast<unsigned char>(keys[from + kKeyBlockWidth - 1]) >= target) {
+      int slot = FindKeySlot16(keys + from, kKeyBlockWidth, c);
+      return slot < 0 ? -1 : from + slot;
+    }
+  }
+  return FindKeySlotScalar(keys, from, size, c);
+#else
+  return FindKeySlotScalar(keys, 0, size, c);
+#endif
+}
+
+// A ChildArray is a compact, ordered map from the next key byte to a child node. It replaces the
+// `std::map<char, std::shared_ptr<...>>` a trie node used to hold, and keeps the subset of the `std::map` interface
+// (`size`, `empty`, `at`, `find`, `begin`/`end`, `insert_or_assign`, `erase`) the trie code and its tests rely on.
+//
+// The layout adapts to the fan-out of the node, in the spirit of ART's Node4/16/48/256:
+//  - a single child is stored inline in the container, so a chain of one-child nodes costs no extra allocation;
+//  - up to `kIndexThreshold` children live in one heap block holding a sorted key array followed by the child
+//    pointers, which is searched with one 16-byte SIMD compare (or linearly without SIMD);
+//  - larger nodes additionally carry a 256-entry byte index in front of the keys, so lookup is a single load.
+//
+// Children are always kept sorted by unsigned byte value, so iteration visits them in lexicographic order.
+// Copying a ChildArray copies the child pointers (sharing the child nodes) into an exactly-sized block, which is what
+// copy-on-write needs; `insert_or_assign` grows geometrically so incremental construction stays amortized O(1).
+//
+// `NodePtr` is the owning pointer to a child. Immutable trie nodes share children through `std::shared_ptr`; a
+// builder that owns its nodes uniquely can use `std::unique_ptr`, in which case the container is move-only.
+template <class Node, class NodePtr = std::shared_ptr<Node>>
+class ChildArray {
+ public:
+  using Ptr = NodePtr;
+  using value_type = std::pair<char, const Ptr &>;
+
+  // Nodes with more children than this get a 256-entry byte index in front of their key array.
+  static constexpr uint16_t kIndexThreshold = 16;
+
+  class const_iterator {
+   public:
+    // `operator->` has to return something that behaves like a pointer to a pair.
+    struct Arrow {
+      value_type pair_;
+      auto operator->() const -> const value_type * { return &pair_; }
+    };
+
+    const_iterator(const ChildArray *owner, uint16_t slot) : owner_(owner), slot_(slot) {}
+
+    auto operator*() const -> value_type { return {owner_->KeyData()[slot_], owner_->NodeData()[slot_]}; }
+    auto operator->() const -> Arrow { return Arrow{**this}; }
+    auto operator++() -> const_iterator & {
+      slot_++;
+      return *this;
+    }
+    auto operator==(const const_iterator &that) const -> bool { return slot_ == that.slot_ && owner_ == that.owner_; }
+    auto operator!=(const const_iterator &that) const -> bool { return !(*this == that); }
+
+   private:
+    const ChildArray *owner_;
+    uint16_t slot_;
+  };
+
+  ChildArray() = default;
+
+  ChildArray(const ChildArray &that) { CopyFrom(that); }
+
+  ChildArray(ChildArray &&that) noexcept { MoveFrom(std::move(that)); }
+
+  auto operator=(const ChildArray &that) -> ChildArray & {
+    if (this != &that) {
+      ChildArray copy(that);
+      *this = std::move(copy);
+    }
+    return *this;
+  }
+
+  auto operator=(ChildArray &&that) noexcept -> ChildArray & {
+    if (this != &that) {
+      Release();
+      MoveFrom(std::move(that));
+    }
+    return *this;
+  }
+
+  ~ChildArray() { Release(); }
+
+  auto size() const -> size_t { return size_; }     // NOLINT
+  auto empty() const -> bool { return size_ == 0; }  // NOLINT
+
+  auto begin() const -> const_iterator { return {this, 0}; }     // NOLINT
+  auto end() const -> const_iterator { return {this, size_}; }  // NOLINT
+
+  auto find(char c) const -> const_iterator {  // NOLINT
+    int slot = FindSlot(c);
+    return slot < 0 ? end() : const_iterator(this, static_cast<uint16_t>(slot));
+  }
+
+  // Return the first child whose key is not less than `c`, in unsigned byte order.
+  auto lower_bound(char c) const -> const_iterator {  // NOLINT
+    const auto target = static_cast<unsigned char>(c);
+    const char *keys = KeyData();
+    uint16_t slot = 0;
+    while (slot < size_ && static_cast<unsigned char>(keys[slot]) < target) {
+      slot++;
+    }
+    return {this, slot};
+  }
+
+  auto count(char c) const -> size_t { return FindSlot(c) < 0 ? 0 : 1; }  // NOLINT
+
+  auto at(char c) const -> const Ptr & {  // NOLINT
+    const Ptr *child = Lookup(c);
+    if (child == nullptr) {
+      throw std::out_of_range("ChildArray::at");
+    }
+    return *child;
+  }
+
+  // Return the child slot for `c`, or nullptr if there is no such child. This is the hot path of a trie lookup.
+  auto Lookup(char c) const -> const Ptr * {
+    int slot = FindSlot(c);
+    return slot < 0 ? nullptr : &NodeData()[slot];
+  }
+  auto Lookup(char c) -> Ptr * {
+    int slot = FindSlot(c);
+    return slot < 0 ? nullptr : &NodeData()[slot];
+  }
+
+  // Bytes of the heap block holding the children, 0 when the only child is stored inline.
+  auto HeapBytes() const -> size_t { return heap_ == nullptr ? 0 : BlockSize(capacity_); }
+
+  // Make room for `capacity` children, so that inserting them in key order does not reallocate.
+  void reserve(size_t capacity) {  // NOLINT
+    if (capacity > 1 && capacity > capacity_) {
+      Grow(static_cast<uint16_t>(std::min<size_t>(capacity, 256)));
+    }
+  }
+
+  // Insert a child for `c`, or replace the existing one.
+  void insert_or_assign(char c, Ptr child) {  // NOLINT
+    int slot = FindSlot(c);
+    if (slot >= 0) {
+      NodeData()[slot] = std::move(child);
+      return;
+    }
+
+    if (heap_ == nullptr && size_ == 0) {
+      inline_key_ = c;
+      inline_child_ = std::move(child);
+      size_ = 1;
+      return;
+    }
+
+    if (heap_ == nullptr || size_ == capacity_) {
+      Grow(static_cast<uint16_t>(std::min<size_t>(std::max<size_t>(4, size_ * 2), 256)));
+    }
+
+    char *keys = KeyData();
+    Ptr *nodes = NodeData();
+    const auto target = static_cast<unsigned char>(c);
+    uint16_t pos = size_;
+    while (pos > 0 && static_cast<unsigned char>(keys[pos - 1]) > target) {
+      pos--;
+    }
+    new (&nodes[size_]) Ptr();
+    for (uint16_t i = size_; i > pos; i--) {
+      keys[i] = keys[i - 1];
+      nodes[i] = std::move(nodes[i - 1]);
+    }
+    keys[pos] = c;
+    nodes[pos] = std::move(child);
+    size_++;
+    UpdateIndex(pos);
+  }
+
+  // Return a copy of `that` whose child for `c` is `child`, inserted or replacing the existing one. This is the copy a
+  // copy-on-write step makes: unlike a copy followed by `insert_or_assign`, it is built in a single exactly-sized
+  // block, and the child it replaces is never copied.
+  static auto CopyWith(const ChildArray &that, char c, Ptr child) -> ChildArray {
+    int slot = that.FindSlot(c);
+    ChildArray copy;
+    copy.AllocateExact(slot >= 0 ? that.size_ : that.size_ + 1);
+    const char *keys = that.KeyData();
+    const Ptr *nodes = that.NodeData();
+    const auto target = static_cast<unsigned char>(c);
+    uint16_t i = 0;
+    for (; i < that.size_ && static_cast<unsigned char>(keys[i]) < target; i++) {
+      copy.Append(keys[i], nodes[i]);
+    }
+    copy.Append(c, std::move(child));
+    for (i += slot >= 0 ? 1 : 0; i < that.size_; i++) {
+      copy.Append(keys[i], nodes[i]);
+    }
+    copy.RebuildIndex();
+    return copy;
+  }
+
+  // Return a copy of `that` without the child for `c`, built like `CopyWith`.
+  static auto CopyWithout(const ChildArray &that, char c) -> ChildArray {
+    int slot = that.FindSlot(c);
+    if (slot < 0) {
+      return that;
+    }
+    ChildArray copy;
+    copy.AllocateExact(that.size_ - 1);
+    const char *keys = that.KeyData();
+    const Ptr *nodes = that.NodeData();
+    for (uint16_t i = 0; i < that.size_; i++) {
+      if (i != slot) {
+        copy.Append(keys[i], nodes[i]);
+      }
+    }
+    copy.RebuildIndex();
+    return copy;
+  }
+
+  // Call `fn` on the pointer to every child. `fn` may move a pointer out, leaving an empty slot behind. That is only
+  // meant for tearing the array down, see `ReleaseChildren`.
+  template <class Fn>
+  void ForEachSlot(Fn &&fn) {
+    Ptr *nodes = NodeData();
+    for (uint16_t i = 0; i < size_; i++) {
+      fn(nodes[i]);
+    }
+  }
+
+  // Remove the child for `c`. Return the number of removed children.
+  auto erase(char c) -> size_t {  // NOLINT
+    int slot = FindSlot(c);
+    if (slot < 0) {
+      return 0;
+    }
+    char *keys = KeyData();
+    Ptr *nodes = NodeData();
+    for (uint16_t i = static_cast<uint16_t>(slot); i + 1 < size_; i++) {
+      keys[i] = keys[i + 1];
+      nodes[i] = std::move(nodes[i + 1]);
+    }
+    size_--;
+    if (heap_ == nullptr) {
+      inline_child_.reset();
+    } else {
+      nodes[size_].~Ptr();
+      UpdateIndex(static_cast<uint16_t>(slot));
+    }
+    return 1;
+  }
+
+ private:
+  static constexpr auto HasIndex(uint16_t capacity) -> bool { return capacity > kIndexThreshold; }
+
+  // Byte offset of the key array inside a heap block.
+  static constexpr auto KeyOffset(uint16_t capacity) -> size_t { return HasIndex(capacity) ? 256 : 0; }
+
+  // Byte offset of the child pointer array inside a heap block.
+  static constexpr auto NodeOffset(uint16_t capacity) -> size_t {
+    size_t end_of_keys = KeyOffset(capacity) + capacity;
+    return (end_of_keys + alignof(Ptr) - 1) / alignof(Ptr) * alignof(Ptr);
+  }
+
+  static constexpr auto BlockSize(uint16_t capacity) -> size_t { return NodeOffset(capacity) + capacity * sizeof(Ptr); }
+
+  auto KeyData() const -> const char * {
+    return heap_ == nullptr ? &inline_key_ : reinterpret_cast<const char *>(heap_ + KeyOffset(capacity_));
+  }
+  auto KeyData() -> char * {
+    return heap_ == nullptr ? &inline_key_ : reinterpret_cast<char *>(heap_ + KeyOffset(capacity_));
+  }
+  auto NodeData() const -> const Ptr * {
+    return heap_ == nullptr ? &inline_child_ : std::launder(reinterpret_cast<const Ptr *>(heap_ + NodeOffset(capacity_)));
+  }
+  auto NodeData() -> Ptr * {
+    return heap_ == nullptr ? &inline_child_ : std::launder(reinterpret_cast<Ptr *>(heap_ + NodeOffset(capacity_)));
+  }
+  auto IndexData() const -> const uint8_t * { return reinterpret_cast<const uint8_t *>(heap_); }
+
+  auto FindSlot(char c) const -> int {
+    if (heap_ == nullptr) {
+      return size_ == 1 && inline_key_ == c ? 0 : -1;
+    }
+    if (HasIndex(capacity_)) {
+      uint8_t slot = IndexData()[static_cast<unsigned char>(c)];
+      return slot < size_ && KeyData()[slot] == c ? slot : -1;
+    }
+    // A block without index has room for at least two children, so the 16 bytes FindKeySlot16 loads stay inside it
+    static_assert(BlockSize(2) >= kKeyBlockWidth);
+    return FindKeySlot16(KeyData(), size_, c);
+  }
+
+  // Point the index at the keys in slots [from, size_). Entries of absent keys may be stale: FindSlot verifies the
+  // key in the slot, so they never match.
+  void UpdateIndex(uint16_t from) {
+    if (heap_ == nullptr || !HasIndex(capacity_)) {
+      return;
+    }
+    auto *index = reinterpret_cast<uint8_t *>(heap_);
+    const char *keys = KeyData();
+    for (uint16_t i = from; i < size_; i++) {
+      index[static_cast<unsigned char>(keys[i])] = static_cast<uint8_t>(i);
+    }
+  }
+
+  void RebuildIndex() {
+    if (heap_ != nullptr && HasIndex(capacity_)) {
+      std::memset(heap_, 0, 256);
+      UpdateIndex(0);
+    }
+  }
+
+  // Move the children into a fresh heap block that can hold `capacity` children.
+  void Grow(uint16_t capacity) {
+    auto *block = static_cast<std::byte *>(::operator new(BlockSize(capacity)));
+    auto *keys = reinterpret_cast<char *>(block + KeyOffset(capacity));
+    auto *nodes = reinterpret_cast<Ptr *>(block + NodeOffset(capacity));
+
+    char *old_keys = KeyData();
+    Ptr *old_nodes = NodeData();
+    for (uint16_t i = 0; i < size_; i++) {
+      keys[i] = old_keys[i];
+      new (&nodes[i]) Ptr(std::move(old_nodes[i]));
+    }
+
+    uint16_t size = size_;
+    Release();
+    heap_ = block;
+    capacity_ = capacity;
+    size_ = size;
+    RebuildIndex();
+  }
+
+  // Give an empty array a heap block for exactly `size` children, if it needs one, to be filled with `Append`.
+  void AllocateExact(uint16_t size) {
+    if (size > 1) {
+      heap_ = static_cast<std::byte *>(::operator new(BlockSize(size)));
+      capacity_ = size;
+    }
+  }
+
+  // Add a child after the last one, which must have a smaller key, in the room `AllocateExact` made. The index is
+  // not updated.
+  void Append(char c, Ptr child) {
+    if (heap_ == nullptr) {
+      inline_key_ = c;
+      inline_child_ = std::move(child);
+    } else {
+      KeyData()[size_] = c;
+      new (&NodeData()[size_]) Ptr(std::move(child));
+    }
+    size_++;
+  }
+
+  void CopyFrom(const ChildArray &that) {
+    if (that.size_ <= 1) {
+      size_ = that.size_;
+      if (size_ == 1) {
+        inline_key_ = that.KeyData()[0];
+        inline_child_ = that.NodeData()[0];
+      }
+      return;
+    }
+
+    heap_ = static_cast<std::byte *>(::operator new(BlockSize(that.size_)));
+    capacity_ = that.size_;
+    size_ = that.size_;
+    std::memcpy(KeyData(), that.KeyData(), size_);
+    auto *nodes = reinterpret_cast<Ptr *>(heap_ + NodeOffset(capacity_));
+    const Ptr *that_nodes = that.NodeData();
+    for (uint16_t i = 0; i < size_; i++) {
+      new (&nodes[i]) Ptr(that_nodes[i]);
+    }
+    RebuildIndex();
+  }
+
+  void MoveFrom(ChildArray &&that) noexcept {
+    heap_ = std::exchange(that.heap_, nullptr);
+    size_ = std::exchange(that.size_, 0);
+    capacity_ = std::exchange(that.capacity_, 0);
+    inline_key_ = that.inline_key_;
+    inline_child_ = std::move(that.inline_child_);
+  }
+
+  void Release() {
+    if (heap_ != nullptr) {
+      Ptr *nodes = NodeData();
+      for (uint16_t i = 0; i < size_; i++) {
+        nodes[i].~Ptr();
+      }
+      ::operator delete(heap_);
+      heap_ = nullptr;
+    }
+    inline_child_.reset();
+    size_ = 0;
+    capacity_ = 0;
+  }
+
+  // Heap block holding [index][keys][children] once the node has more than one child, nullptr otherwise.
+  std::byte *heap_{nullptr};
+  uint16_t size_{0};
+  uint16_t capacity_{0};
+  // The only child of a node with fan-out 1 lives here, without any heap block.
+  char inline_key_{0};
+  Ptr inline_child_;
+};
+
+// Whether dropping `child` destroys the node it points to.
+template <class Node>
+auto IsSoleOwner(const std::shared_ptr<Node> &child) -> bool {
+  return child.use_count() == 1;
+}
+template <class Node>
+auto IsSoleOwner(const std::unique_ptr<Node> & /*child*/) -> bool {
+  return true;
+}
+
+// Drop the children of a node that is being destroyed. Releasing a child that nothing else owns destroys it, which
+// releases its own children, one stack frame per level: a trie as deep as a 20000-byte key would overflow the stack.
+// The children nothing else owns are moved onto a local stack instead, and destroyed one at a time once childless.
+template <class Node, class NodePtr>
+void ReleaseChildren(ChildArray<Node, NodePtr> &children) noexcept {
+  std::vector<NodePtr> doomed;
+  auto take = [&](ChildArray<Node, NodePtr> &from) {
+    from.ForEachSlot([&](NodePtr &child) {
+      if (child != nullptr && IsSoleOwner(child)) {
+        try {
+          doomed.push_back(std::move(child));
+        } catch (...) {
+          // Out of memory: leave the child in place, to be released the recursive way
+        }
+      }
+    });
+  };
+  take(children);
+  while (!doomed.empty()) {
+    NodePtr node = std::move(doomed.back());
+    doomed.pop_back();
+    // Nothing else owns the node, so it is not shared with any reader, even if it is immutable once built
+    take(const_cast<ChildArray<Node, NodePtr> &>(node->children_));
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,163 @@
+#include "trie_diff.h"
+
+#include <string_view>
+
+namespace bustub {
+
+// Walks two tries side by side and appends their differences, in key order, to a change list. `key_` is the key of
+// the position being compared, whatever part of the current segments it already covers.
+class DiffWalker {
+ public:
+  explicit DiffWalker(std::vector<TrieChange> &changes) : changes_(changes) {}
+
+  // Compare the subtree of `old_node` with the one of `new_node`, where `old_rest` and `new_rest` are the bytes of
+  // their segments that the current key does not cover yet. Both nodes are reached by the current key, so in a
+  // per-character trie, or wherever the two layouts agree, both rests are empty.
+  void Compare(const TrieNode *old_node, std::string_view old_rest, const TrieNode *new_node,
+               std::string_view new_rest) {
+    size_t base = key_.size();
+    size_t common = 0;
+    while (common < old_rest.size() && common < new_rest.size() && old_rest[common] == new_rest[common]) {
+      common++;
+    }
+    key_.append(old_rest.substr(0, common));
+    old_rest.remove_prefix(common);
+    new_rest.remove_prefix(common);
+
+    if (old_rest.empty() && new_rest.empty()) {
+      CompareNodes(old_node, new_node);
+    } else if (old_rest.empty()) {
+      CompareEnded(old_node, new_node, new_rest, true);
+    } else if (new_rest.empty()) {
+      CompareEnded(new_node, old_node, old_rest, false);
+    } else if (static_cast<unsigned char>(old_rest[0]) < static_cast<unsigned char>(new_rest[0])) {
+      // The keys diverge inside both segments, so the two subtrees hold no key in common
+      Report(old_node, old_rest, ChangeKind::kRemoved);
+      Report(new_node, new_rest, ChangeKind::kAdded);
+    } else {
+      Report(new_node, new_rest, ChangeKind::kAdded);
+      Report(old_node, old_rest, ChangeKind::kRemoved);
+    }
+    key_.resize(base);
+  }
+
+  // Report every value in the subtree of `node`, whose key is the current key followed by `rest`, as `kind`.
+  void Report(const TrieNode *node, std::string_view rest, ChangeKind kind) {
+    size_t base = key_.size();
+    key_.append(rest);
+    if (node->is_value_node_) {
+      Emit(kind, kind == ChangeKind::kRemoved ? node : nullptr, kind == ChangeKind::kAdded ? node : nullptr);
+    }
+    for (const auto &[ch, child] : node->children_) {
+      key_.push_back(ch);
+      Report(child.get(), child->segment_, kind);
+      key_.pop_back();
+    }
+    key_.resize(base);
+  }
+
+ private:
+  // Compare two nodes of the same key.
+  void CompareNodes(const TrieNode *old_node, const TrieNode *new_node) {
+    if (old_node == new_node) {
+      return;
+    }
+    if (old_node->is_value_node_ && new_node->is_value_node_) {
+      if (!old_node->SameValue(*new_node) || old_node->Score() != new_node->Score()) {
+        Emit(ChangeKind::kUpdated, old_node, new_node);
+      }
+    } else if (old_node->is_value_node_) {
+      Emit(ChangeKind::kRemoved, old_node, nullptr);
+    } else if (new_node->is_value_node_) {
+      Emit(ChangeKind::kAdded, nullptr, new_node);
+    }
+
+    // Merge the two sorted child arrays
+    auto old_it = old_node->children_.begin();
+    auto new_it = new_node->children_.begin();
+    while (old_it != old_node->children_.end() || new_it != new_node->children_.end()) {
+      if (new_it == new_node->children_.end() ||
+          (old_it != old_node->children_.end() &&
+           static_cast<unsigned char>((*old_it).first) < static_cast<unsigned char>((*new_it).first))) {
+        const auto &[ch, child] = *old_it;
+        key_.push_back(ch);
+        Report(child.get(), child->segment_, ChangeKind::kRemoved);
+        key_.pop_back();
+        ++old_it;
+      } else if (old_it == old_node->children_.end() || (*new_it).first != (*old_it).first) {
+        const auto &[ch, child] = *new_it;
+        key_.push_back(ch);
+        Report(child.get(), child->segment_, ChangeKind::kAdded);
+        key_.pop_back();
+        ++new_it;
+      } else {
+        const auto &[ch, old_child] = *old_it;
+        const auto &new_child = (*new_it).second;
+        key_.push_back(ch);
+        Compare(old_child.get(), old_child->segment_, new_child.get(), new_child->segment_);
+        key_.pop_back();
+        ++old_it;
+        ++new_it;
+      }
+    }
+  }
+
+  // Compare `ended`, whose key is the current key, with `other`, a node further down whose segment still has `rest`
+  // to go: a segment that was split or merged between the two tries. `ended_is_old` tells which trie `ended` is from.
+  void CompareEnded(const TrieNode *ended, const TrieNode *other, std::string_view rest, bool ended_is_old) {
+    ChangeKind ended_kind = ended_is_old ? ChangeKind::kRemoved : ChangeKind::kAdded;
+    ChangeKind other_kind = ended_is_old ? ChangeKind::kAdded : ChangeKind::kRemoved;
+    // `other` has no value at the current key, which is a proper prefix of its own
+    if (ended->is_value_node_) {
+      Emit(ended_kind, ended_is_old ? ended : nullptr, ended_is_old ? nullptr : ended);
+    }
+    // `other` goes where the child for `rest[0]` would be, and is compared with it if there is one
+    const auto next = static_cast<unsigned char>(rest[0]);
+    bool placed = false;
+    for (const auto &[ch, child] : ended->children_) {
+      if (!placed && static_cast<unsigned char>(ch) > next) {
+        Report(other, rest, other_kind);
+        placed = true;
+      }
+      key_.push_back(ch);
+      if (static_cast<unsigned char>(ch) == next) {
+        if (ended_is_old) {
+          Compare(child.get(), child->segment_, other, rest.substr(1));
+        } else {
+          Compare(other, rest.substr(1), child.get(), child->segment_);
+        }
+        placed = true;
+      } else {
+        Report(child.get(), child->segment_, ended_kind);
+      }
+      key_.pop_back();
+    }
+    if (!placed) {
+      Report(other, rest, other_kind);
+    }
+  }
+
+  void Emit(ChangeKind kind, const TrieNode *old_node, const TrieNode *new_node) {
+    changes_.push_back({kind, key_, old_node, new_node});
+  }
+
+  std::string key_;
+  std::vector<TrieChange> &changes_;
+};
+
+auto Diff(Trie old_trie, Trie new_trie) -> TrieDiff {
+  TrieDiff diff(std::move(old_trie), std::move(new_trie));
+  const TrieNode *old_root = diff.old_.GetRoot().get();
+  const TrieNode *new_root = diff.new_.GetRoot().get();
+  DiffWalker walker(diff.changes_);
+  if (old_root != nullptr && new_root != nullptr) {
+    walker.Compare(old_root, "", new_root, "");
+  } else if (old_root != nullptr) {
+    walker.Report(old_root, "", ChangeKind::kRemoved);
+  } else if (new_root != nullptr) {
+    walker.Report(new_root, "", ChangeKind::kAdded);
+  }
+  return diff;
+}
+
+}  // namespace bustub
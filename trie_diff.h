@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_diff.h
+//
+// Identification: src/include/primer/trie_diff.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+enum class ChangeKind : uint8_t {
+  // The key has a value in the new trie only.
+  kAdded,
+  // The key has a value in the old trie only.
+  kRemoved,
+  // The key was written: its value, value type or score differs between the tries.
+  kUpdated,
+};
+
+// One key that differs between two tries, as listed by `Diff`.
+struct TrieChange {
+  ChangeKind kind_;
+  std::string key_;
+  // The value nodes of the key in the old and the new trie, nullptr where it has none. They live as long as the
+  // TrieDiff the change belongs to.
+  const TrieNode *old_node_{nullptr};
+  const TrieNode *new_node_{nullptr};
+
+  // The old value of the key, or nullptr if it had none of type T.
+  template <class T>
+  auto OldValue() const -> const T * {
+    return ValueOf<T>(old_node_);
+  }
+
+  // The new value of the key, or nullptr if it has none of type T.
+  template <class T>
+  auto NewValue() const -> const T * {
+    return ValueOf<T>(new_node_);
+  }
+
+ private:
+  template <class T>
+  static auto ValueOf(const TrieNode *node) -> const T * {
+    if (node == nullptr || node->value_type_ != GetValueTypeTag<T>()) {
+      return nullptr;
+    }
+    return static_cast<const TrieNodeWithValue<T> *>(node)->value_.get();
+  }
+};
+
+// The keys that differ between two tries, in key order, as computed by `Diff`. It holds both tries, so the nodes its
+// changes point to stay valid as long as it lives.
+class TrieDiff {
+ public:
+  auto begin() const { return changes_.begin(); }  // NOLINT
+  auto end() const { return changes_.end(); }      // NOLINT
+  auto operator[](size_t i) const -> const TrieChange & { return changes_[i]; }
+  auto Size() const -> size_t { return changes_.size(); }
+  auto Empty() const -> bool { return changes_.empty(); }
+
+  auto OldTrie() const -> const Trie & { return old_; }
+  auto NewTrie() const -> const Trie & { return new_; }
+
+ private:
+  friend auto Diff(Trie old_trie, Trie new_trie) -> TrieDiff;
+
+  TrieDiff(Trie old_trie, Trie new_trie) : old_(std::move(old_trie)), new_(std::move(new_trie)) {}
+
+  Trie old_;
+  Trie new_;
+  std::vector<TrieChange> changes_;
+};
+
+// List the keys added, removed and updated from `old_trie` to `new_trie`, values of every type included, in key
+// order. Both tries are walked side by side, and a subtree that is the same node in both is skipped without being
+// entered: between two versions of a copy-on-write trie, the cost is proportional to the nodes the writes in between
+// rebuilt and the keys they changed, not to the size of the tries. The tries may have different layouts, but tries
+// that share no nodes are compared in full.
+//
+// A key is updated when it was written in between, even with an equal value, unless its values are inlined (see
+// `kInlineNodeValue`) and compare equal. A key whose node was only rebuilt, because a write passed through it on the
+// way to another key, is not a change.
+auto Diff(Trie old_trie, Trie new_trie) -> TrieDiff;
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_diff_test.cpp
+//
+// Identification: test/primer/trie_diff_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+#include "trie_diff.h"
+#include "trie_iterator.h"
+
+namespace bustub {
+
+// The differences of two tries of uint32_t values, by a full scan of both, formatted as "+key", "-key" or "~key".
+static auto ScanDiff(const Trie &old_trie, const Trie &new_trie) -> std::vector<std::string> {
+  std::map<std::string, std::pair<const uint32_t *, const uint32_t *>> keys;
+  for (auto [key, value] : old_trie.Scan<uint32_t>("")) {
+    keys[std::string(key)].first = &value;
+  }
+  for (auto [key, value] : new_trie.Scan<uint32_t>("")) {
+    keys[std::string(key)].second = &value;
+  }
+  std::vector<std::string> changes;
+  for (const auto &[key, values] : keys) {
+    if (values.first == nullptr) {
+      changes.push_back("+" + key);
+    } else if (values.second == nullptr) {
+      changes.push_back("-" + key);
+    } else if (*values.first != *values.second) {
+      changes.push_back("~" + key);
+    }
+  }
+  return changes;
+}
+
+static auto Format(const TrieDiff &diff) -> std::vector<std::string> {
+  std::vector<std::string> changes;
+  for (const auto &change : diff) {
+    const char *kind = change.kind_ == ChangeKind::kAdded ? "+" : change.kind_ == ChangeKind::kRemoved ? "-" : "~";
+    changes.push_back(kind + change.key_);
+  }
+  return changes;
+}
+
+TEST(TrieDiffTest, BasicTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto old_trie = Trie(layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      old_trie = old_trie.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    ASSERT_TRUE(Diff(old_trie, old_trie).Empty());
+
+    auto new_trie = old_trie.Put<uint32_t>("key/5", 55).Put<uint32_t>("key/1000", 1000).Remove("key/42");
+    // Rewriting a key with an equal inlined value, or rebuilding the path to it, is not a change
+    new_trie = new_trie.Put<uint32_t>("key/7", 7);
+    auto diff = Diff(old_trie, new_trie);
+    ASSERT_TRUE(Format(diff) == std::vector<std::string>({"+key/1000", "-key/42", "~key/5"}));
+    ASSERT_EQ(*diff[1].OldValue<uint32_t>(), 42);
+    ASSERT_TRUE(diff[1].NewValue<uint32_t>() == nullptr);
+    ASSERT_EQ(*diff[2].OldValue<uint32_t>(), 5);
+    ASSERT_EQ(*diff[2].NewValue<uint32_t>(), 55);
+    ASSERT_TRUE(diff[2].NewValue<std::string>() == nullptr);
+
+    // The other way around
+    ASSERT_TRUE(Format(Diff(new_trie, old_trie)) == std::vector<std::string>({"-key/1000", "+key/42", "~key/5"}));
+
+    // From and to an empty trie
+    ASSERT_EQ(Diff(Trie(layout), old_trie).Size(), 1000);
+    ASSERT_EQ(Diff(old_trie, Trie(layout)).Size(), 1000);
+    ASSERT_TRUE(Diff(Trie(layout), Trie(layout)).Empty());
+  }
+}
+
+TEST(TrieDiffTest, ValueTest) {
+  auto trie = Trie().Put<std::string>("a", "x").Put<uint32_t>("b", 1);
+  // A new string value is a change even if equal, since it is not inlined
+  auto diff = Diff(trie, trie.Put<std::string>("a", "x"));
+  ASSERT_EQ(diff.Size(), 1);
+  ASSERT_TRUE(diff[0].kind_ == ChangeKind::kUpdated);
+  ASSERT_EQ(*diff[0].NewValue<std::string>(), "x");
+  // So are a new value type, and a new score
+  ASSERT_TRUE(Format(Diff(trie, trie.Put<uint64_t>("b", 1))) == std::vector<std::string>({"~b"}));
+  ASSERT_TRUE(Format(Diff(trie, trie.Put<uint32_t>("b", 1, 10))) == std::vector<std::string>({"~b"}));
+  // The diff keeps its tries, and so the values, alive
+  auto kept = Diff(trie, Trie());
+  trie = Trie();
+  ASSERT_EQ(*kept[0].OldValue<std::string>(), "x");
+  ASSERT_EQ(*kept[1].OldValue<uint32_t>(), 1);
+}
+
+TEST(TrieDiffTest, SegmentTest) {
+  // Splitting and merging segments moves keys to other nodes, which the diff must see through
+  auto base = Trie(TrieLayout::kPathCompressed).Put<uint32_t>("abcdef", 1).Put<uint32_t>("abcdxy", 2);
+  auto split = base.Put<uint32_t>("ab", 3).Put<uint32_t>("abz", 4);
+  ASSERT_TRUE(Format(Diff(base, split)) == std::vector<std::string>({"+ab", "+abz"}));
+  ASSERT_TRUE(Format(Diff(split, base)) == std::vector<std::string>({"-ab", "-abz"}));
+  auto merged = base.Remove("abcdxy");
+  ASSERT_TRUE(Format(Diff(base, merged)) == std::vector<std::string>({"-abcdxy"}));
+  ASSERT_TRUE(Format(Diff(split, merged)) == std::vector<std::string>({"-ab", "-abcdxy", "-abz"}));
+  ASSERT_TRUE(Format(Diff(merged, split)) == std::vector<std::string>({"+ab", "+abcdxy", "+abz"}));
+
+  // Tries of different layouts are compared by key
+  auto flat = Trie(TrieLayout::kPerCharacter).Put<uint32_t>("abcdef", 1).Put<uint32_t>("abcdxy", 2);
+  ASSERT_TRUE(Diff(flat, base).Empty());
+  ASSERT_TRUE(Format(Diff(flat, split)) == std::vector<std::string>({"+ab", "+abz"}));
+  ASSERT_TRUE(Format(Diff(merged, flat.Put<uint32_t>("abcdef", 0))) ==
+              std::vector<std::string>({"~abcdef", "+abcdxy"}));
+}
+
+TEST(TrieDiffTest, RandomTest) {
+  std::mt19937 rng(2333);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (int round = 0; round < 50; round++) {
+      auto old_trie = trie;
+      for (int i = 0; i < 40; i++) {
+        // Short keys over a small alphabet, so that writes often split and merge segments
+        std::string key(rng() % 6, 'a');
+        for (auto &c : key) {
+          c = static_cast<char>('a' + rng() % 3);
+        }
+        if (rng() % 3 == 0) {
+          trie = trie.Remove(key);
+        } else {
+          trie = trie.Put<uint32_t>(key, rng() % 4);
+        }
+      }
+      ASSERT_TRUE(Format(Diff(old_trie, trie)) == ScanDiff(old_trie, trie));
+      ASSERT_TRUE(Format(Diff(trie, old_trie)) == ScanDiff(trie, old_trie));
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,211 @@
+#include "trie_frozen.h"
+
+#include <bit>
+#include <limits>
+#include <stdexcept>
+
+namespace bustub {
+
+void BitVector::Finish() {
+  size_t blocks = (words_.size() + kBlockWords - 1) / kBlockWords;
+  ranks_.assign(blocks + 1, 0);
+  zero_samples_.clear();
+  size_t ones = 0;
+  size_t next_sample = 0;
+  for (size_t b = 0; b < blocks; b++) {
+    ranks_[b] = static_cast<uint32_t>(ones);
+    for (size_t w = b * kBlockWords; w < words_.size() && w < (b + 1) * kBlockWords; w++) {
+      ones += std::popcount(words_[w]);
+    }
+    // Bits past the end count as zeros here; they come after every real zero, so no select ever lands on them
+    size_t zeros_after = (b + 1) * kBlockBits - ones;
+    while (next_sample * kZerosPerSample < zeros_after) {
+      zero_samples_.push_back(static_cast<uint32_t>(b));
+      next_sample++;
+    }
+  }
+  ranks_[blocks] = static_cast<uint32_t>(ones);
+  words_.shrink_to_fit();
+}
+
+auto BitVector::Rank1(size_t i) const -> size_t {
+  size_t b = i / kBlockBits;
+  size_t rank = ranks_[b];
+  for (size_t w = b * kBlockWords; w < i / 64; w++) {
+    rank += std::popcount(words_[w]);
+  }
+  if (i % 64 != 0) {
+    rank += std::popcount(words_[i / 64] & ((uint64_t{1} << (i % 64)) - 1));
+  }
+  return rank;
+}
+
+auto BitVector::Select0(size_t k) const -> size_t {
+  // Start at the sampled block, which is at most kZerosPerSample zeros behind, and skip to the block holding the zero
+  size_t b = zero_samples_[k / kZerosPerSample];
+  while (b + 2 < ranks_.size() && ZerosBefore(b + 1) <= k) {
+    b++;
+  }
+  size_t rest = k - ZerosBefore(b);
+  for (size_t w = b * kBlockWords;; w++) {
+    uint64_t zeros = ~words_[w];
+    auto count = static_cast<size_t>(std::popcount(zeros));
+    if (rest < count) {
+      for (; rest > 0; rest--) {
+        zeros &= zeros - 1;
+      }
+      return w * 64 + std::countr_zero(zeros);
+    }
+    rest -= count;
+  }
+}
+
+auto BitVector::NextZero(size_t i) const -> size_t {
+  size_t w = i / 64;
+  uint64_t zeros = ~words_[w] & (~uint64_t{0} << (i % 64));
+  while (zeros == 0) {
+    zeros = ~words_[++w];
+  }
+  return w * 64 + std::countr_zero(zeros);
+}
+
+auto FrozenTrie::MemoryBytes() const -> size_t {
+  return sizeof(FrozenTrie) + louds_.HeapBytes() + labels_.capacity() + has_segment_.HeapBytes() +
+         segments_.capacity() + segment_offsets_.capacity() * sizeof(uint32_t) + has_value_.HeapBytes() +
+         value_types_.capacity() + value_offsets_.capacity() * sizeof(uint32_t) + values_.capacity();
+}
+
+auto FrozenTrie::FindNode(std::string_view key) const -> std::optional<size_t> {
+  if (louds_.Size() == 0) {
+    return std::nullopt;
+  }
+  size_t node = 0;
+  size_t pos = 0;
+  while (pos < key.size()) {
+    auto [begin, end] = Edges(node);
+    int slot = FindKeySlot(labels_.data() + begin, static_cast<uint16_t>(end - begin), key[pos]);
+    if (slot < 0) {
+      return std::nullopt;
+    }
+    node = begin + slot + 1;
+    pos++;
+
+    std::string_view segment = Segment(node);
+    if (!segment.empty()) {
+      if (key.compare(pos, segment.size(), segment) != 0) {
+        return std::nullopt;
+      }
+      pos += segment.size();
+    }
+  }
+  return node;
+}
+
+auto FrozenTrie::ScanCursor(uint8_t value_type, std::string_view prefix) const -> FrozenTrieCursor {
+  FrozenTrieCursor cursor(this, value_type);
+  if (louds_.Size() == 0) {
+    return cursor;
+  }
+
+  // Walk down to the node whose subtree holds exactly the keys starting with `prefix`
+  size_t node = 0;
+  size_t pos = 0;
+  while (pos < prefix.size()) {
+    auto [begin, end] = Edges(node);
+    int slot = FindKeySlot(labels_.data() + begin, static_cast<uint16_t>(end - begin), prefix[pos]);
+    if (slot < 0) {
+      return FrozenTrieCursor();
+    }
+    size_t child = begin + slot + 1;
+    std::string_view segment = Segment(child);
+    std::string_view rest = prefix.substr(pos + 1);
+    size_t overlap = std::min(segment.size(), rest.size());
+    if (segment.substr(0, overlap) != rest.substr(0, overlap)) {
+      return FrozenTrieCursor();
+    }
+    cursor.key_.push_back(prefix[pos]);
+    cursor.key_.append(segment);
+    pos += 1 + segment.size();
+    node = child;
+  }
+  cursor.Enter(node);
+  return cursor;
+}
+
+void FrozenTrieCursor::Enter(size_t node) {
+  auto [begin, end] = trie_->Edges(node);
+  stack_.push_back({node, begin, end, key_.size()});
+  if (trie_->ValueOf(node, value_type_) == nullptr) {
+    Advance();
+  }
+}
+
+void FrozenTrieCursor::Advance() {
+  while (!stack_.empty()) {
+    Frame &top = stack_.back();
+    if (top.next_ == top.end_) {
+      stack_.pop_back();
+      continue;
+    }
+    size_t edge = top.next_++;
+    size_t child = edge + 1;
+    key_.resize(top.key_size_);
+    key_.push_back(trie_->labels_[edge]);
+    key_.append(trie_->Segment(child));
+    auto [begin, end] = trie_->Edges(child);
+    stack_.push_back({child, begin, end, key_.size()});
+    if (trie_->ValueOf(child, value_type_) != nullptr) {
+      return;
+    }
+  }
+}
+
+auto Freeze(const Trie &trie) -> FrozenTrie {
+  FrozenTrie frozen;
+  const TrieNode *root = trie.GetRoot().get();
+  frozen.segment_offsets_.push_back(0);
+  if (root != nullptr) {
+    // Number the nodes in breadth-first order, which is the order of the LOUDS bits and of the edges
+    std::vector<const TrieNode *> order{root};
+    for (size_t i = 0; i < order.size(); i++) {
+      const TrieNode &node = *order[i];
+      for (const auto &[ch, child] : node.children_) {
+        frozen.louds_.PushBack(true);
+        frozen.labels_.push_back(ch);
+        order.push_back(child.get());
+      }
+      frozen.louds_.PushBack(false);
+
+      frozen.has_segment_.PushBack(!node.segment_.empty());
+      if (!node.segment_.empty()) {
+        frozen.segments_.append(node.segment_);
+        frozen.segment_offsets_.push_back(static_cast<uint32_t>(frozen.segments_.size()));
+      }
+
+      auto [type, size] = SnapshotFormat::ValueInfo(node);
+      frozen.has_value_.PushBack(type != 0);
+      if (type != 0) {
+        frozen.value_types_.push_back(type);
+        frozen.value_offsets_.push_back(static_cast<uint32_t>(frozen.values_.size()));
+        frozen.values_.resize(frozen.values_.size() + size);
+        SnapshotFormat::EncodeValue(node, frozen.values_.data() + frozen.values_.size() - size);
+      }
+      if (frozen.segments_.size() > std::numeric_limits<uint32_t>::max() ||
+          frozen.values_.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Freeze: segments or values too large");
+      }
+    }
+  }
+  frozen.louds_.Finish();
+  frozen.has_segment_.Finish();
+  frozen.has_value_.Finish();
+  frozen.labels_.shrink_to_fit();
+  frozen.segments_.shrink_to_fit();
+  frozen.segment_offsets_.shrink_to_fit();
+  frozen.value_types_.shrink_to_fit();
+  frozen.value_offsets_.shrink_to_fit();
+  frozen.values_.shrink_to_fit();
+  return frozen;
+}
+
+}  // namespace bustub
@@ -0,0 +1,258 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_frozen.h
+//
+// Identification: src/include/primer/trie_frozen.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+#include "trie_snapshot.h"
+
+namespace bustub {
+
+// An immutable sequence of bits with constant-time rank and select, the building block of `FrozenTrie`. The
+// directories cost 32 bits per 512 bits for rank, and 32 bits per 512 zeros for select.
+class BitVector {
+ public:
+  void PushBack(bool bit) {
+    if (size_ % 64 == 0) {
+      words_.push_back(0);
+    }
+    words_.back() |= static_cast<uint64_t>(bit) << (size_ % 64);
+    size_++;
+  }
+
+  // Build the rank and select directories. Call it once, after the last `PushBack`.
+  void Finish();
+
+  auto Get(size_t i) const -> bool { return ((words_[i / 64] >> (i % 64)) & 1) != 0; }
+
+  // The number of ones in [0, i).
+  auto Rank1(size_t i) const -> size_t;
+
+  // The position of the zero with index `k` (counting from 0). There must be more than `k` zeros.
+  auto Select0(size_t k) const -> size_t;
+
+  // The position of the first zero at or after `i`. There must be one.
+  auto NextZero(size_t i) const -> size_t;
+
+  auto Size() const -> size_t { return size_; }
+  // Bytes of the bits and the directories, which are on the heap.
+  auto HeapBytes() const -> size_t {
+    return words_.capacity() * sizeof(uint64_t) + ranks_.capacity() * sizeof(uint32_t) +
+           zero_samples_.capacity() * sizeof(uint32_t);
+  }
+
+ private:
+  static constexpr size_t kBlockBits = 512;
+  static constexpr size_t kBlockWords = kBlockBits / 64;
+  static constexpr size_t kZerosPerSample = 512;
+
+  // The number of zeros before block `b`.
+  auto ZerosBefore(size_t b) const -> size_t { return b * kBlockBits - ranks_[b]; }
+
+  std::vector<uint64_t> words_;
+  size_t size_{0};
+  // ranks_[b] is the number of ones before block b, with one entry past the last block.
+  std::vector<uint32_t> ranks_;
+  // zero_samples_[s] is the block holding the zero with index s * kZerosPerSample.
+  std::vector<uint32_t> zero_samples_;
+};
+
+class FrozenTrie;
+
+// A forward cursor over the values of one type of a FrozenTrie, in key order. See `TrieCursor`, which it mirrors for
+// in-memory tries.
+class FrozenTrieCursor {
+ public:
+  FrozenTrieCursor() = default;
+
+  auto IsEnd() const -> bool { return stack_.empty(); }
+  auto Key() const -> std::string_view { return key_; }
+  // The current node.
+  auto Node() const -> size_t { return stack_.back().node_; }
+  void Next() { Advance(); }
+
+ private:
+  friend class FrozenTrie;
+
+  struct Frame {
+    size_t node_;
+    // The next edge of `node_` to follow, and the end of its edges.
+    size_t next_;
+    size_t end_;
+    size_t key_size_;
+  };
+
+  FrozenTrieCursor(const FrozenTrie *trie, uint8_t value_type) : trie_(trie), value_type_(value_type) {}
+
+  void Enter(size_t node);
+  void Advance();
+
+  const FrozenTrie *trie_{nullptr};
+  uint8_t value_type_{0};
+  std::vector<Frame> stack_;
+  std::string key_;
+};
+
+template <class T>
+class FrozenTrieScan;
+
+// A FrozenTrie is a read-only, succinct copy of a trie, for dictionaries that are built once and then only read. It
+// is built with `Freeze` and answers `Get` and prefix `Scan`, like a `TrieView`, at a few bytes per key rather than
+// the hundred or so a node of a pointer-based trie takes.
+//
+// Nodes are numbered in breadth-first order and the shape of the trie is a LOUDS bit vector: for every node, one 1
+// per child and a 0. The children of a node therefore have consecutive numbers, and edge e, in the same order, leads
+// to node e + 1, so a lookup step is one `Select0` and a search of the node's labels, which are stored together in one
+// byte array. Which nodes have a segment or a value is kept in two more bit vectors, whose `Rank1` indexes packed
+// arrays of segment bytes and values. Values are encoded as in snapshot files, so the same types are supported; their
+// scores are dropped.
+class FrozenTrie {
+ public:
+  // Create an empty FrozenTrie.
+  FrozenTrie() = default;
+
+  // Get the value of type T at `key`, or std::nullopt if there is none. A string is returned as a view into this
+  // FrozenTrie.
+  template <class T>
+  auto Get(std::string_view key) const -> std::optional<typename SnapshotValue<T>::View> {
+    auto node = FindNode(key);
+    if (!node.has_value()) {
+      return std::nullopt;
+    }
+    const std::byte *value = ValueOf(*node, SnapshotValue<T>::kTypeId);
+    if (value == nullptr) {
+      return std::nullopt;
+    }
+    return TrieView::Decode<T>(value);
+  }
+
+  // Iterate, in key order, over the values of type T whose keys start with `prefix`.
+  template <class T>
+  auto Scan(std::string_view prefix) const -> FrozenTrieScan<T> {
+    return FrozenTrieScan<T>(this, ScanCursor(SnapshotValue<T>::kTypeId, prefix));
+  }
+
+  auto NodeCount() const -> size_t { return labels_.size() + (louds_.Size() > 0 ? 1 : 0); }
+  auto ValueCount() const -> size_t { return value_types_.size(); }
+
+  // Bytes this FrozenTrie takes in memory, everything included.
+  auto MemoryBytes() const -> size_t;
+
+  // The encoded value of `node` if it has one of the type with snapshot type id `value_type`, or nullptr.
+  auto ValueOf(size_t node, uint8_t value_type) const -> const std::byte * {
+    if (!has_value_.Get(node)) {
+      return nullptr;
+    }
+    size_t index = has_value_.Rank1(node);
+    if (value_types_[index] != value_type) {
+      return nullptr;
+    }
+    return values_.data() + value_offsets_[index];
+  }
+
+ private:
+  friend auto Freeze(const Trie &trie) -> FrozenTrie;
+  friend class FrozenTrieCursor;
+
+  // The first edge of `node` and the end of its edges.
+  auto Edges(size_t node) const -> std::pair<size_t, size_t> {
+    size_t begin = node == 0 ? 0 : louds_.Select0(node - 1) + 1;
+    size_t end = louds_.NextZero(begin);
+    // The ones before `begin` are the edges of the nodes before this one
+    return {begin - node, end - node};
+  }
+
+  auto Segment(size_t node) const -> std::string_view {
+    if (!has_segment_.Get(node)) {
+      return {};
+    }
+    size_t index = has_segment_.Rank1(node);
+    return std::string_view(segments_).substr(segment_offsets_[index],
+                                              segment_offsets_[index + 1] - segment_offsets_[index]);
+  }
+
+  // The node at `key`, if any.
+  auto FindNode(std::string_view key) const -> std::optional<size_t>;
+
+  auto ScanCursor(uint8_t value_type, std::string_view prefix) const -> FrozenTrieCursor;
+
+  // The shape of the trie: for every node in breadth-first order, a 1 per child and a 0. Empty for an empty trie.
+  BitVector louds_;
+  // labels_[e] is the key byte of edge e, which leads to node e + 1.
+  std::string labels_;
+  BitVector has_segment_;
+  std::string segments_;
+  // The segment of the i-th node with one is segments_[segment_offsets_[i], segment_offsets_[i + 1]).
+  std::vector<uint32_t> segment_offsets_;
+  BitVector has_value_;
+  // The `SnapshotValue<T>::kTypeId` of the i-th value, and where it is encoded in `values_`.
+  std::vector<uint8_t> value_types_;
+  std::vector<uint32_t> value_offsets_;
+  std::vector<std::byte> values_;
+};
+
+// Copy `trie` into a FrozenTrie. Values must be uint32_t, uint64_t or std::string, as in snapshot files. Throws
+// std::invalid_argument for other value types, and std::length_error if the segments or values take 4 GiB or more.
+auto Freeze(const Trie &trie) -> FrozenTrie;
+
+template <class T>
+class FrozenTrieIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<std::string_view, typename SnapshotValue<T>::View>;
+
+  FrozenTrieIterator(const FrozenTrie *trie, FrozenTrieCursor cursor) : trie_(trie), cursor_(std::move(cursor)) {}
+
+  auto IsEnd() const -> bool { return cursor_.IsEnd(); }
+  auto Key() const -> std::string_view { return cursor_.Key(); }
+  auto Value() const -> typename SnapshotValue<T>::View {
+    return TrieView::Decode<T>(trie_->ValueOf(cursor_.Node(), SnapshotValue<T>::kTypeId));
+  }
+
+  auto operator*() const -> value_type { return {Key(), Value()}; }
+  auto operator++() -> FrozenTrieIterator & {
+    cursor_.Next();
+    return *this;
+  }
+  void operator++(int) { cursor_.Next(); }
+
+  auto operator==(std::default_sentinel_t /*unused*/) const -> bool { return IsEnd(); }
+
+ private:
+  const FrozenTrie *trie_;
+  FrozenTrieCursor cursor_;
+};
+
+template <class T>
+class FrozenTrieScan {
+ public:
+  FrozenTrieScan(const FrozenTrie *trie, FrozenTrieCursor cursor) : trie_(trie), cursor_(std::move(cursor)) {}
+
+  auto begin() const -> FrozenTrieIterator<T> { return FrozenTrieIterator<T>(trie_, cursor_); }  // NOLINT
+  auto end() const -> std::default_sentinel_t { return std::default_sentinel; }                // NOLINT
+
+ private:
+  const FrozenTrie *trie_;
+  FrozenTrieCursor cursor_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,156 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_frozen_test.cpp
+//
+// Identification: test/primer/trie_frozen_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+#include "trie_frozen.h"
+#include "trie_iterator.h"
+#include "trie_stats.h"
+
+namespace bustub {
+
+TEST(FrozenTrieTest, BitVectorTest) {
+  std::mt19937 rng(2333);
+  for (size_t size : {1, 63, 64, 65, 511, 512, 513, 5000, 100000}) {
+    BitVector bits;
+    std::vector<bool> expected;
+    for (size_t i = 0; i < size; i++) {
+      // Long runs of ones, so that some blocks hold no zero at all
+      bool bit = i % 2000 < 1200 || rng() % 3 != 0;
+      if (i + 1 == size) {
+        bit = false;
+      }
+      bits.PushBack(bit);
+      expected.push_back(bit);
+    }
+    bits.Finish();
+    ASSERT_EQ(bits.Size(), size);
+
+    size_t ones = 0;
+    size_t zeros = 0;
+    for (size_t i = 0; i < size; i++) {
+      ASSERT_EQ(bits.Get(i), expected[i]);
+      ASSERT_EQ(bits.Rank1(i), ones);
+      if (expected[i]) {
+        ones++;
+      } else {
+        ASSERT_EQ(bits.Select0(zeros), i);
+        zeros++;
+      }
+    }
+    ASSERT_EQ(bits.Rank1(size), ones);
+    ASSERT_EQ(bits.NextZero(0), bits.Select0(0));
+  }
+}
+
+TEST(FrozenTrieTest, GetTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      trie = trie.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    trie = trie.Put<uint64_t>("", 233);
+    trie = trie.Put<std::string>("key/", "directory");
+    trie = trie.Put<std::string>("key/1000000", std::string(100, 'x'));
+    // A node with every possible child
+    for (int c = 0; c < 256; c++) {
+      trie = trie.Put<uint32_t>(std::string("wide/") + static_cast<char>(c), c);
+    }
+
+    auto frozen = Freeze(trie);
+    ASSERT_EQ(frozen.NodeCount(), trie.Stats().nodes_);
+    ASSERT_EQ(frozen.ValueCount(), 1259);
+    for (uint32_t i = 0; i < 1000; i++) {
+      ASSERT_EQ(*frozen.Get<uint32_t>("key/" + std::to_string(i)), i);
+    }
+    for (int c = 0; c < 256; c++) {
+      ASSERT_EQ(*frozen.Get<uint32_t>(std::string("wide/") + static_cast<char>(c)), c);
+    }
+    ASSERT_EQ(*frozen.Get<uint64_t>(""), 233);
+    ASSERT_EQ(*frozen.Get<std::string>("key/"), "directory");
+    ASSERT_EQ(*frozen.Get<std::string>("key/1000000"), std::string(100, 'x'));
+    ASSERT_TRUE(!frozen.Get<uint32_t>("key/").has_value());
+    ASSERT_TRUE(!frozen.Get<uint32_t>("key/1000").has_value());
+    ASSERT_TRUE(!frozen.Get<uint32_t>("key").has_value());
+    ASSERT_TRUE(!frozen.Get<uint32_t>("missing").has_value());
+    ASSERT_TRUE(!frozen.Get<uint32_t>("wide/").has_value());
+    ASSERT_TRUE(!frozen.Get<std::string>("key/1").has_value());
+  }
+}
+
+TEST(FrozenTrieTest, ScanTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 500; i++) {
+      trie = trie.Put<uint32_t>("tenant/" + std::to_string(i % 7) + "/metric/" + std::to_string(i), i);
+    }
+    trie = trie.Put<std::string>("tenant/3/name", "skipped");
+    auto frozen = Freeze(trie);
+
+    for (const char *prefix : {"", "tenant/", "tenant/3", "tenant/3/met", "tenant/8", "tenant/3/metric/10"}) {
+      std::vector<std::pair<std::string, uint32_t>> expected;
+      for (const auto &[key, value] : trie.Scan<uint32_t>(prefix)) {
+        expected.emplace_back(key, value);
+      }
+      std::vector<std::pair<std::string, uint32_t>> scanned;
+      for (const auto &[key, value] : frozen.Scan<uint32_t>(prefix)) {
+        scanned.emplace_back(key, value);
+      }
+      ASSERT_TRUE(scanned == expected);
+    }
+    std::vector<std::string> names;
+    for (const auto &[key, value] : frozen.Scan<std::string>("")) {
+      names.emplace_back(value);
+    }
+    ASSERT_TRUE(names == std::vector<std::string>({"skipped"}));
+  }
+}
+
+TEST(FrozenTrieTest, MemoryTest) {
+  auto trie = Trie(TrieLayout::kPathCompressed);
+  for (uint32_t i = 0; i < 20000; i++) {
+    trie = trie.Put<uint32_t>("user/" + std::to_string(i * 7919 % 100000) + "/score", i);
+  }
+  auto frozen = Freeze(trie);
+  // Under an eighth of the pointer-based trie: about 20 bytes per key, most of them the key's own segment bytes
+  ASSERT_TRUE(frozen.MemoryBytes() * 8 < trie.Stats().TotalBytes());
+  ASSERT_TRUE(frozen.MemoryBytes() < 24 * 20000);
+}
+
+TEST(FrozenTrieTest, EdgeCaseTest) {
+  auto empty = Freeze(Trie());
+  ASSERT_EQ(empty.NodeCount(), 0);
+  ASSERT_TRUE(!empty.Get<uint32_t>("").has_value());
+  ASSERT_TRUE(empty.Scan<uint32_t>("").begin().IsEnd());
+  ASSERT_TRUE(!FrozenTrie().Get<uint32_t>("a").has_value());
+
+  auto root_only = Freeze(Trie().Put<uint32_t>("", 1));
+  ASSERT_EQ(root_only.NodeCount(), 1);
+  ASSERT_EQ(*root_only.Get<uint32_t>(""), 1);
+  ASSERT_TRUE(!root_only.Get<uint32_t>("a").has_value());
+
+  // Only plain values can be frozen
+  bool thrown = false;
+  try {
+    Freeze(Trie().Put<std::unique_ptr<uint32_t>>("a", std::make_unique<uint32_t>(1)));
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+}
+
+}  // namespace bustub
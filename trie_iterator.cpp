@@ -0,0 +1,126 @@
+#include "trie_iterator.h"
+
+namespace bustub {
+
+auto TrieCursor::Prefix(std::shared_ptr<const TrieNode> root, const void *value_type, std::string_view prefix)
+    -> TrieCursor {
+  TrieCursor cursor(std::move(root), value_type);
+  if (cursor.root_ == nullptr) {
+    return cursor;
+  }
+
+  // Walk down to the node whose subtree holds exactly the keys starting with `prefix`. The prefix may end in the
+  // middle of that node's segment.
+  const TrieNode *node = cursor.root_.get();
+  size_t pos = 0;
+  while (pos < prefix.size()) {
+    const auto *child = node->children_.Lookup(prefix[pos]);
+    if (child == nullptr) {
+      return TrieCursor();
+    }
+    const std::string &segment = (*child)->segment_;
+    std::string_view rest = prefix.substr(pos + 1);
+    size_t overlap = std::min(segment.size(), rest.size());
+    if (segment.compare(0, overlap, rest, 0, overlap) != 0) {
+      return TrieCursor();
+    }
+    cursor.key_.push_back(prefix[pos]);
+    cursor.key_.append(segment);
+    pos += 1 + segment.size();
+    node = child->get();
+  }
+  cursor.Enter(node);
+  return cursor;
+}
+
+auto TrieCursor::Range(std::shared_ptr<const TrieNode> root, const void *value_type, std::string_view begin,
+                       std::string_view end) -> TrieCursor {
+  TrieCursor cursor(std::move(root), value_type);
+  if (cursor.root_ == nullptr || begin >= end) {
+    return TrieCursor();
+  }
+  cursor.end_ = std::string(end);
+
+  // Seek to the first key not less than `begin`: follow `begin` down as far as the trie has it, leaving every frame
+  // on the path positioned after the child we descended into.
+  const TrieNode *node = cursor.root_.get();
+  cursor.stack_.push_back({node, node->children_.begin(), 0});
+  size_t pos = 0;
+  while (pos < begin.size()) {
+    // `node` has a key that is a proper prefix of `begin`, so it is excluded; its subtrees are visited from the first
+    // child that is not less than the next byte of `begin`
+    Frame &top = cursor.stack_.back();
+    top.next_ = node->children_.lower_bound(begin[pos]);
+    if (top.next_ == node->children_.end() || (*top.next_).first != begin[pos]) {
+      cursor.Advance();
+      return cursor;
+    }
+    const auto &child = (*top.next_).second;
+    ++top.next_;
+
+    const std::string &segment = child->segment_;
+    std::string_view rest = begin.substr(pos + 1);
+    cursor.key_.resize(top.key_size_);
+    cursor.key_.push_back(begin[pos]);
+    cursor.key_.append(segment);
+    if (rest.substr(0, segment.size()) == segment) {
+      // The segment follows `begin`: keep going down
+      node = child.get();
+      cursor.stack_.push_back({node, node->children_.begin(), cursor.key_.size()});
+      pos += 1 + segment.size();
+      continue;
+    }
+    if (std::string_view(segment) > rest) {
+      // Every key below `child` is greater than `begin`
+      if (cursor.key_ >= *cursor.end_) {
+        return TrieCursor();
+      }
+      cursor.Enter(child.get());
+    } else {
+      // Every key below `child` is less than `begin`
+      cursor.Advance();
+    }
+    return cursor;
+  }
+
+  // `node` has exactly the key `begin`
+  if (cursor.IsMatch(node)) {
+    return cursor;
+  }
+  cursor.Advance();
+  return cursor;
+}
+
+void TrieCursor::Enter(const TrieNode *node) {
+  stack_.push_back({node, node->children_.begin(), key_.size()});
+  if (!IsMatch(node)) {
+    Advance();
+  }
+}
+
+void TrieCursor::Advance() {
+  while (!stack_.empty()) {
+    Frame &top = stack_.back();
+    if (top.next_ == top.node_->children_.end()) {
+      stack_.pop_back();
+      continue;
+    }
+    const auto &[ch, child] = *top.next_;
+    ++top.next_;
+    key_.resize(top.key_size_);
+    key_.push_back(ch);
+    key_.append(child->segment_);
+    if (end_.has_value() && key_ >= *end_) {
+      // Keys only grow from here on
+      stack_.clear();
+      return;
+    }
+    const TrieNode *node = child.get();
+    stack_.push_back({node, node->children_.begin(), key_.size()});
+    if (IsMatch(node)) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_iterator.h
+//
+// Identification: src/include/primer/trie_iterator.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+// A TrieCursor walks the value nodes of one value type of a trie snapshot in lexicographic (unsigned byte) key
+// order. It is a depth-first walk with an explicit stack, and builds every key in a single buffer that it extends and
+// truncates as it moves, so enumerating n keys allocates nothing per key.
+//
+// The cursor keeps the snapshot's root alive, so it stays valid whatever happens to the trie it was created from.
+class TrieCursor {
+ public:
+  // Create an exhausted cursor.
+  TrieCursor() = default;
+
+  // Create a cursor over the values of type `value_type` whose keys start with `prefix`.
+  static auto Prefix(std::shared_ptr<const TrieNode> root, const void *value_type, std::string_view prefix)
+      -> TrieCursor;
+
+  // Create a cursor over the values of type `value_type` whose keys are in [begin, end).
+  static auto Range(std::shared_ptr<const TrieNode> root, const void *value_type, std::string_view begin,
+                    std::string_view end) -> TrieCursor;
+
+  auto IsEnd() const -> bool { return stack_.empty(); }
+
+  // The current key. The view is invalidated by `Next`.
+  auto Key() const -> std::string_view { return key_; }
+
+  // The current value node.
+  auto Node() const -> const TrieNode * { return stack_.back().node_; }
+
+  // Move to the next key.
+  void Next() { Advance(); }
+
+ private:
+  struct Frame {
+    const TrieNode *node_;
+    // The next child of `node_` to visit.
+    TrieNode::Children::const_iterator next_;
+    // Length of the key of `node_`, segment included.
+    size_t key_size_;
+  };
+
+  TrieCursor(std::shared_ptr<const TrieNode> root, const void *value_type)
+      : root_(std::move(root)), value_type_(value_type) {}
+
+  auto IsMatch(const TrieNode *node) const -> bool { return node->value_type_ == value_type_; }
+
+  // Push `node`, whose key is the current key, and stop there if it matches; otherwise move on to the next match.
+  void Enter(const TrieNode *node);
+
+  // Move past the node on top of the stack to the next matching node in key order, descending into its children
+  // first.
+  void Advance();
+
+  // Keeps the snapshot alive.
+  std::shared_ptr<const TrieNode> root_;
+  const void *value_type_{nullptr};
+  std::vector<Frame> stack_;
+  std::string key_;
+  // Exclusive upper bound of the keys to visit, if any.
+  std::optional<std::string> end_;
+};
+
+// An input iterator over the (key, value) pairs of type T of a trie snapshot, in key order. Compares equal to
+// `std::default_sentinel` once exhausted.
+template <class T>
+class TrieIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<std::string_view, const T &>;
+
+  explicit TrieIterator(TrieCursor cursor) : cursor_(std::move(cursor)) {}
+
+  auto IsEnd() const -> bool { return cursor_.IsEnd(); }
+
+  // The current key. The view is invalidated when the iterator moves.
+  auto Key() const -> std::string_view { return cursor_.Key(); }
+
+  auto Value() const -> const T & { return *static_cast<const TrieNodeWithValue<T> *>(cursor_.Node())->value_; }
+
+  auto operator*() const -> value_type { return {Key(), Value()}; }
+  auto operator++() -> TrieIterator & {
+    cursor_.Next();
+    return *this;
+  }
+  void operator++(int) { cursor_.Next(); }
+
+  auto operator==(std::default_sentinel_t /*unused*/) const -> bool { return IsEnd(); }
+
+ private:
+  TrieCursor cursor_;
+};
+
+// The result of `Trie::Scan` and `Trie::Range`, to be used in a range-based for loop.
+template <class T>
+class TrieScan {
+ public:
+  explicit TrieScan(TrieCursor cursor) : cursor_(std::move(cursor)) {}
+
+  auto begin() const -> TrieIterator<T> { return TrieIterator<T>(cursor_); }  // NOLINT
+  auto end() const -> std::default_sentinel_t { return std::default_sentinel; }  // NOLINT
+
+ private:
+  TrieCursor cursor_;
+};
+
+template <class T>
+auto Trie::Scan(std::string_view prefix) const -> TrieScan<T> {
+  return TrieScan<T>(TrieCursor::Prefix(root_, GetValueTypeTag<T>(), prefix));
+}
+
+template <class T>
+auto Trie::Range(std::string_view begin, std::string_view end) const -> TrieScan<T> {
+  return TrieScan<T>(TrieCursor::Range(root_, GetValueTypeTag<T>(), begin, end));
+}
+
+}  // namespace bustub
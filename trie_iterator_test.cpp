@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_iterator_test.cpp
+//
+// Identification: test/primer/trie_iterator_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "trie_iterator.h"
+
+namespace bustub {
+
+namespace {
+
+template <class T>
+auto Collect(const TrieScan<T> &scan) -> std::vector<std::pair<std::string, T>> {
+  std::vector<std::pair<std::string, T>> result;
+  for (const auto &[key, value] : scan) {
+    result.emplace_back(std::string(key), value);
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST(TrieIteratorTest, ScanTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    trie = trie.Put<uint32_t>("tenant/a/cpu", 1);
+    trie = trie.Put<uint32_t>("tenant/a/mem", 2);
+    trie = trie.Put<uint32_t>("tenant/b/cpu", 3);
+    trie = trie.Put<uint32_t>("tenant", 4);
+    trie = trie.Put<uint32_t>("", 5);
+    trie = trie.Put<std::string>("tenant/a/name", "skipped");
+
+    auto all = Collect(trie.Scan<uint32_t>(""));
+    std::vector<std::pair<std::string, uint32_t>> expected = {
+        {"", 5}, {"tenant", 4}, {"tenant/a/cpu", 1}, {"tenant/a/mem", 2}, {"tenant/b/cpu", 3}};
+    ASSERT_TRUE(all == expected);
+
+    // A prefix may end in the middle of a compressed segment.
+    auto tenant_a = Collect(trie.Scan<uint32_t>("tenant/a"));
+    ASSERT_EQ(tenant_a.size(), 2);
+    ASSERT_EQ(tenant_a[0].first, "tenant/a/cpu");
+    ASSERT_EQ(tenant_a[1].first, "tenant/a/mem");
+    ASSERT_EQ(Collect(trie.Scan<uint32_t>("tenant/a/c")).size(), 1);
+    ASSERT_EQ(Collect(trie.Scan<uint32_t>("tenant/")).size(), 3);
+    ASSERT_EQ(Collect(trie.Scan<uint32_t>("tenant/c")).size(), 0);
+    ASSERT_EQ(Collect(trie.Scan<uint32_t>("tenant/a/cpux")).size(), 0);
+
+    auto names = Collect(trie.Scan<std::string>("tenant"));
+    ASSERT_EQ(names.size(), 1);
+    ASSERT_EQ(names[0].second, "skipped");
+
+    ASSERT_EQ(Collect(Trie(layout).Scan<uint32_t>("")).size(), 0);
+  }
+}
+
+TEST(TrieIteratorTest, RangeTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (const char *key : {"apple", "apricot", "banana", "band", "bandana", "cherry"}) {
+      trie = trie.Put<std::string>(key, key);
+    }
+
+    auto range = Collect(trie.Range<std::string>("apricot", "band"));
+    ASSERT_EQ(range.size(), 2);
+    ASSERT_EQ(range[0].first, "apricot");
+    ASSERT_EQ(range[1].first, "banana");
+
+    range = Collect(trie.Range<std::string>("b", "bandz"));
+    ASSERT_EQ(range.size(), 3);
+    ASSERT_EQ(range[2].first, "bandana");
+
+    range = Collect(trie.Range<std::string>("ap", "c"));
+    ASSERT_EQ(range.size(), 5);
+
+    range = Collect(trie.Range<std::string>("bandb", "zzz"));
+    ASSERT_EQ(range.size(), 1);
+    ASSERT_EQ(range[0].first, "cherry");
+
+    ASSERT_EQ(Collect(trie.Range<std::string>("cherryz", "d")).size(), 0);
+    ASSERT_EQ(Collect(trie.Range<std::string>("c", "b")).size(), 0);
+  }
+}
+
+TEST(TrieIteratorTest, SnapshotTest) {
+  auto trie = Trie();
+  trie = trie.Put<uint32_t>("a", 1);
+  trie = trie.Put<uint32_t>("b", 2);
+  auto scan = trie.Scan<uint32_t>("");
+  auto it = scan.begin();
+
+  // The iterator walks the snapshot it was created from.
+  trie = Trie();
+  ASSERT_EQ((*it).first, "a");
+  ++it;
+  ASSERT_EQ(it.Value(), 2);
+  ++it;
+  ASSERT_TRUE(it == std::default_sentinel);
+}
+
+TEST(TrieIteratorTest, RandomTest) {
+  std::mt19937 gen(233);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    std::map<std::string, uint32_t> expected;
+    for (uint32_t i = 0; i < 2000; i++) {
+      // Include bytes above 0x7f: keys are ordered as unsigned bytes.
+      std::string key;
+      size_t length = gen() % 6;
+      for (size_t j = 0; j < length; j++) {
+        key.push_back(static_cast<char>("ab\xe4z"[gen() % 4]));
+      }
+      if (gen() % 4 == 0) {
+        trie = trie.Remove(key);
+        expected.erase(key);
+      } else {
+        trie = trie.Put<uint32_t>(key, i);
+        expected[key] = i;
+      }
+    }
+
+    auto all = Collect(trie.Scan<uint32_t>(""));
+    std::vector<std::pair<std::string, uint32_t>> everything(expected.begin(), expected.end());
+    ASSERT_TRUE(all == everything);
+
+    for (const char *begin : {"", "a", "ab", "b\xe4", "zz", "\xe4"}) {
+      for (const char *end : {"b", "bz", "z", "\xe4\xe4", "\xff"}) {
+        auto range = Collect(trie.Range<uint32_t>(begin, end));
+        std::vector<std::pair<std::string, uint32_t>> want;
+        if (std::string_view(begin) < std::string_view(end)) {
+          want.assign(expected.lower_bound(begin), expected.lower_bound(end));
+        }
+        ASSERT_TRUE(range == want);
+      }
+    }
+    for (const char *prefix : {"a", "ab", "z\xe4", "bbb"}) {
+      auto scan = Collect(trie.Scan<uint32_t>(prefix));
+      std::vector<std::pair<std::string, uint32_t>> want;
+      for (auto it = expected.lower_bound(prefix); it != expected.end() && it->first.starts_with(prefix); ++it) {
+        want.push_back(*it);
+      }
+      ASSERT_TRUE(scan == want);
+    }
+  }
+}
+
+}  // namespace bustub
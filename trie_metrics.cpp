@@ -0,0 +1,57 @@
+#include "trie_metrics.h"
+
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <vector>
+
+namespace bustub {
+
+// The counters of live threads, and the sums of those of exited ones. Function-local, so that threads created during
+// static initialization find them constructed.
+struct MetricsRegistry {
+  std::mutex latch_;
+  std::vector<const std::array<std::atomic<uint64_t>, kTrieCounterCount> *> live_;
+  TrieMetrics::Counts exited_{};
+};
+
+static auto Registry() -> MetricsRegistry & {
+  static auto *registry = new MetricsRegistry();  // Never destroyed: threads may exit after static destruction
+  return *registry;
+}
+
+TrieMetrics::ThreadCounters::ThreadCounters() {
+  auto &registry = Registry();
+  std::scoped_lock lock(registry.latch_);
+  registry.live_.push_back(&counts_);
+}
+
+TrieMetrics::ThreadCounters::~ThreadCounters() {
+  auto &registry = Registry();
+  std::scoped_lock lock(registry.latch_);
+  for (size_t i = 0; i < kTrieCounterCount; i++) {
+    registry.exited_[i] += counts_[i].load(std::memory_order_relaxed);
+  }
+  registry.live_.erase(std::find(registry.live_.begin(), registry.live_.end(), &counts_));
+}
+
+auto TrieMetrics::Collect() -> Counts {
+  auto &registry = Registry();
+  std::scoped_lock lock(registry.latch_);
+  Counts total = registry.exited_;
+  for (const auto *counts : registry.live_) {
+    for (size_t i = 0; i < kTrieCounterCount; i++) {
+      total[i] += (*counts)[i].load(std::memory_order_relaxed);
+    }
+  }
+  return total;
+}
+
+auto TrieMetrics::Name(TrieCounter counter) -> const char * {
+  static constexpr std::array<const char *, kTrieCounterCount> kNames = {
+      "gets",           "get_nanos",       "puts",        "put_nanos",   "removes",     "remove_nanos",
+      "nodes_visited",  "nodes_allocated", "nodes_reused", "path_copies", "type_checks", "virtual_clones",
+  };
+  return kNames[static_cast<size_t>(counter)];
+}
+
+}  // namespace bustub
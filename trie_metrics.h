@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_metrics.h
+//
+// Identification: src/include/primer/trie_metrics.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+// What the instrumented hot paths of the trie count.
+enum class TrieCounter : uint8_t {
+  kGets,
+  kGetNanos,
+  kPuts,
+  kPutNanos,
+  kRemoves,
+  kRemoveNanos,
+  // Nodes a Get, Put or Remove stepped through.
+  kNodesVisited,
+  // Every node created, by any operation.
+  kNodesAllocated,
+  // Child subtrees a write carried over unchanged into a rebuilt node.
+  kNodesReused,
+  // Nodes a Put or Remove rebuilt on the path to its key; divided by the number of writes, the path-copy depth.
+  kPathCopies,
+  // Checks of a value node's type tag, which is what the trie does instead of a `dynamic_cast`.
+  kTypeChecks,
+  // Virtual `CloneWithChildren` calls, the other place the node type is dispatched on.
+  kVirtualClones,
+  kCount,
+};
+
+inline constexpr size_t kTrieCounterCount = static_cast<size_t>(TrieCounter::kCount);
+
+// Per-thread counters of trie operations. They are only updated when the trie is built with BUSTUB_TRIE_METRICS (the
+// TRIE_METRICS CMake option); otherwise the BUSTUB_TRIE_COUNT and BUSTUB_TRIE_TIMER macros below expand to nothing
+// and every counter stays 0.
+//
+// Each thread increments counters of its own, in a cache line no other thread writes, and `Collect` sums them up on
+// demand. Counts of exited threads are kept.
+class TrieMetrics {
+ public:
+  using Counts = std::array<uint64_t, kTrieCounterCount>;
+
+#ifdef BUSTUB_TRIE_METRICS
+  static constexpr bool kEnabled = true;
+#else
+  static constexpr bool kEnabled = false;
+#endif
+
+  static void Add(TrieCounter counter, uint64_t n) {
+    auto &count = Local().counts_[static_cast<size_t>(counter)];
+    // Only this thread writes its counters, so there is no need for an atomic increment; `Collect` may read a count
+    // that is slightly behind.
+    count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+  }
+
+  // The sum of the counters of all threads, indexed by TrieCounter.
+  static auto Collect() -> Counts;
+
+  static auto Name(TrieCounter counter) -> const char *;
+
+ private:
+  // The counters of one thread. The constructor and destructor register them with `Collect`.
+  struct alignas(64) ThreadCounters {
+    ThreadCounters();
+    ~ThreadCounters();
+    ThreadCounters(const ThreadCounters &) = delete;
+    auto operator=(const ThreadCounters &) -> ThreadCounters & = delete;
+
+    std::array<std::atomic<uint64_t>, kTrieCounterCount> counts_{};
+  };
+
+  static auto Local() -> ThreadCounters & {
+    thread_local ThreadCounters counters;
+    return counters;
+  }
+};
+
+// Adds the time from its construction to its destruction, in nanoseconds, to a counter.
+class TrieTimer {
+ public:
+  explicit TrieTimer(TrieCounter counter) : counter_(counter), start_(std::chrono::steady_clock::now()) {}
+  TrieTimer(const TrieTimer &) = delete;
+  auto operator=(const TrieTimer &) -> TrieTimer & = delete;
+  ~TrieTimer() {
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+    TrieMetrics::Add(counter_, elapsed.count());
+  }
+
+ private:
+  TrieCounter counter_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+}  // namespace bustub
+
+#ifdef BUSTUB_TRIE_METRICS
+#define BUSTUB_TRIE_COUNT(counter, n) ::bustub::TrieMetrics::Add(::bustub::TrieCounter::counter, (n))
+#define BUSTUB_TRIE_TIMER(counter) ::bustub::TrieTimer bustub_trie_timer_(::bustub::TrieCounter::counter)
+#else
+#define BUSTUB_TRIE_COUNT(counter, n) static_cast<void>(0)
+#define BUSTUB_TRIE_TIMER(counter) static_cast<void>(0)
+#endif
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_metrics_test.cpp
+//
+// Identification: test/primer/trie_metrics_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <thread>  // NOLINT
+
+#include "test.h"
+#include "trie.h"
+#include "trie_metrics.h"
+
+namespace bustub {
+
+namespace {
+
+auto Delta(const TrieMetrics::Counts &before, TrieCounter counter) -> uint64_t {
+  return TrieMetrics::Collect()[static_cast<size_t>(counter)] - before[static_cast<size_t>(counter)];
+}
+
+}  // namespace
+
+TEST(TrieMetricsTest, CounterTest) {
+  ASSERT_EQ(std::string(TrieMetrics::Name(TrieCounter::kGets)), "gets");
+  ASSERT_EQ(std::string(TrieMetrics::Name(TrieCounter::kVirtualClones)), "virtual_clones");
+
+  auto trie = Trie(TrieLayout::kPerCharacter).Put<uint32_t>("ab", 1).Put<uint32_t>("b", 2);
+  auto before = TrieMetrics::Collect();
+  trie = trie.Put<uint32_t>("abc", 3);
+  uint64_t puts = Delta(before, TrieCounter::kPuts);
+  uint64_t visited = Delta(before, TrieCounter::kNodesVisited);
+  uint64_t copies = Delta(before, TrieCounter::kPathCopies);
+  uint64_t reused = Delta(before, TrieCounter::kNodesReused);
+  uint64_t allocated = Delta(before, TrieCounter::kNodesAllocated);
+
+  // Counts of other threads are collected too, after they exit
+  before = TrieMetrics::Collect();
+  std::thread reader([&] {
+    for (int i = 0; i < 100; i++) {
+      trie.Get<uint32_t>("abc");
+    }
+  });
+  reader.join();
+  uint64_t gets = Delta(before, TrieCounter::kGets);
+  uint64_t checks = Delta(before, TrieCounter::kTypeChecks);
+
+  if (!TrieMetrics::kEnabled) {
+    ASSERT_EQ(puts + visited + copies + reused + allocated + gets + checks, 0);
+    return;
+  }
+  ASSERT_EQ(puts, 1);
+  // The root, "a" and "ab" are visited and rebuilt, "abc" is created; the root keeps "b"
+  ASSERT_EQ(visited, 3);
+  ASSERT_EQ(copies, 4);
+  ASSERT_EQ(reused, 1);
+  ASSERT_EQ(allocated, 4);
+  ASSERT_EQ(gets, 100);
+  ASSERT_EQ(checks, 100);
+}
+
+}  // namespace bustub
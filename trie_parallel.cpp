@@ -0,0 +1,61 @@
+#include "trie_parallel.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+auto SplitPrefixScan(const TrieNode *root, std::string_view prefix, size_t parts) -> std::vector<TrieScanPart> {
+  if (root == nullptr) {
+    return {};
+  }
+
+  // Walk down to the node whose subtree holds exactly the keys starting with `prefix`. The prefix may end in the
+  // middle of that node's segment.
+  const TrieNode *node = root;
+  std::string key;
+  while (key.size() < prefix.size()) {
+    const auto *child = node->children_.Lookup(prefix[key.size()]);
+    if (child == nullptr) {
+      return {};
+    }
+    const std::string &segment = (*child)->segment_;
+    std::string_view rest = prefix.substr(key.size() + 1);
+    size_t overlap = std::min(segment.size(), rest.size());
+    if (segment.compare(0, overlap, rest, 0, overlap) != 0) {
+      return {};
+    }
+    key.push_back(prefix[key.size()]);
+    key.append(segment);
+    node = child->get();
+  }
+
+  std::vector<TrieScanPart> current{{std::move(key), node, true}};
+  while (current.size() < parts) {
+    std::vector<TrieScanPart> next;
+    bool split = false;
+    for (auto &part : current) {
+      if (!part.subtree_ || part.node_->children_.empty()) {
+        next.push_back(std::move(part));
+        continue;
+      }
+      // A node's own key sorts before every key below it
+      split = true;
+      if (part.node_->is_value_node_) {
+        next.push_back({part.key_, part.node_, false});
+      }
+      for (const auto &[ch, child] : part.node_->children_) {
+        std::string child_key = part.key_;
+        child_key.push_back(ch);
+        child_key.append(child->segment_);
+        next.push_back({std::move(child_key), child.get(), true});
+      }
+    }
+    current = std::move(next);
+    if (!split) {
+      break;
+    }
+  }
+  return current;
+}
+
+}  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_parallel.h
+//
+// Identification: src/include/primer/trie_parallel.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "thread_pool.h"
+#include "trie.h"
+#include "trie_iterator.h"
+
+namespace bustub {
+
+// A part of a prefix scan that runs as one task: either the whole subtree of a node, or only the node's own value.
+struct TrieScanPart {
+  // The full key of `node_`.
+  std::string key_;
+  const TrieNode *node_;
+  bool subtree_;
+};
+
+// Split the scan of the keys starting with `prefix` into whole subtrees, in key order. Subtrees are split at child
+// boundaries, level by level, until there are at least `parts` of them or nothing is left to split. Since a snapshot
+// is immutable, the parts can be scanned concurrently without any lock.
+auto SplitPrefixScan(const TrieNode *root, std::string_view prefix, size_t parts) -> std::vector<TrieScanPart>;
+
+// Call `fn(key, value)` for every value of type T in `part`, in key order.
+template <class T, class Fn>
+void ScanPart(const std::shared_ptr<const TrieNode> &root, const TrieScanPart &part, Fn &fn) {
+  if (!part.subtree_) {
+    if (part.node_->value_type_ == GetValueTypeTag<T>()) {
+      fn(std::string_view(part.key_), *static_cast<const TrieNodeWithValue<T> *>(part.node_)->value_);
+    }
+    return;
+  }
+  for (TrieIterator<T> it(TrieCursor::Prefix(root, GetValueTypeTag<T>(), part.key_)); !it.IsEnd(); ++it) {
+    fn(it.Key(), it.Value());
+  }
+}
+
+// Number of parts a parallel scan is split into per thread of the pool, so that stealing can even out uneven
+// subtrees.
+inline constexpr size_t kScanPartsPerThread = 8;
+
+template <class T, class Fn>
+void Trie::ParallelForEach(std::string_view prefix, Fn fn, ThreadPool &pool) const {
+  auto parts = SplitPrefixScan(root_.get(), prefix, (pool.Size() + 1) * kScanPartsPerThread);
+  pool.ParallelFor(parts.size(), [&](size_t i) { ScanPart<T>(root_, parts[i], fn); });
+}
+
+template <class T, class R, class Map, class Combine>
+auto Trie::ParallelReduce(std::string_view prefix, R init, Map map, Combine combine, ThreadPool &pool) const -> R {
+  auto parts = SplitPrefixScan(root_.get(), prefix, (pool.Size() + 1) * kScanPartsPerThread);
+  std::vector<R> partials(parts.size(), init);
+  pool.ParallelFor(parts.size(), [&](size_t i) {
+    auto fold = [&](std::string_view key, const T &value) {
+      partials[i] = combine(std::move(partials[i]), map(key, value));
+    };
+    ScanPart<T>(root_, parts[i], fold);
+  });
+  // The parts are in key order, and so is every partial result
+  R result = std::move(init);
+  for (auto &partial : partials) {
+    result = combine(std::move(result), std::move(partial));
+  }
+  return result;
+}
+
+}  // namespace bustub
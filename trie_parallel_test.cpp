@@ -0,0 +1,153 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_parallel_test.cpp
+//
+// Identification: test/primer/trie_parallel_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <ctime>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "test.h"
+#include "trie_parallel.h"
+
+namespace bustub {
+
+namespace {
+
+// CPU time used by the calling thread.
+auto ThreadCpuTime() -> std::chrono::nanoseconds {
+  timespec now{};
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+  return std::chrono::seconds(now.tv_sec) + std::chrono::nanoseconds(now.tv_nsec);
+}
+
+}  // namespace
+
+TEST(ThreadPoolTest, ParallelForTest) {
+  ThreadPool pool(4);
+  ASSERT_EQ(pool.Size(), 4);
+  std::vector<std::atomic<int>> hits(1000);
+  pool.ParallelFor(hits.size(), [&](size_t i) { hits[i]++; });
+  for (const auto &hit : hits) {
+    ASSERT_EQ(hit.load(), 1);
+  }
+
+  // Nested loops do not deadlock, even on a single worker.
+  ThreadPool single(1);
+  std::atomic<int> sum{0};
+  single.ParallelFor(8, [&](size_t i) { single.ParallelFor(8, [&](size_t j) { sum += i * j; }); });
+  ASSERT_EQ(sum.load(), 28 * 28);
+
+  bool thrown = false;
+  try {
+    pool.ParallelFor(100, [](size_t i) {
+      if (i == 42) {
+        throw std::runtime_error("42");
+      }
+    });
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+}
+
+TEST(ThreadPoolTest, WaitTest) {
+  // A caller with no iteration left to take sleeps until the others are done, rather than spinning. Its own
+  // iteration is short, and leaves the workers time to take all the others.
+  ThreadPool pool(4);
+  auto caller = std::this_thread::get_id();
+  auto start = ThreadCpuTime();
+  pool.ParallelFor(pool.Size() + 1, [caller](size_t) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::this_thread::get_id() == caller ? 20 : 200));
+  });
+  ASSERT_TRUE(ThreadCpuTime() - start < std::chrono::milliseconds(50));
+}
+
+TEST(ThreadPoolTest, SubmitTest) {
+  std::atomic<int> done{0};
+  {
+    ThreadPool pool(2);
+    for (int i = 0; i < 1000; i++) {
+      pool.Submit([&] { done++; });
+    }
+    // A ParallelFor may run submitted tasks while it waits, and still only waits for its own iterations.
+    std::atomic<int> hits{0};
+    pool.ParallelFor(100, [&](size_t) { hits++; });
+    ASSERT_EQ(hits.load(), 100);
+  }
+  // Destroying the pool runs the tasks still queued.
+  ASSERT_EQ(done.load(), 1000);
+}
+
+TEST(TrieParallelTest, ForEachTest) {
+  ThreadPool pool(4);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 5000; i++) {
+      trie = trie.Put<uint32_t>("metric/" + std::to_string(i), i);
+    }
+    trie = trie.Put<uint32_t>("metric/", 100000);
+    trie = trie.Put<std::string>("metric/name", "skipped");
+    trie = trie.Put<uint32_t>("other", 7);
+
+    std::atomic<uint64_t> sum{0};
+    std::atomic<size_t> count{0};
+    trie.ParallelForEach<uint32_t>(
+        "metric/",
+        [&](std::string_view /*key*/, const uint32_t &value) {
+          sum += value;
+          count++;
+        },
+        pool);
+    ASSERT_EQ(count.load(), 5001);
+    ASSERT_EQ(sum.load(), 4999ULL * 5000 / 2 + 100000);
+
+    // A prefix ending inside a compressed segment, and a missing one
+    count = 0;
+    trie.ParallelForEach<uint32_t>("metr", [&](std::string_view, const uint32_t &) { count++; }, pool);
+    ASSERT_EQ(count.load(), 5001);
+    count = 0;
+    trie.ParallelForEach<uint32_t>("nothing", [&](std::string_view, const uint32_t &) { count++; }, pool);
+    ASSERT_EQ(count.load(), 0);
+  }
+}
+
+TEST(TrieParallelTest, OrderedReduceTest) {
+  ThreadPool pool(4);
+  auto trie = Trie(TrieLayout::kPathCompressed);
+  for (uint32_t i = 0; i < 3000; i++) {
+    trie = trie.Put<uint32_t>(std::to_string(i * 7 % 3000), i);
+  }
+
+  // Concatenation is not commutative: the result shows the parts are combined in key order.
+  auto keys = trie.ParallelReduce<uint32_t>(
+      "", std::string(), [](std::string_view key, const uint32_t &) { return std::string(key) + ","; },
+      [](std::string a, const std::string &b) { return a + b; }, pool);
+  std::string expected;
+  for (auto [key, value] : trie.Scan<uint32_t>("")) {
+    expected += std::string(key) + ",";
+  }
+  ASSERT_EQ(keys, expected);
+
+  auto total = trie.ParallelReduce<uint32_t>(
+      "1", uint64_t{0}, [](std::string_view, const uint32_t &value) { return uint64_t{value}; },
+      [](uint64_t a, uint64_t b) { return a + b; }, pool);
+  uint64_t expected_total = 0;
+  for (auto [key, value] : trie.Scan<uint32_t>("1")) {
+    expected_total += value;
+  }
+  ASSERT_EQ(total, expected_total);
+}
+
+}  // namespace bustub
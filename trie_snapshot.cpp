@@ -0,0 +1,438 @@
+#include "trie_snapshot.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "durable_file.h"
+
+namespace bustub {
+
+namespace {
+
+// The record at `offset` in the `size`-byte snapshot at `base`, or nullptr unless the record, its keys, child
+// offsets, segment and value all lie within the snapshot, and a record without value has no value offset. A record
+// that passes can be read without further checks.
+auto CheckRecord(const std::byte *base, size_t size, uint64_t offset) -> const SnapshotFormat::Node * {
+  if (offset < SnapshotFormat::Align(sizeof(SnapshotFormat::Header)) || offset % 8 != 0 || offset > size ||
+      size - offset < sizeof(SnapshotFormat::Node)) {
+    return nullptr;
+  }
+  const auto *node = reinterpret_cast<const SnapshotFormat::Node *>(base + offset);
+  uint64_t end = offset + sizeof(SnapshotFormat::Node);
+  uint64_t body = SnapshotFormat::Align(node->child_count_) + node->child_count_ * sizeof(uint64_t) +
+                  static_cast<uint64_t>(node->segment_size_);
+  if (size - end < body) {
+    return nullptr;
+  }
+  if (node->value_type_ == 0) {
+    return node->value_offset_ == 0 ? node : nullptr;
+  }
+  if (node->value_offset_ > size) {
+    return nullptr;
+  }
+  uint64_t available = size - node->value_offset_;
+  switch (node->value_type_) {
+    case SnapshotValue<uint32_t>::kTypeId:
+      return available < sizeof(uint32_t) ? nullptr : node;
+    case SnapshotValue<uint64_t>::kTypeId:
+      return available < sizeof(uint64_t) ? nullptr : node;
+    case SnapshotValue<std::string>::kTypeId:
+      if (available < sizeof(uint64_t) ||
+          available - sizeof(uint64_t) < TrieView::Decode<uint64_t>(base + node->value_offset_)) {
+        return nullptr;
+      }
+      return node;
+    default:
+      return nullptr;
+  }
+}
+
+// The record of child `slot` of `parent`. Throws std::runtime_error if it fails `CheckRecord`, or does not come
+// after its parent: walking down then always ends, even in a corrupt file.
+auto ChildRecord(const std::byte *base, size_t size, const SnapshotFormat::Node *parent, int slot)
+    -> const SnapshotFormat::Node * {
+  uint64_t offset = SnapshotFormat::Children(parent)[slot];
+  const SnapshotFormat::Node *child = nullptr;
+  if (offset > static_cast<uint64_t>(reinterpret_cast<const std::byte *>(parent) - base)) {
+    child = CheckRecord(base, size, offset);
+  }
+  if (child == nullptr) {
+    throw std::runtime_error("TrieView: truncated or corrupt trie snapshot");
+  }
+  return child;
+}
+
+}  // namespace
+
+auto SnapshotFormat::ValueInfo(const TrieNode &node) -> std::pair<uint8_t, size_t> {
+  if (node.value_type_ == nullptr) {
+    return {0, 0};
+  }
+  if (node.value_type_ == GetValueTypeTag<uint32_t>()) {
+    return {SnapshotValue<uint32_t>::kTypeId, sizeof(uint32_t)};
+  }
+  if (node.value_type_ == GetValueTypeTag<uint64_t>()) {
+    return {SnapshotValue<uint64_t>::kTypeId, sizeof(uint64_t)};
+  }
+  if (node.value_type_ == GetValueTypeTag<std::string>()) {
+    const auto &value = *static_cast<const TrieNodeWithValue<std::string> &>(node).value_;
+    return {SnapshotValue<std::string>::kTypeId, sizeof(uint64_t) + value.size()};
+  }
+  throw std::invalid_argument("Trie::Serialize: unsupported value type");
+}
+
+void SnapshotFormat::EncodeValue(const TrieNode &node, std::byte *out) {
+  if (node.value_type_ == GetValueTypeTag<uint32_t>()) {
+    std::memcpy(out, static_cast<const TrieNodeWithValue<uint32_t> &>(node).value_.get(), sizeof(uint32_t));
+  } else if (node.value_type_ == GetValueTypeTag<uint64_t>()) {
+    std::memcpy(out, static_cast<const TrieNodeWithValue<uint64_t> &>(node).value_.get(), sizeof(uint64_t));
+  } else if (node.value_type_ == GetValueTypeTag<std::string>()) {
+    const auto &value = *static_cast<const TrieNodeWithValue<std::string> &>(node).value_;
+    uint64_t size = value.size();
+    std::memcpy(out, &size, sizeof(size));
+    std::memcpy(out + sizeof(size), value.data(), value.size());
+  }
+}
+
+template <class T>
+static auto MakeDecodedNode(const std::byte *value, TrieNode::Children children) -> std::shared_ptr<TrieNode> {
+  return std::make_shared<TrieNodeWithValue<T>>(std::move(children),
+                                                MakeNodeValue<T>(nullptr, T(TrieView::Decode<T>(value))));
+}
+
+auto SnapshotFormat::DecodeNode(uint8_t value_type, const std::byte *value, size_t size,
+                                TrieNode::Children children) -> std::shared_ptr<TrieNode> {
+  switch (value_type) {
+    case 0:
+      return TrieNode::MakeInner(std::move(children), nullptr);
+    case SnapshotValue<uint32_t>::kTypeId:
+      return size < sizeof(uint32_t) ? nullptr : MakeDecodedNode<uint32_t>(value, std::move(children));
+    case SnapshotValue<uint64_t>::kTypeId:
+      return size < sizeof(uint64_t) ? nullptr : MakeDecodedNode<uint64_t>(value, std::move(children));
+    case SnapshotValue<std::string>::kTypeId:
+      if (size < sizeof(uint64_t) || size - sizeof(uint64_t) < TrieView::Decode<uint64_t>(value)) {
+        return nullptr;
+      }
+      return MakeDecodedNode<std::string>(value, std::move(children));
+    default:
+      return nullptr;
+  }
+}
+
+// Lay out the trie under `root` in the snapshot format
+static auto BuildSnapshotImage(const TrieNode *root, TrieLayout layout) -> std::string {
+  // Number the nodes in breadth-first order; the children of a node get consecutive numbers
+  std::vector<const TrieNode *> order;
+  std::vector<size_t> first_child;
+  if (root != nullptr) {
+    order.push_back(root);
+  }
+  for (size_t i = 0; i < order.size(); i++) {
+    first_child.push_back(order.size());
+    for (const auto &[ch, child] : order[i]->children_) {
+      order.push_back(child.get());
+    }
+  }
+
+  // Place the records
+  const size_t header_size = SnapshotFormat::Align(sizeof(SnapshotFormat::Header));
+  std::vector<uint64_t> offsets(order.size());
+  std::vector<uint64_t> value_offsets(order.size());
+  size_t size = header_size;
+  for (size_t i = 0; i < order.size(); i++) {
+    const TrieNode &node = *order[i];
+    offsets[i] = size;
+    size += sizeof(SnapshotFormat::Node) + SnapshotFormat::Align(node.children_.size()) +
+            node.children_.size() * sizeof(uint64_t);
+    size = SnapshotFormat::Align(size + node.segment_.size());
+    auto [type, value_size] = SnapshotFormat::ValueInfo(node);
+    if (type != 0) {
+      value_offsets[i] = size;
+      size = SnapshotFormat::Align(size + value_size);
+    }
+  }
+
+  std::string image(size, '\0');
+  auto *base = reinterpret_cast<std::byte *>(image.data());
+
+  SnapshotFormat::Header header{};
+  std::memcpy(header.magic_, SnapshotFormat::kMagic, sizeof(header.magic_));
+  header.version_ = SnapshotFormat::kVersion;
+  header.layout_ = static_cast<uint8_t>(layout);
+  header.node_count_ = order.size();
+  header.root_offset_ = order.empty() ? 0 : offsets[0];
+  header.file_size_ = size;
+  std::memcpy(base, &header, sizeof(header));
+
+  for (size_t i = 0; i < order.size(); i++) {
+    const TrieNode &node = *order[i];
+    auto *record = reinterpret_cast<SnapshotFormat::Node *>(base + offsets[i]);
+    record->value_offset_ = value_offsets[i];
+    record->score_ = node.Score();
+    record->segment_size_ = static_cast<uint32_t>(node.segment_.size());
+    record->child_count_ = static_cast<uint16_t>(node.children_.size());
+    record->value_type_ = SnapshotFormat::ValueInfo(node).first;
+
+    auto *keys = const_cast<char *>(SnapshotFormat::Keys(record));
+    auto *children = const_cast<uint64_t *>(SnapshotFormat::Children(record));
+    size_t slot = 0;
+    for (const auto &[ch, child] : node.children_) {
+      keys[slot] = ch;
+      children[slot] = offsets[first_child[i] + slot];
+      slot++;
+    }
+    std::memcpy(const_cast<char *>(SnapshotFormat::Segment(record).data()), node.segment_.data(),
+                node.segment_.size());
+    if (record->value_type_ != 0) {
+      SnapshotFormat::EncodeValue(node, base + value_offsets[i]);
+    }
+  }
+  return image;
+}
+
+void Trie::Serialize(const std::string &path) const {
+  std::string image = BuildSnapshotImage(root_.get(), layout_);
+
+  // Replace `path` atomically, so that a reader never maps a half-written snapshot, and durably
+  WriteFileDurably(path, image, "Trie::Serialize");
+}
+
+TrieView::TrieView(const std::string &path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("TrieView: cannot open " + path);
+  }
+  struct stat st {};
+  if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotFormat::Header)) {
+    ::close(fd);
+    throw std::runtime_error("TrieView: not a trie snapshot: " + path);
+  }
+  size_t size = st.st_size;
+  void *data = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error("TrieView: cannot map " + path);
+  }
+  data_ = static_cast<const std::byte *>(data);
+  size_ = size;
+
+  const auto *header = GetHeader();
+  if (std::memcmp(header->magic_, SnapshotFormat::kMagic, sizeof(header->magic_)) != 0 ||
+      header->version_ != SnapshotFormat::kVersion) {
+    ::munmap(data, size);
+    data_ = nullptr;
+    throw std::runtime_error("TrieView: not a trie snapshot: " + path);
+  }
+  if (!HasValidHeader()) {
+    ::munmap(data, size);
+    data_ = nullptr;
+    throw std::runtime_error("TrieView: truncated or corrupt trie snapshot: " + path);
+  }
+}
+
+auto TrieView::HasValidHeader() const -> bool {
+  const auto *header = GetHeader();
+  const size_t header_size = SnapshotFormat::Align(sizeof(SnapshotFormat::Header));
+  if (header->file_size_ != size_ || size_ % 8 != 0 || size_ < header_size ||
+      header->layout_ > static_cast<uint8_t>(TrieLayout::kPathCompressed)) {
+    return false;
+  }
+  if (header->node_count_ == 0) {
+    return header->root_offset_ == 0 && size_ == header_size;
+  }
+  return header->root_offset_ == header_size &&
+         header->node_count_ <= (size_ - header_size) / sizeof(SnapshotFormat::Node) &&
+         CheckRecord(data_, size_, header->root_offset_) != nullptr;
+}
+
+auto TrieView::Verify() const -> bool {
+  if (!HasValidHeader()) {
+    return false;
+  }
+  const auto *header = GetHeader();
+  const size_t header_size = SnapshotFormat::Align(sizeof(SnapshotFormat::Header));
+
+  // The records follow each other as `BuildSnapshotImage` places them, each one sized by its own fields. Every
+  // subtraction below is of a smaller offset from a larger one.
+  std::vector<uint64_t> offsets;
+  offsets.reserve(header->node_count_);
+  uint64_t offset = header_size;
+  for (uint64_t i = 0; i < header->node_count_; i++) {
+    if (size_ - offset < sizeof(SnapshotFormat::Node)) {
+      return false;
+    }
+    offsets.push_back(offset);
+    const auto *node = NodeAt(offset);
+    uint64_t end = offset + sizeof(SnapshotFormat::Node);
+    uint64_t body = SnapshotFormat::Align(node->child_count_) + node->child_count_ * sizeof(uint64_t) +
+                    static_cast<uint64_t>(node->segment_size_);
+    if (size_ - end < body) {
+      return false;
+    }
+    end = SnapshotFormat::Align(end + body);
+
+    if (node->value_type_ == 0) {
+      if (node->value_offset_ != 0) {
+        return false;
+      }
+    } else {
+      if (node->value_offset_ != end || end > size_) {
+        return false;
+      }
+      uint64_t available = size_ - end;
+      uint64_t value_size;
+      switch (node->value_type_) {
+        case SnapshotValue<uint32_t>::kTypeId:
+          value_size = sizeof(uint32_t);
+          break;
+        case SnapshotValue<uint64_t>::kTypeId:
+          value_size = sizeof(uint64_t);
+          break;
+        case SnapshotValue<std::string>::kTypeId:
+          if (available < sizeof(uint64_t) ||
+              available - sizeof(uint64_t) < Decode<uint64_t>(data_ + end)) {
+            return false;
+          }
+          value_size = sizeof(uint64_t) + Decode<uint64_t>(data_ + end);
+          break;
+        default:
+          return false;
+      }
+      if (available < value_size) {
+        return false;
+      }
+      end = SnapshotFormat::Align(end + value_size);
+    }
+    if (end > size_) {
+      return false;
+    }
+    offset = end;
+  }
+  if (offset != size_) {
+    return false;
+  }
+
+  // Children are later records, so walking down always ends, and their keys are sorted for `FindKeySlot`
+  for (uint64_t parent : offsets) {
+    const auto *node = NodeAt(parent);
+    const char *keys = SnapshotFormat::Keys(node);
+    const uint64_t *children = SnapshotFormat::Children(node);
+    for (uint16_t c = 0; c < node->child_count_; c++) {
+      if (children[c] <= parent || !std::binary_search(offsets.begin(), offsets.end(), children[c])) {
+        return false;
+      }
+      if (c > 0 && static_cast<unsigned char>(keys[c - 1]) >= static_cast<unsigned char>(keys[c])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+auto TrieView::operator=(TrieView &&that) noexcept -> TrieView & {
+  if (this != &that) {
+    if (data_ != nullptr) {
+      ::munmap(const_cast<std::byte *>(data_), size_);
+    }
+    data_ = std::exchange(that.data_, nullptr);
+    size_ = std::exchange(that.size_, 0);
+  }
+  return *this;
+}
+
+TrieView::~TrieView() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<std::byte *>(data_), size_);
+  }
+}
+
+auto TrieView::FindNode(std::string_view key) const -> const SnapshotFormat::Node * {
+  uint64_t root = GetHeader()->root_offset_;
+  if (root == 0) {
+    return nullptr;
+  }
+
+  const SnapshotFormat::Node *node = NodeAt(root);
+  size_t pos = 0;
+  while (pos < key.size()) {
+    int slot = FindKeySlot(SnapshotFormat::Keys(node), node->child_count_, key[pos]);
+    if (slot < 0) {
+      return nullptr;
+    }
+    node = ChildRecord(data_, size_, node, slot);
+    pos++;
+
+    std::string_view segment = SnapshotFormat::Segment(node);
+    if (!segment.empty()) {
+      if (key.compare(pos, segment.size(), segment) != 0) {
+        return nullptr;
+      }
+      pos += segment.size();
+    }
+  }
+  return node;
+}
+
+auto TrieView::ScanCursor(uint8_t value_type, std::string_view prefix) const -> TrieViewCursor {
+  TrieViewCursor cursor(data_, size_, value_type);
+  uint64_t root = GetHeader()->root_offset_;
+  if (root == 0) {
+    return cursor;
+  }
+
+  // Walk down to the node whose subtree holds exactly the keys starting with `prefix`
+  const SnapshotFormat::Node *node = NodeAt(root);
+  size_t pos = 0;
+  while (pos < prefix.size()) {
+    int slot = FindKeySlot(SnapshotFormat::Keys(node), node->child_count_, prefix[pos]);
+    if (slot < 0) {
+      return TrieViewCursor();
+    }
+    const SnapshotFormat::Node *child = ChildRecord(data_, size_, node, slot);
+    std::string_view segment = SnapshotFormat::Segment(child);
+    std::string_view rest = prefix.substr(pos + 1);
+    size_t overlap = std::min(segment.size(), rest.size());
+    if (segment.substr(0, overlap) != rest.substr(0, overlap)) {
+      return TrieViewCursor();
+    }
+    cursor.key_.push_back(prefix[pos]);
+    cursor.key_.append(segment);
+    pos += 1 + segment.size();
+    node = child;
+  }
+  cursor.Enter(node);
+  return cursor;
+}
+
+void TrieViewCursor::Enter(const SnapshotFormat::Node *node) {
+  stack_.push_back({node, 0, key_.size()});
+  if (node->value_type_ != value_type_) {
+    Advance();
+  }
+}
+
+void TrieViewCursor::Advance() {
+  while (!stack_.empty()) {
+    Frame &top = stack_.back();
+    if (top.next_ == top.node_->child_count_) {
+      stack_.pop_back();
+      continue;
+    }
+    uint16_t slot = top.next_++;
+    const SnapshotFormat::Node *child = ChildRecord(base_, size_, top.node_, slot);
+    key_.resize(top.key_size_);
+    key_.push_back(SnapshotFormat::Keys(top.node_)[slot]);
+    key_.append(SnapshotFormat::Segment(child));
+    stack_.push_back({child, 0, key_.size()});
+    if (child->value_type_ == value_type_) {
+      return;
+    }
+  }
+}
+
+}  // namespace bustub
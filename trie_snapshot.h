@@ -0,0 +1,267 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_snapshot.h
+//
+// Identification: src/include/primer/trie_snapshot.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+// The value types a snapshot file can hold, and what `TrieView` returns for them. Integers are returned by value,
+// strings as views into the mapped file.
+template <class T>
+struct SnapshotValue;
+
+template <>
+struct SnapshotValue<uint32_t> {
+  static constexpr uint8_t kTypeId = 1;
+  using View = uint32_t;
+};
+
+template <>
+struct SnapshotValue<uint64_t> {
+  static constexpr uint8_t kTypeId = 2;
+  using View = uint64_t;
+};
+
+template <>
+struct SnapshotValue<std::string> {
+  static constexpr uint8_t kTypeId = 3;
+  using View = std::string_view;
+};
+
+// The on-disk layout written by `Trie::Serialize` and read by `TrieView`. The file is a header followed by node
+// records; every reference is a byte offset from the start of the file, so the file can be mapped at any address
+// and read in place. Records are 8-byte aligned and stored in breadth-first order, which keeps the upper levels of
+// the trie, visited by every lookup, together in the first pages. Integers are stored in native byte order.
+struct SnapshotFormat {
+  static constexpr char kMagic[8] = {'B', 'T', 'S', 'N', 'A', 'P', '0', '1'};
+  static constexpr uint32_t kVersion = 1;
+
+  struct Header {
+    char magic_[8];
+    uint32_t version_;
+    uint8_t layout_;
+    uint8_t reserved_[3];
+    uint64_t node_count_;
+    // Offset of the root record, 0 for an empty trie.
+    uint64_t root_offset_;
+    uint64_t file_size_;
+  };
+
+  // A node record is followed by its child keys (sorted as unsigned bytes, padded to 8 bytes), the offsets of its
+  // children, its segment and, at `value_offset_`, its value: a raw integer, or a uint64_t length and the bytes of a
+  // string.
+  struct Node {
+    // Offset of the value, 0 for a node without value.
+    uint64_t value_offset_;
+    uint64_t score_;
+    uint32_t segment_size_;
+    uint16_t child_count_;
+    // `SnapshotValue<T>::kTypeId` of the value, 0 for a node without value.
+    uint8_t value_type_;
+    uint8_t reserved_;
+  };
+
+  static constexpr auto Align(size_t size) -> size_t { return (size + 7) / 8 * 8; }
+
+  static auto Keys(const Node *node) -> const char * { return reinterpret_cast<const char *>(node + 1); }
+  static auto Children(const Node *node) -> const uint64_t * {
+    return reinterpret_cast<const uint64_t *>(Keys(node) + Align(node->child_count_));
+  }
+  static auto Segment(const Node *node) -> std::string_view {
+    return {reinterpret_cast<const char *>(Children(node) + node->child_count_), node->segment_size_};
+  }
+
+  // The `SnapshotValue<T>::kTypeId` and the encoded size of the value of `node`, {0, 0} for a node without value.
+  // Throws std::invalid_argument if the value type cannot be stored.
+  static auto ValueInfo(const TrieNode &node) -> std::pair<uint8_t, size_t>;
+
+  // Encode the value of `node` into `out`, which has room for the size returned by `ValueInfo`.
+  static void EncodeValue(const TrieNode &node, std::byte *out);
+
+  // Create a node with the given children and the value of type `value_type` encoded at `value`, or a node without
+  // value if `value_type` is 0. `size` is the number of bytes available at `value`; returns nullptr if the value
+  // does not fit in them or `value_type` is unknown.
+  static auto DecodeNode(uint8_t value_type, const std::byte *value, size_t size, TrieNode::Children children)
+      -> std::shared_ptr<TrieNode>;
+};
+
+// A forward cursor over the values of one type in a mapped snapshot, in key order. See `TrieCursor`, which it
+// mirrors for in-memory tries.
+class TrieViewCursor {
+ public:
+  TrieViewCursor() = default;
+
+  auto IsEnd() const -> bool { return stack_.empty(); }
+  auto Key() const -> std::string_view { return key_; }
+  auto Node() const -> const SnapshotFormat::Node * { return stack_.back().node_; }
+  auto Base() const -> const std::byte * { return base_; }
+  void Next() { Advance(); }
+
+ private:
+  friend class TrieView;
+
+  struct Frame {
+    const SnapshotFormat::Node *node_;
+    uint16_t next_;
+    size_t key_size_;
+  };
+
+  TrieViewCursor(const std::byte *base, size_t size, uint8_t value_type)
+      : base_(base), size_(size), value_type_(value_type) {}
+
+  void Enter(const SnapshotFormat::Node *node);
+  void Advance();
+
+  const std::byte *base_{nullptr};
+  size_t size_{0};
+  uint8_t value_type_{0};
+  std::vector<Frame> stack_;
+  std::string key_;
+};
+
+template <class T>
+class TrieViewIterator;
+
+template <class T>
+class TrieViewScan;
+
+// A TrieView is a read-only trie backed by a memory-mapped snapshot file. Opening it maps the file and checks only
+// its header and root record, so it takes the same time for any file and reads no other page. Lookups and scans then
+// read the mapped pages directly, without building any node in memory, and bounds-check each record they reach;
+// `Verify` checks the whole file up front instead. Processes that open the same file share one copy of it in the page
+// cache.
+class TrieView {
+ public:
+  // Map the snapshot at `path`. Throws std::runtime_error if the file cannot be mapped, is not a snapshot, its size
+  // does not match its header, or its root record does not fit in it. `Get` and `Scan` throw std::runtime_error when
+  // they reach a record that points outside the file, or a child that does not come after its parent.
+  explicit TrieView(const std::string &path);
+
+  TrieView(TrieView &&that) noexcept
+      : data_(std::exchange(that.data_, nullptr)), size_(std::exchange(that.size_, 0)) {}
+  auto operator=(TrieView &&that) noexcept -> TrieView &;
+  TrieView(const TrieView &) = delete;
+  auto operator=(const TrieView &) -> TrieView & = delete;
+  ~TrieView();
+
+  // Get the value of type T at `key`, or std::nullopt if there is none. A string is returned as a view into the
+  // mapping, valid as long as this TrieView.
+  template <class T>
+  auto Get(std::string_view key) const -> std::optional<typename SnapshotValue<T>::View> {
+    const auto *node = FindNode(key);
+    if (node == nullptr || node->value_type_ != SnapshotValue<T>::kTypeId) {
+      return std::nullopt;
+    }
+    return Decode<T>(data_ + node->value_offset_);
+  }
+
+  // Iterate, in key order, over the values of type T whose keys start with `prefix`.
+  template <class T>
+  auto Scan(std::string_view prefix) const -> TrieViewScan<T> {
+    return TrieViewScan<T>(ScanCursor(SnapshotValue<T>::kTypeId, prefix));
+  }
+
+  // Whether every record of the file is well-formed: within the file, tiling it in the order `Trie::Serialize` writes
+  // them, with children that come after their parent and child keys in order. Takes one pass over the whole file,
+  // e.g. to check a snapshot once after copying it rather than on every open.
+  auto Verify() const -> bool;
+
+  auto GetLayout() const -> TrieLayout { return static_cast<TrieLayout>(GetHeader()->layout_); }
+  auto NodeCount() const -> uint64_t { return GetHeader()->node_count_; }
+
+  template <class T>
+  static auto Decode(const std::byte *value) -> typename SnapshotValue<T>::View {
+    if constexpr (std::is_same_v<T, std::string>) {
+      uint64_t size;
+      std::memcpy(&size, value, sizeof(size));
+      return {reinterpret_cast<const char *>(value + sizeof(size)), size};
+    } else {
+      T result;
+      std::memcpy(&result, value, sizeof(T));
+      return result;
+    }
+  }
+
+ private:
+  auto GetHeader() const -> const SnapshotFormat::Header * {
+    return reinterpret_cast<const SnapshotFormat::Header *>(data_);
+  }
+  auto NodeAt(uint64_t offset) const -> const SnapshotFormat::Node * {
+    return reinterpret_cast<const SnapshotFormat::Node *>(data_ + offset);
+  }
+
+  // Whether the header agrees with the size of the mapped file, and the root record fits in it.
+  auto HasValidHeader() const -> bool;
+
+  // The record of the node at `key`, or nullptr.
+  auto FindNode(std::string_view key) const -> const SnapshotFormat::Node *;
+
+  auto ScanCursor(uint8_t value_type, std::string_view prefix) const -> TrieViewCursor;
+
+  const std::byte *data_{nullptr};
+  size_t size_{0};
+};
+
+template <class T>
+class TrieViewIterator {
+ public:
+  using iterator_category = std::input_iterator_tag;
+  using difference_type = std::ptrdiff_t;
+  using value_type = std::pair<std::string_view, typename SnapshotValue<T>::View>;
+
+  explicit TrieViewIterator(TrieViewCursor cursor) : cursor_(std::move(cursor)) {}
+
+  auto IsEnd() const -> bool { return cursor_.IsEnd(); }
+  auto Key() const -> std::string_view { return cursor_.Key(); }
+  auto Value() const -> typename SnapshotValue<T>::View {
+    return TrieView::Decode<T>(cursor_.Base() + cursor_.Node()->value_offset_);
+  }
+
+  auto operator*() const -> value_type { return {Key(), Value()}; }
+  auto operator++() -> TrieViewIterator & {
+    cursor_.Next();
+    return *this;
+  }
+  void operator++(int) { cursor_.Next(); }
+
+  auto operator==(std::default_sentinel_t /*unused*/) const -> bool { return IsEnd(); }
+
+ private:
+  TrieViewCursor cursor_;
+};
+
+template <class T>
+class TrieViewScan {
+ public:
+  explicit TrieViewScan(TrieViewCursor cursor) : cursor_(std::move(cursor)) {}
+
+  auto begin() const -> TrieViewIterator<T> { return TrieViewIterator<T>(cursor_); }  // NOLINT
+  auto end() const -> std::default_sentinel_t { return std::default_sentinel; }     // NOLINT
+
+ private:
+  TrieViewCursor cursor_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,206 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_snapshot_test.cpp
+//
+// Identification: test/primer/trie_snapshot_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "trie_iterator.h"
+#include "trie_snapshot.h"
+
+namespace bustub {
+
+namespace {
+
+auto SnapshotPath(const std::string &name) -> std::string {
+  return (std::filesystem::temp_directory_path() / ("trie_snapshot_test_" + name)).string();
+}
+
+auto ReadFile(const std::string &path) -> std::string {
+  std::ifstream in(path, std::ios::binary);
+  return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+void WriteFile(const std::string &path, const std::string &data) {
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(data.data(), static_cast<std::streamsize>(data.size()));
+}
+
+// Whether `data`, written to `path`, opens as a TrieView; if it does, it must be readable in full.
+auto OpensAndReads(const std::string &path, const std::string &data) -> bool {
+  WriteFile(path, data);
+  try {
+    auto view = TrieView(path);
+    size_t values = 0;
+    for (const auto &entry : view.Scan<std::string>("")) {
+      values += entry.second.size();
+    }
+    for (const auto &entry : view.Scan<uint32_t>("")) {
+      values += view.Get<uint32_t>(entry.first).has_value() ? 1 : 0;
+    }
+    return values > 0;
+  } catch (const std::runtime_error &) {
+    return false;
+  }
+}
+
+}  // namespace
+
+TEST(TrieSnapshotTest, GetTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      trie = trie.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    trie = trie.Put<uint64_t>("", 233);
+    trie = trie.Put<std::string>("key/", "directory");
+    trie = trie.Put<std::string>("key/1000000", std::string(100, 'x'));
+
+    auto path = SnapshotPath("get");
+    trie.Serialize(path);
+    auto view = TrieView(path);
+    ASSERT_TRUE(view.GetLayout() == layout);
+
+    for (uint32_t i = 0; i < 1000; i++) {
+      ASSERT_EQ(*view.Get<uint32_t>("key/" + std::to_string(i)), i);
+    }
+    ASSERT_EQ(*view.Get<uint64_t>(""), 233);
+    ASSERT_EQ(*view.Get<std::string>("key/"), "directory");
+    ASSERT_EQ(*view.Get<std::string>("key/1000000"), std::string(100, 'x'));
+    ASSERT_TRUE(!view.Get<uint32_t>("key/").has_value());
+    ASSERT_TRUE(!view.Get<uint32_t>("key/1000").has_value());
+    ASSERT_TRUE(!view.Get<uint32_t>("key").has_value());
+    ASSERT_TRUE(!view.Get<uint32_t>("missing").has_value());
+    ASSERT_TRUE(!view.Get<std::string>("key/1").has_value());
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(TrieSnapshotTest, ScanTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 500; i++) {
+      trie = trie.Put<uint32_t>("tenant/" + std::to_string(i % 7) + "/metric/" + std::to_string(i), i);
+    }
+    trie = trie.Put<std::string>("tenant/3/name", "skipped");
+    auto path = SnapshotPath("scan");
+    trie.Serialize(path);
+    auto view = TrieView(path);
+
+    for (const char *prefix : {"", "tenant/", "tenant/3", "tenant/3/met", "tenant/8", "tenant/3/metric/10"}) {
+      std::vector<std::pair<std::string, uint32_t>> expected;
+      for (const auto &[key, value] : trie.Scan<uint32_t>(prefix)) {
+        expected.emplace_back(key, value);
+      }
+      std::vector<std::pair<std::string, uint32_t>> mapped;
+      for (const auto &[key, value] : view.Scan<uint32_t>(prefix)) {
+        mapped.emplace_back(key, value);
+      }
+      ASSERT_TRUE(mapped == expected);
+    }
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(TrieSnapshotTest, EdgeCaseTest) {
+  auto path = SnapshotPath("edge");
+  Trie().Serialize(path);
+  {
+    auto view = TrieView(path);
+    ASSERT_EQ(view.NodeCount(), 0);
+    ASSERT_TRUE(!view.Get<uint32_t>("").has_value());
+    ASSERT_TRUE(view.Scan<uint32_t>("").begin().IsEnd());
+  }
+
+  // Only plain values can be written.
+  bool thrown = false;
+  try {
+    Trie().Put<std::unique_ptr<uint32_t>>("a", std::make_unique<uint32_t>(1)).Serialize(path);
+  } catch (const std::invalid_argument &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "this is not a snapshot, but it is long enough for a header";
+  }
+  thrown = false;
+  try {
+    auto view = TrieView(path);
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+  std::filesystem::remove(path);
+}
+
+TEST(TrieSnapshotTest, CorruptTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 20; i++) {
+      trie = trie.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    trie = trie.Put<std::string>("key/name", "a string value");
+    auto path = SnapshotPath("corrupt");
+    trie.Serialize(path);
+    const std::string image = ReadFile(path);
+    ASSERT_TRUE(OpensAndReads(path, image));
+    ASSERT_TRUE(TrieView(path).Verify());
+
+    // A truncated file, with or without a header that agrees with its size
+    for (size_t size : {image.size() - 8, image.size() / 2, sizeof(SnapshotFormat::Header)}) {
+      std::string truncated = image.substr(0, size);
+      ASSERT_TRUE(!OpensAndReads(path, truncated));
+      uint64_t file_size = size;
+      std::memcpy(truncated.data() + offsetof(SnapshotFormat::Header, file_size_), &file_size, sizeof(file_size));
+      ASSERT_TRUE(!OpensAndReads(path, truncated));
+    }
+
+    // Offsets and lengths pointing outside the file
+    SnapshotFormat::Header header;
+    std::memcpy(&header, image.data(), sizeof(header));
+    for (size_t field : {offsetof(SnapshotFormat::Node, value_offset_), offsetof(SnapshotFormat::Node, segment_size_),
+                         offsetof(SnapshotFormat::Node, child_count_)}) {
+      std::string corrupt = image;
+      corrupt[header.root_offset_ + field + 1] = '\x7f';
+      ASSERT_TRUE(!OpensAndReads(path, corrupt));
+    }
+    std::string corrupt = image;
+    uint64_t root_offset = image.size() + 64;
+    std::memcpy(corrupt.data() + offsetof(SnapshotFormat::Header, root_offset_), &root_offset, sizeof(root_offset));
+    ASSERT_TRUE(!OpensAndReads(path, corrupt));
+
+    // Opening only checks the header and the root record: a wrong record count is caught by `Verify` alone
+    corrupt = image;
+    uint64_t node_count = header.node_count_ - 1;
+    std::memcpy(corrupt.data() + offsetof(SnapshotFormat::Header, node_count_), &node_count, sizeof(node_count));
+    ASSERT_TRUE(OpensAndReads(path, corrupt));
+    ASSERT_TRUE(!TrieView(path).Verify());
+
+    // Any single corrupted byte is either rejected when opened or read, or leaves a file that reads within its bounds
+    for (size_t i = 0; i < image.size(); i++) {
+      corrupt = image;
+      corrupt[i] = static_cast<char>(corrupt[i] ^ 0xa5);
+      OpensAndReads(path, corrupt);
+    }
+    std::filesystem::remove(path);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,81 @@
+#include "trie_stats.h"
+
+#include <unordered_set>
+#include <utility>
+
+namespace bustub {
+
+// Bytes of `node` itself, its children's block and its value.
+static auto TotalNodeBytes(const TrieNode &node) -> size_t {
+  return node.NodeBytes() + node.children_.HeapBytes() + node.ValueBytes();
+}
+
+auto Trie::Stats() const -> TrieStats {
+  TrieStats stats;
+  if (root_ == nullptr) {
+    return stats;
+  }
+  // Walk with an explicit stack: a per-character trie is as deep as its longest key
+  std::vector<std::pair<const TrieNode *, size_t>> stack{{root_.get(), 0}};
+  while (!stack.empty()) {
+    auto [node, depth] = stack.back();
+    stack.pop_back();
+
+    stats.nodes_++;
+    stats.value_nodes_ += node->is_value_node_ ? 1 : 0;
+    if (stats.depth_histogram_.size() <= depth) {
+      stats.depth_histogram_.resize(depth + 1);
+    }
+    stats.depth_histogram_[depth]++;
+    if (stats.fanout_histogram_.size() <= node->children_.size()) {
+      stats.fanout_histogram_.resize(node->children_.size() + 1);
+    }
+    stats.fanout_histogram_[node->children_.size()]++;
+    stats.node_bytes_ += node->NodeBytes();
+    stats.child_bytes_ += node->children_.HeapBytes();
+    stats.value_bytes_ += node->ValueBytes();
+
+    for (const auto &[ch, child] : node->children_) {
+      stack.emplace_back(child.get(), depth + 1);
+    }
+  }
+  return stats;
+}
+
+auto Trie::SharedWith(const Trie &other) const -> TrieSharing {
+  TrieSharing sharing;
+  if (root_ == nullptr || other.root_ == nullptr) {
+    return sharing;
+  }
+
+  // Every node of `other`, by id. Ids are unique to a node, and nodes are immutable, so an id found in both tries
+  // names the same subtree in both.
+  std::unordered_set<uint64_t> theirs;
+  std::vector<const TrieNode *> stack{other.root_.get()};
+  while (!stack.empty()) {
+    const TrieNode *node = stack.back();
+    stack.pop_back();
+    theirs.insert(node->id_);
+    for (const auto &[ch, child] : node->children_) {
+      stack.push_back(child.get());
+    }
+  }
+
+  // The flag says whether an ancestor is shared, which makes the node shared without a lookup
+  std::vector<std::pair<const TrieNode *, bool>> walk{{root_.get(), false}};
+  while (!walk.empty()) {
+    auto [node, shared] = walk.back();
+    walk.pop_back();
+    shared = shared || theirs.count(node->id_) != 0;
+    if (shared) {
+      sharing.nodes_++;
+      sharing.bytes_ += TotalNodeBytes(*node);
+    }
+    for (const auto &[ch, child] : node->children_) {
+      walk.emplace_back(child.get(), shared);
+    }
+  }
+  return sharing;
+}
+
+}  // namespace bustub
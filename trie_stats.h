@@ -0,0 +1,51 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_stats.h
+//
+// Identification: src/include/primer/trie_stats.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "trie.h"
+
+namespace bustub {
+
+// The shape of a trie and the memory it takes, as returned by `Trie::Stats`. Byte counts are what the nodes, their
+// child blocks and their values take in memory, without allocator or reference count overhead.
+struct TrieStats {
+  size_t nodes_{0};
+  size_t value_nodes_{0};
+
+  // depth_histogram_[d] is the number of nodes d edges below the root. In a path-compressed trie an edge may stand
+  // for many key bytes.
+  std::vector<size_t> depth_histogram_;
+
+  // fanout_histogram_[n] is the number of nodes with n children. Many nodes with a single child, and no value, is
+  // the sign of a per-character layout that path compression would collapse.
+  std::vector<size_t> fanout_histogram_;
+
+  size_t node_bytes_{0};
+  size_t child_bytes_{0};
+  size_t value_bytes_{0};
+
+  auto TotalBytes() const -> size_t { return node_bytes_ + child_bytes_ + value_bytes_; }
+};
+
+// The nodes two tries share, as returned by `Trie::SharedWith`. A node is immutable, so a shared node means its whole
+// subtree is shared.
+struct TrieSharing {
+  size_t nodes_{0};
+  // The bytes of the shared nodes, counted as in `TrieStats::TotalBytes`.
+  size_t bytes_{0};
+};
+
+}  // namespace bustub
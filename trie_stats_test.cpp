@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_stats_test.cpp
+//
+// Identification: test/primer/trie_stats_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "trie_stats.h"
+
+namespace bustub {
+
+TEST(TrieStatsTest, StatsTest) {
+  ASSERT_EQ(Trie().Stats().nodes_, 0);
+
+  auto trie = Trie(TrieLayout::kPerCharacter);
+  trie = trie.Put<uint32_t>("a", 1).Put<uint32_t>("ab", 2).Put<uint32_t>("abc", 3).Put<uint32_t>("b", 4);
+  auto stats = trie.Stats();
+  ASSERT_EQ(stats.nodes_, 5);
+  ASSERT_EQ(stats.value_nodes_, 4);
+  ASSERT_TRUE(stats.depth_histogram_ == std::vector<size_t>({1, 2, 1, 1}));
+  ASSERT_TRUE(stats.fanout_histogram_ == std::vector<size_t>({2, 2, 1}));
+  ASSERT_EQ(stats.node_bytes_, sizeof(TrieNode) + 4 * sizeof(TrieNodeWithValue<uint32_t>));
+  // uint32_t values are inlined, so they are part of the node bytes
+  ASSERT_EQ(stats.value_bytes_, 0);
+  // Only the root has more than one child, and so a heap block for them
+  ASSERT_EQ(stats.child_bytes_, trie.GetRoot()->children_.HeapBytes());
+  ASSERT_TRUE(stats.child_bytes_ > 0);
+  ASSERT_EQ(stats.TotalBytes(), stats.node_bytes_ + stats.child_bytes_ + stats.value_bytes_);
+
+  // Long string values are counted with their heap bytes
+  std::string long_value(1000, 'x');
+  auto with_string = trie.Put<std::string>("c", long_value);
+  ASSERT_TRUE(with_string.Stats().value_bytes_ > stats.value_bytes_ + long_value.size());
+
+  // Path compression collapses the single-child chains the per-character layout builds for long keys
+  std::string long_key(100, 'k');
+  auto flat = Trie(TrieLayout::kPerCharacter).Put<uint32_t>(long_key + "1", 1).Put<uint32_t>(long_key + "2", 2);
+  auto compressed =
+      Trie(TrieLayout::kPathCompressed).Put<uint32_t>(long_key + "1", 1).Put<uint32_t>(long_key + "2", 2);
+  ASSERT_EQ(flat.Stats().nodes_, 103);
+  ASSERT_EQ(flat.Stats().fanout_histogram_[1], 100);
+  ASSERT_EQ(compressed.Stats().nodes_, 4);
+  ASSERT_TRUE(compressed.Stats().TotalBytes() < flat.Stats().TotalBytes());
+}
+
+TEST(TrieStatsTest, SharedWithTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = Trie(layout);
+    for (uint32_t i = 0; i < 1000; i++) {
+      trie = trie.Put<uint32_t>("key/" + std::to_string(i), i);
+    }
+    auto stats = trie.Stats();
+    auto self = trie.SharedWith(trie);
+    ASSERT_EQ(self.nodes_, stats.nodes_);
+    ASSERT_EQ(self.bytes_, stats.TotalBytes());
+    ASSERT_EQ(trie.SharedWith(Trie(layout)).nodes_, 0);
+
+    // Overwriting a key copies the path to it and shares everything else
+    auto next = trie.Put<uint32_t>("key/500", 0);
+    size_t path = layout == TrieLayout::kPerCharacter ? 8 : 5;
+    ASSERT_EQ(next.Stats().nodes_, stats.nodes_);
+    ASSERT_EQ(next.SharedWith(trie).nodes_, stats.nodes_ - path);
+    ASSERT_EQ(trie.SharedWith(next).nodes_, stats.nodes_ - path);
+    ASSERT_TRUE(next.SharedWith(trie).bytes_ < stats.TotalBytes());
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,321 @@
+#include "trie_store.h"
+
+#include "string_arena.h"
+
+namespace bustub {
+
+void AsyncWrite::Wait() {
+  std::unique_lock<std::mutex> lock(state_->latch_);
+  state_->done_cv_.wait(lock, [&] { return state_->done_; });
+  if (state_->error_) {
+    std::rethrow_exception(state_->error_);
+  }
+}
+
+auto AsyncWrite::await_ready() const -> bool {
+  std::scoped_lock lock(state_->latch_);
+  return state_->done_;
+}
+
+auto AsyncWrite::await_suspend(std::coroutine_handle<> waiter) -> bool {
+  std::scoped_lock lock(state_->latch_);
+  if (state_->done_) {
+    return false;
+  }
+  state_->waiter_ = waiter;
+  return true;
+}
+
+void AsyncWrite::await_resume() {
+  if (state_->error_) {
+    std::rethrow_exception(state_->error_);
+  }
+}
+
+TrieStore::~TrieStore() {
+  std::unique_lock<std::mutex> lock(async_latch_);
+  async_done_.wait(lock, [&] { return async_writes_ == 0; });
+  delete current_.load(std::memory_order_relaxed);
+}
+
+template <class T>
+auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<T>> {
+  // The pin is published before this load, so the snapshot we see cannot be reclaimed until the pin is released.
+  auto pin = epoch_.Pin();
+  const Trie *root = current_.load(std::memory_order_seq_cst);
+  const T *value = root->Get<T>(key);
+  if (value == nullptr) {
+    return std::nullopt;
+  }
+  return ValueGuard<T>(std::move(pin), *value);
+}
+
+template <class T>
+auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<T> {
+  auto pin = epoch_.Pin();
+  const Trie *root = current_.load(std::memory_order_seq_cst);
+  return MultiValueGuard<T>(std::move(pin), root->MultiGet<T>(keys));
+}
+
+template <class Write>
+void TrieStore::Commit(Write write) {
+  if (mode_ == CommitMode::kLocked) {
+    std::unique_lock<std::mutex> guard(write_lock_, std::try_to_lock);
+    if (!guard.owns_lock()) {
+      contended_.fetch_add(1, std::memory_order_relaxed);
+      guard.lock();
+    }
+    // Only writers replace the snapshot, and we hold the write lock, so it cannot change under us.
+    const Trie *old = current_.load(std::memory_order_relaxed);
+    const Trie *next = new const Trie(write(*old));
+    // Readers that load the new snapshot after this store no longer see the old one, which is retired in a later epoch
+    current_.store(next, std::memory_order_seq_cst);
+    Retire(old);
+    commits_.fetch_add(1, std::memory_order_relaxed);
+    if (has_subscribers_.load(std::memory_order_seq_cst)) {
+      // Queued under the write lock, so that every commit is queued on its own and in order, but delivered after it
+      // is released, so that a callback may write
+      Enqueue(next);
+      guard.unlock();
+      Notify();
+    }
+    return;
+  }
+
+  // Our pin keeps every snapshot we build on alive, including the ones that other writers replace under us
+  auto pin = epoch_.Pin();
+  const Trie *old = current_.load(std::memory_order_seq_cst);
+  bool contended = false;
+  while (true) {
+    auto next = std::make_unique<const Trie>(write(*old));
+    // On failure, `old` is updated to the snapshot that won, and the write is redone on top of it
+    if (current_.compare_exchange_strong(old, next.get(), std::memory_order_seq_cst)) {
+      next.release();
+      break;
+    }
+    contended = true;
+    retries_.fetch_add(1, std::memory_order_relaxed);
+  }
+  Retire(old);
+  if (contended) {
+    contended_.fetch_add(1, std::memory_order_relaxed);
+  }
+  commits_.fetch_add(1, std::memory_order_relaxed);
+  if (has_subscribers_.load(std::memory_order_seq_cst)) {
+    Enqueue(nullptr);
+    Notify();
+  }
+}
+
+template <class T>
+void TrieStore::Put(std::string_view key, T value) {
+  // Move the value into its leaf before committing: a slow move (e.g. a `MoveBlocked`) then happens without the write
+  // lock, and an optimistic retry reuses the leaf instead of the (possibly move-only) value
+  WriteBatch batch(pool_);
+  batch.Put<T>(key, std::move(value));
+  if (mode_ == CommitMode::kLocked) {
+    Commit([&](const Trie &root) { return root.Apply(std::move(batch)); });
+    return;
+  }
+  Commit([&](const Trie &root) { return root.Apply(batch); });
+}
+
+void TrieStore::Remove(std::string_view key) {
+  Commit([&](const Trie &root) { return root.Remove(key); });
+}
+
+void TrieStore::Apply(WriteBatch batch) {
+  if (mode_ == CommitMode::kLocked) {
+    Commit([&](const Trie &root) { return root.Apply(std::move(batch)); });
+    return;
+  }
+  Commit([&](const Trie &root) { return root.Apply(batch); });
+}
+
+void TrieStore::Publish(WriteBatch batch) {
+  if (mode_ == CommitMode::kOptimistic) {
+    Commit([&](const Trie &root) { return root.Apply(batch); });
+    return;
+  }
+
+  // Build on the current snapshot without the lock; our pin keeps it alive if another writer replaces it meanwhile
+  auto pin = epoch_.Pin();
+  const Trie *base = current_.load(std::memory_order_seq_cst);
+  Trie next = base->Apply(batch);
+  bool rebuilt = false;
+  Commit([&](const Trie &root) {
+    if (&root == base) {
+      return std::move(next);
+    }
+    rebuilt = true;
+    return root.Apply(std::move(batch));
+  });
+  if (rebuilt) {
+    retries_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+auto TrieStore::StartAsync(std::function<void()> write) -> AsyncWrite {
+  auto state = std::make_shared<AsyncWrite::State>();
+  auto run = [this, state, write = std::move(write)] {
+    std::exception_ptr error;
+    try {
+      write();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    // The store may be destroyed as soon as the count drops, so it goes last, after which only `state` is touched
+    {
+      std::scoped_lock lock(async_latch_);
+      async_writes_--;
+      async_done_.notify_all();
+    }
+    std::coroutine_handle<> waiter;
+    {
+      std::scoped_lock lock(state->latch_);
+      state->done_ = true;
+      state->error_ = error;
+      waiter = std::exchange(state->waiter_, nullptr);
+    }
+    state->done_cv_.notify_all();
+    if (waiter) {
+      waiter.resume();
+    }
+  };
+
+  std::scoped_lock lock(async_latch_);
+  if (async_pool_ == nullptr) {
+    async_pool_ = std::make_unique<ThreadPool>(kAsyncWorkers);
+  }
+  // Counted before it is queued, since a worker may run it at once. If it cannot be queued, nothing will ever count
+  // it down, and the destructor would wait forever.
+  async_writes_++;
+  try {
+    async_pool_->Submit(std::move(run));
+  } catch (...) {
+    async_writes_--;
+    throw;
+  }
+  return AsyncWrite(std::move(state));
+}
+
+auto TrieStore::Snapshot() const -> Trie {
+  auto pin = epoch_.Pin();
+  return *current_.load(std::memory_order_seq_cst);
+}
+
+auto TrieStore::Subscribe(std::function<void(const TrieDiff &)> callback) -> uint64_t {
+  std::scoped_lock lock(subscribers_latch_);
+  // Set before reading the snapshot: a write that misses the flag published before the read, so the subscriber
+  // starts from its version or a newer one
+  has_subscribers_.store(true, std::memory_order_seq_cst);
+  uint64_t id = next_subscriber_++;
+  {
+    // Versions queued up to now are no newer than the snapshot read here, and are skipped for this subscriber
+    std::scoped_lock delivery(delivery_latch_);
+    subscribers_.push_back({id, std::move(callback), Snapshot(), sequence_});
+  }
+  return id;
+}
+
+void TrieStore::Unsubscribe(uint64_t id) {
+  std::scoped_lock lock(subscribers_latch_);
+  std::erase_if(subscribers_, [&](const Subscriber &subscriber) { return subscriber.id_ == id; });
+  has_subscribers_.store(!subscribers_.empty(), std::memory_order_seq_cst);
+}
+
+void TrieStore::Enqueue(const Trie *version) {
+  std::scoped_lock lock(delivery_latch_);
+  pending_.push_back({++sequence_, version != nullptr ? *version : Snapshot()});
+}
+
+void TrieStore::Notify() {
+  std::unique_lock<std::mutex> lock(delivery_latch_);
+  if (delivering_) {
+    // That thread checks the queue again before it stops, so it delivers our version too
+    return;
+  }
+  delivering_ = true;
+  while (!pending_.empty()) {
+    PendingVersion next = std::move(pending_.front());
+    pending_.pop_front();
+    lock.unlock();
+    try {
+      Deliver(next.sequence_, next.version_);
+    } catch (...) {
+      // The versions still queued are delivered by the next write
+      lock.lock();
+      delivering_ = false;
+      throw;
+    }
+    lock.lock();
+  }
+  delivering_ = false;
+}
+
+void TrieStore::Deliver(uint64_t sequence, const Trie &version) {
+  std::scoped_lock lock(subscribers_latch_);
+  // Subscribers usually have all seen the same version, and then share one diff
+  std::optional<TrieDiff> diff;
+  for (auto &subscriber : subscribers_) {
+    if (sequence <= subscriber.sequence_) {
+      // Subscribed after this version was queued: its first snapshot is this version or a newer one
+      continue;
+    }
+    subscriber.sequence_ = sequence;
+    if (subscriber.last_.GetRoot() == version.GetRoot()) {
+      continue;
+    }
+    if (!diff.has_value() || diff->OldTrie().GetRoot() != subscriber.last_.GetRoot()) {
+      diff.emplace(Diff(subscriber.last_, version));
+    }
+    subscriber.last_ = version;
+    if (!diff->Empty()) {
+      subscriber.callback_(*diff);
+    }
+  }
+}
+
+auto TrieStore::GetCommitStats() const -> CommitStats {
+  return {commits_.load(std::memory_order_relaxed), contended_.load(std::memory_order_relaxed),
+          retries_.load(std::memory_order_relaxed)};
+}
+
+void TrieStore::Retire(const Trie *old) {
+  epoch_.Retire(std::shared_ptr<const Trie>(old));
+  if (epoch_.RetiredCount() >= kReclaimBatch) {
+    epoch_.Reclaim();
+  }
+}
+
+// Below are explicit instantiation of template functions.
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<uint32_t>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<uint32_t>;
+template void TrieStore::Put(std::string_view key, uint32_t value);
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<uint64_t>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<uint64_t>;
+template void TrieStore::Put(std::string_view key, uint64_t value);
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<std::string>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<std::string>;
+template void TrieStore::Put(std::string_view key, std::string value);
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<ArenaString>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<ArenaString>;
+template void TrieStore::Put(std::string_view key, ArenaString value);
+
+// If your implementation is correct, these instantiations should compile.
+
+using Integer = std::unique_ptr<uint32_t>;
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<Integer>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<Integer>;
+template void TrieStore::Put(std::string_view key, Integer value);
+
+template auto TrieStore::Get(std::string_view key) -> std::optional<ValueGuard<MoveBlocked>>;
+template auto TrieStore::MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<MoveBlocked>;
+template void TrieStore::Put(std::string_view key, MoveBlocked value);
+
+}  // namespace bustub
@@ -0,0 +1,303 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_store.h
+//
+// Identification: src/include/primer/trie_store.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "epoch_manager.h"
+#include "node_pool.h"
+#include "thread_pool.h"
+#include "trie.h"
+#include "trie_diff.h"
+
+namespace bustub {
+
+// This class is used to guard the value returned by the trie. It pins the epoch the value was read in, so that the
+// snapshot holding the value is not reclaimed while the guard lives. A guard must not outlive its store.
+template <class T>
+class ValueGuard {
+ public:
+  ValueGuard(EpochManager::Guard pin, const T &value) : pin_(std::move(pin)), value_(value) {}
+  auto operator*() const -> const T & { return value_; }
+
+ private:
+  EpochManager::Guard pin_;
+  const T &value_;
+};
+
+// This class guards the values returned by `TrieStore::MultiGet`. All of them were read from the same snapshot, which
+// a single epoch pin keeps alive while the guard lives. A guard must not outlive its store.
+template <class T>
+class MultiValueGuard {
+ public:
+  MultiValueGuard(EpochManager::Guard pin, std::vector<const T *> values)
+      : pin_(std::move(pin)), values_(std::move(values)) {}
+
+  // The value of the i-th key, or nullptr if it has none of type T.
+  auto operator[](size_t i) const -> const T * { return values_[i]; }
+  auto Size() const -> size_t { return values_.size(); }
+
+ private:
+  EpochManager::Guard pin_;
+  std::vector<const T *> values_;
+};
+
+// A write started by `TrieStore::PutAsync`, running on a worker of the store. Block for it with `Wait()`, or
+// `co_await` it in a coroutine: the coroutine is resumed on the worker once the write is published. Either
+// rethrows what the write threw. Dropping an AsyncWrite does not cancel the write.
+class AsyncWrite {
+ public:
+  void Wait();
+
+  auto await_ready() const -> bool;  // NOLINT
+  // Returns false, resuming the coroutine at once, if the write finished in the meantime.
+  auto await_suspend(std::coroutine_handle<> waiter) -> bool;  // NOLINT
+  void await_resume();                                          // NOLINT
+
+ private:
+  friend class TrieStore;
+
+  struct State {
+    std::mutex latch_;
+    std::condition_variable done_cv_;
+    bool done_{false};
+    std::exception_ptr error_;
+    std::coroutine_handle<> waiter_;
+  };
+
+  explicit AsyncWrite(std::shared_ptr<State> state) : state_(std::move(state)) {}
+
+  std::shared_ptr<State> state_;
+};
+
+// How a TrieStore orders concurrent writes.
+enum class CommitMode : uint8_t {
+  // Writers take turns on a mutex. Best when writes often conflict, or a write is expensive to redo.
+  kLocked,
+  // Writers build their new version without any lock and publish it with a compare-and-swap on the root. A writer
+  // that loses the race redoes its write on the winner's version and tries again.
+  kOptimistic,
+};
+
+// This class is a thread-safe wrapper around the Trie class. It provides a simple interface for
+// accessing the trie. It allows concurrent reads and a single write operation at the same time.
+//
+// Readers never take a lock and never touch a reference count: a reader pins the current epoch in a per-thread slot,
+// loads a raw pointer to the published snapshot and walks an immutable trie. Concurrent readers therefore do not
+// write to any cache line they share. Writers build the new version off the published snapshot and swap it in with a
+// single atomic operation. A slow `Put` (e.g. a `MoveBlocked` value) therefore never stalls readers.
+//
+// With `CommitMode::kLocked`, writers serialize on `write_lock_`. With `CommitMode::kOptimistic`, they run in
+// parallel and publish with a compare-and-swap; the loser of a race rebuilds only the paths its own write touches on
+// top of the winner's snapshot, since everything else is shared. Values are moved into their nodes once, before the
+// first attempt, so a retry never needs the value again. `GetCommitStats` counts commits, contended commits and
+// retries, to tell which mode suits a workload.
+//
+// Replaced snapshots are not dropped by the writer that replaces them. They are retired to an EpochManager and
+// released in bulk every `kReclaimBatch` writes, once no pinned reader can still see them. Optionally, the store
+// allocates all its nodes and values from a NodePool instead of the global heap.
+class TrieStore {
+ public:
+  TrieStore() : TrieStore(TrieLayout::kPerCharacter) {}
+
+  // Create an empty store whose snapshots use the given node layout.
+  explicit TrieStore(TrieLayout layout) : TrieStore(layout, nullptr) {}
+
+  // Create an empty store that commits writes in the given mode.
+  explicit TrieStore(CommitMode mode) : TrieStore(TrieLayout::kPerCharacter, nullptr, mode) {}
+
+  // Create an empty store whose snapshots use the given node layout and allocate from `pool`.
+  TrieStore(TrieLayout layout, std::shared_ptr<NodePool> pool, CommitMode mode = CommitMode::kLocked)
+      : TrieStore(Trie(layout, std::move(pool)), mode) {}
+
+  // Create a store whose first snapshot is `trie`, e.g. one loaded from disk.
+  explicit TrieStore(Trie trie, CommitMode mode = CommitMode::kLocked)
+      : mode_(mode), pool_(trie.GetNodePool()), current_(new Trie(std::move(trie))) {}
+
+  TrieStore(const TrieStore &) = delete;
+  auto operator=(const TrieStore &) -> TrieStore & = delete;
+  // Waits for the writes PutAsync started.
+  ~TrieStore();
+
+  // This function returns a ValueGuard object that holds a reference to the value in the trie. If
+  // the key does not exist in the trie, it will return std::nullopt.
+  template <class T>
+  auto Get(std::string_view key) -> std::optional<ValueGuard<T>>;
+
+  // Look up all `keys` in one snapshot, with a single epoch pin, using `Trie::MultiGet`.
+  template <class T>
+  auto MultiGet(std::span<const std::string_view> keys) -> MultiValueGuard<T>;
+
+  // This function will insert the key-value pair into the trie. If the key already exists in the
+  // trie, it will overwrite the value.
+  template <class T>
+  void Put(std::string_view key, T value);
+
+  // Put the value `make()` returns at `key` on one of `kAsyncWorkers` worker threads, which the store starts on the
+  // first call, and return at once. The value is made and moved into its node, and the new version is built, without
+  // holding the store; only publishing it is serialized with other writes. A slow value (e.g. a `MoveBlocked`)
+  // therefore delays neither other writers nor the caller, which may be an executor thread that must not block; only
+  // once every worker is busy do further PutAsync writes queue up. The store waits for its pending writes when it is
+  // destroyed, so a coroutine resumed by one must not destroy the store on the worker.
+  template <class T, class Make>
+  auto PutAsync(std::string key, Make make) -> AsyncWrite {
+    // std::function needs a copyable target, and `make` may own move-only state
+    auto put = [this, key = std::move(key), make = std::move(make)]() mutable {
+      WriteBatch batch(pool_);
+      batch.Put<T>(key, make());
+      Publish(std::move(batch));
+    };
+    auto shared = std::make_shared<decltype(put)>(std::move(put));
+    return StartAsync([shared] { (*shared)(); });
+  }
+
+  // This function will remove the key-value pair from the trie.
+  void Remove(std::string_view key);
+
+  // This function applies all operations of the batch as one write: readers see either none or all of them.
+  void Apply(WriteBatch batch);
+
+  // Get the current snapshot of the store. The returned trie is immutable and stays valid regardless of later writes.
+  auto Snapshot() const -> Trie;
+
+  auto GetCommitMode() const -> CommitMode { return mode_; }
+
+  // Call `callback` after every write from now on with the keys it changed, as the diff from the version it replaced
+  // to the version it published. Computing it only walks the paths the write rebuilt. Each diff starts at the version
+  // the previous one ended at, the first at the version current when subscribing, so a cache that applies them in
+  // order stays in sync. In kLocked mode every commit gets a diff of its own; in kOptimistic mode, writes that publish
+  // concurrently may be delivered as one diff. Writes that change no key, like the Remove of a missing one, are not
+  // delivered.
+  //
+  // Diffs are delivered after the write lock is released, one at a time and in commit order, by a writing thread:
+  // a writer that finds another thread delivering leaves its diff to that thread and returns, so a diff may arrive
+  // after its write returned, but never before an earlier one. A callback may therefore write to the store; its
+  // write is delivered once the callback returns. It must not subscribe or unsubscribe. Returns an id for
+  // `Unsubscribe`.
+  auto Subscribe(std::function<void(const TrieDiff &)> callback) -> uint64_t;
+
+  // Stop calling the callback of subscription `id`. Once this returns, the callback is not running either.
+  void Unsubscribe(uint64_t id);
+
+  struct CommitStats {
+    // Number of writes published.
+    uint64_t commits_;
+    // Number of writes that could not publish at once: the write lock was held, or a compare-and-swap failed.
+    uint64_t contended_;
+    // Number of writes rebuilt on a newer snapshot: failed compare-and-swaps, or in kLocked mode, PutAsync writes
+    // whose snapshot was replaced before they took the lock.
+    uint64_t retries_;
+  };
+
+  auto GetCommitStats() const -> CommitStats;
+
+ private:
+  // Replaced snapshots are reclaimed once this many of them have been retired.
+  static constexpr size_t kReclaimBatch = 64;
+
+  // Number of threads that run PutAsync writes.
+  static constexpr size_t kAsyncWorkers = 4;
+
+  // Publish the snapshot `write(current snapshot)` returns, according to the commit mode. In kOptimistic mode,
+  // `write` may be called more than once.
+  template <class Write>
+  void Commit(Write write);
+
+  // Publish `batch`, building the new version before taking the write lock in kLocked mode. If the snapshot changed
+  // before the lock was taken, the version is rebuilt with the lock held.
+  void Publish(WriteBatch batch);
+
+  // Run `write` on `async_pool_`, tracked in `async_writes_`.
+  auto StartAsync(std::function<void()> write) -> AsyncWrite;
+
+  // Queue `version`, just published, for delivery, or the current snapshot if it is nullptr. Snapshots read with
+  // `delivery_latch_` held never go back in time, so either way the queue stays in commit order.
+  void Enqueue(const Trie *version);
+
+  // Deliver the queued versions, unless another thread is delivering them already.
+  void Notify();
+
+  // Call the subscribers that have not seen version `sequence` yet with the diff up to it.
+  void Deliver(uint64_t sequence, const Trie &version);
+
+  // Retire `old`, which has just been replaced, and reclaim a batch of retired snapshots when one is due.
+  void Retire(const Trie *old);
+
+  const CommitMode mode_;
+
+  // The pool of the snapshots, which the batches the store builds itself allocate from.
+  const std::shared_ptr<NodePool> pool_;
+
+  // This mutex sequences all writes operations in kLocked mode, and allows only one write operation at a time.
+  std::mutex write_lock_;
+
+  // Holds replaced snapshots until no reader can see them.
+  mutable EpochManager epoch_;
+
+  // The current snapshot, owned by the store. Readers must pin an epoch before loading it.
+  std::atomic<const Trie *> current_;
+
+  std::atomic<uint64_t> commits_{0};
+  std::atomic<uint64_t> contended_{0};
+  std::atomic<uint64_t> retries_{0};
+
+  struct Subscriber {
+    uint64_t id_;
+    std::function<void(const TrieDiff &)> callback_;
+    // The version the last diff delivered to this subscriber ended at, and its sequence number.
+    Trie last_;
+    uint64_t sequence_;
+  };
+
+  struct PendingVersion {
+    uint64_t sequence_;
+    Trie version_;
+  };
+
+  // Set while `subscribers_` is not empty, so that writes without subscribers skip `Notify` without taking a lock.
+  std::atomic<bool> has_subscribers_{false};
+  // Held while callbacks run, so that `Unsubscribe` can wait for them.
+  std::mutex subscribers_latch_;
+  std::vector<Subscriber> subscribers_;
+  uint64_t next_subscriber_{0};
+
+  // Versions published and not delivered yet, numbered in commit order. Never held while callbacks run.
+  std::mutex delivery_latch_;
+  std::deque<PendingVersion> pending_;
+  // Sequence number of the last version queued.
+  uint64_t sequence_{0};
+  // Set while a thread delivers `pending_`.
+  bool delivering_{false};
+
+  // Number of PutAsync writes still running, which the destructor waits for, and the workers that run them, started
+  // with the first one.
+  std::mutex async_latch_;
+  std::condition_variable async_done_;
+  size_t async_writes_{0};
+  std::unique_ptr<ThreadPool> async_pool_;
+};
+
+}  // namespace bustub
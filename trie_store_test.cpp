@@ -0,0 +1,453 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_store_test.cpp
+//
+// Identification: test/primer/trie_store_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <coroutine>
+#include <exception>
+#include <future>  // NOLINT
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "test.h"
+#include "trie_iterator.h"
+#include "trie_store.h"
+
+namespace bustub {
+
+using Integer = std::unique_ptr<uint32_t>;
+
+namespace {
+
+// A coroutine that starts at once and runs to its end on whichever thread resumes it.
+struct DetachedTask {
+  struct promise_type {  // NOLINT
+    auto get_return_object() -> DetachedTask { return {}; }                // NOLINT
+    auto initial_suspend() -> std::suspend_never { return {}; }            // NOLINT
+    auto final_suspend() noexcept -> std::suspend_never { return {}; }     // NOLINT
+    void return_void() {}                                                  // NOLINT
+    void unhandled_exception() { std::terminate(); }                       // NOLINT
+  };
+};
+
+// Each write is published before the next one starts, so the second write to "x" wins.
+auto PutInOrder(TrieStore &store, std::promise<void> &done) -> DetachedTask {
+  co_await store.PutAsync<uint32_t>("x", [] { return 1U; });
+  co_await store.PutAsync<uint32_t>("x", [] { return 2U; });
+  co_await store.PutAsync<std::string>("y", [] { return std::string("2333"); });
+  done.set_value();
+}
+
+}  // namespace
+
+TEST(TrieStoreTest, BasicTest) {
+  auto store = TrieStore();
+  ASSERT_TRUE(!store.Get<uint32_t>("233").has_value());
+  store.Put<uint32_t>("233", 2333);
+  {
+    auto guard = store.Get<uint32_t>("233");
+    ASSERT_EQ(**guard, 2333);
+  }
+  store.Remove("233");
+  {
+    auto guard = store.Get<uint32_t>("233");
+    ASSERT_TRUE(!guard.has_value());
+  }
+}
+
+TEST(TrieStoreTest, GuardTest) {
+  auto store = TrieStore();
+  ASSERT_TRUE(!store.Get<std::string>("233").has_value());
+
+  store.Put<std::string>("233", "2333");
+  auto guard = store.Get<std::string>("233");
+  ASSERT_EQ(**guard, "2333");
+
+  // The guard keeps its snapshot alive after the key is gone from the store.
+  store.Remove("233");
+  {
+    auto guard = store.Get<std::string>("233");
+    ASSERT_TRUE(!guard.has_value());
+  }
+
+  ASSERT_EQ(**guard, "2333");
+}
+
+TEST(TrieStoreTest, MultiGetTest) {
+  auto store = TrieStore();
+  store.Put<uint32_t>("a", 1);
+  store.Put<uint32_t>("ab", 2);
+  store.Put<std::string>("b", "2333");
+
+  std::vector<std::string_view> keys{"ab", "b", "a", "c"};
+  auto guard = store.MultiGet<uint32_t>(keys);
+  ASSERT_EQ(guard.Size(), 4);
+  ASSERT_EQ(*guard[0], 2);
+  ASSERT_TRUE(guard[1] == nullptr);
+  ASSERT_EQ(*guard[2], 1);
+  ASSERT_TRUE(guard[3] == nullptr);
+
+  // Like a ValueGuard, the guard keeps its snapshot alive after the keys are gone.
+  store.Remove("a");
+  store.Remove("ab");
+  ASSERT_EQ(*guard[0], 2);
+  ASSERT_EQ(*guard[2], 1);
+}
+
+TEST(TrieStoreTest, PinnedGuardTest) {
+  auto store = TrieStore();
+  store.Put<std::string>("233", "0");
+  auto guard = store.Get<std::string>("233");
+
+  // Enough writes to trigger several reclamations: the pinned snapshot must survive all of them.
+  for (uint32_t i = 1; i <= 1000; i++) {
+    store.Put<std::string>("233", std::to_string(i));
+  }
+  ASSERT_EQ(**guard, "0");
+  ASSERT_EQ(**store.Get<std::string>("233"), "1000");
+
+  // Hold more guards than there are pin slots; the extra ones pin overflow slots.
+  std::vector<ValueGuard<std::string>> guards;
+  for (size_t i = 0; i < 2 * EpochManager::kSlots; i++) {
+    guards.push_back(*store.Get<std::string>("233"));
+    store.Put<std::string>("233", std::to_string(i));
+  }
+  for (size_t i = 0; i < guards.size(); i++) {
+    ASSERT_EQ(*guards[i], i == 0 ? "1000" : std::to_string(i - 1));
+  }
+}
+
+TEST(TrieStoreTest, NonCopyableTest) {
+  auto store = TrieStore();
+  store.Put<Integer>("tes", std::make_unique<uint32_t>(233));
+  store.Put<Integer>("tes2", std::make_unique<uint32_t>(23));
+  store.Put<Integer>("te", std::make_unique<uint32_t>(2));
+  ASSERT_EQ(***store.Get<Integer>("te"), 2);
+  ASSERT_EQ(***store.Get<Integer>("tes2"), 23);
+  ASSERT_EQ(***store.Get<Integer>("tes"), 233);
+  store.Remove("te");
+  ASSERT_TRUE(!store.Get<Integer>("te").has_value());
+}
+
+TEST(TrieStoreTest, BatchTest) {
+  auto store = TrieStore(TrieLayout::kPathCompressed);
+  WriteBatch batch;
+  for (uint32_t i = 0; i < 1000; i++) {
+    batch.Put<uint32_t>("tenant/metric/" + std::to_string(i), i);
+  }
+  store.Apply(std::move(batch));
+  for (uint32_t i = 0; i < 1000; i++) {
+    ASSERT_EQ(**store.Get<uint32_t>("tenant/metric/" + std::to_string(i)), i);
+  }
+}
+
+TEST(TrieStoreTest, NodePoolTest) {
+  auto pool = NodePool::Create();
+  {
+    auto store = TrieStore(TrieLayout::kPathCompressed, pool);
+    for (uint32_t i = 0; i < 1000; i++) {
+      store.Put<uint32_t>("key-" + std::to_string(i), i);
+    }
+    for (uint32_t i = 0; i < 1000; i++) {
+      ASSERT_EQ(**store.Get<uint32_t>("key-" + std::to_string(i)), i);
+    }
+  }
+  // Once the store and its retired snapshots are gone, every block is back in the pool.
+  ASSERT_EQ(pool->GetStats().blocks_in_use_, 0);
+}
+
+TEST(TrieStoreTest, OptimisticCommitTest) {
+  auto store = TrieStore(CommitMode::kOptimistic);
+  ASSERT_TRUE(store.GetCommitMode() == CommitMode::kOptimistic);
+  store.Put<Integer>("int", std::make_unique<uint32_t>(233));
+  ASSERT_EQ(***store.Get<Integer>("int"), 233);
+
+  std::vector<std::thread> threads;
+  const int keys_per_thread = 2000;
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&store, tid] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        store.Put<uint32_t>(std::to_string(tid) + "/" + std::to_string(i), i);
+        // Every thread also writes the same hot key
+        store.Put<uint32_t>("hot", i);
+      }
+      WriteBatch batch;
+      batch.Remove(std::to_string(tid) + "/0");
+      batch.Put<uint32_t>(std::to_string(tid) + "/done", 1);
+      store.Apply(std::move(batch));
+    });
+  }
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  // No write was lost to a race
+  for (int tid = 0; tid < 4; tid++) {
+    ASSERT_TRUE(!store.Get<uint32_t>(std::to_string(tid) + "/0").has_value());
+    ASSERT_EQ(**store.Get<uint32_t>(std::to_string(tid) + "/done"), 1);
+    for (int i = 1; i < keys_per_thread; i++) {
+      ASSERT_EQ(**store.Get<uint32_t>(std::to_string(tid) + "/" + std::to_string(i)), i);
+    }
+  }
+  auto stats = store.GetCommitStats();
+  ASSERT_EQ(stats.commits_, 1 + 4 * (2 * keys_per_thread + 1));
+  ASSERT_TRUE(stats.contended_ <= stats.retries_);
+}
+
+TEST(TrieStoreTest, MixedConcurrentTest) {
+  auto store = TrieStore();
+  std::vector<std::thread> threads;
+
+  const int keys_per_thread = 10000;
+
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&store, tid] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        auto key = std::to_string(tid * keys_per_thread + i);
+        store.Put<std::string>(key, "value-" + key);
+      }
+      for (int i = 0; i < keys_per_thread; i += 2) {
+        store.Remove(std::to_string(tid * keys_per_thread + i));
+      }
+    });
+  }
+
+  for (int tid = 0; tid < 4; tid++) {
+    threads.emplace_back([&store] {
+      for (int i = 0; i < keys_per_thread; i++) {
+        auto guard = store.Get<std::string>(std::to_string(i));
+        if (guard) {
+          ASSERT_EQ(**guard, "value-" + std::to_string(i));
+        }
+      }
+    });
+  }
+
+  for (auto &t : threads) {
+    t.join();
+  }
+
+  for (int i = 0; i < 4 * keys_per_thread; i++) {
+    auto guard = store.Get<std::string>(std::to_string(i));
+    if (i % 2 == 0) {
+      ASSERT_TRUE(!guard.has_value());
+    } else {
+      ASSERT_EQ(**guard, "value-" + std::to_string(i));
+    }
+  }
+}
+
+TEST(TrieStoreTest, ReadWriteTest) {
+  auto store = TrieStore();
+  store.Put<uint32_t>("a", 1);
+  store.Put<uint32_t>("b", 2);
+  store.Put<uint32_t>("c", 3);
+  std::promise<int> x;
+
+  // This Put blocks inside MoveBlocked's move constructor, before it takes the write lock.
+  std::thread t([&store, &x] { store.Put<MoveBlocked>("d", MoveBlocked(x.get_future())); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Readers must not be blocked by the pending write.
+  for (int i = 0; i < 10000; i++) {
+    {
+      auto guard = store.Get<uint32_t>("a");
+      ASSERT_EQ(**guard, 1);
+    }
+    {
+      auto guard = store.Get<uint32_t>("b");
+      ASSERT_EQ(**guard, 2);
+    }
+    {
+      auto guard = store.Get<uint32_t>("c");
+      ASSERT_EQ(**guard, 3);
+    }
+  }
+
+  // Neither are other writers
+  store.Put<uint32_t>("e", 5);
+  ASSERT_EQ(**store.Get<uint32_t>("e"), 5);
+
+  x.set_value(233);
+  t.join();
+
+  ASSERT_TRUE(store.Get<MoveBlocked>("d").has_value());
+}
+
+TEST(TrieStoreTest, AsyncPutTest) {
+  for (auto mode : {CommitMode::kLocked, CommitMode::kOptimistic}) {
+    TrieStore store(mode);
+    std::promise<int> x;
+    auto write =
+        store.PutAsync<MoveBlocked>("d", [wait = x.get_future()]() mutable { return MoveBlocked(std::move(wait)); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // The blocked value holds up neither the caller nor other writers
+    ASSERT_TRUE(!write.await_ready());
+    store.Put<uint32_t>("a", 1);
+    auto other = store.PutAsync<uint32_t>("b", [] { return 2U; });
+    other.Wait();
+    ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+    ASSERT_EQ(**store.Get<uint32_t>("b"), 2);
+    ASSERT_TRUE(!store.Get<MoveBlocked>("d").has_value());
+
+    x.set_value(233);
+    write.Wait();
+    ASSERT_TRUE(store.Get<MoveBlocked>("d").has_value());
+    ASSERT_EQ(**store.Get<uint32_t>("a"), 1);
+
+    // Many writes share the store's few workers instead of starting a thread each
+    std::vector<AsyncWrite> writes;
+    for (uint32_t i = 0; i < 1000; i++) {
+      writes.push_back(store.PutAsync<uint32_t>("many/" + std::to_string(i), [i] { return i; }));
+    }
+    for (auto &pending : writes) {
+      pending.Wait();
+    }
+    for (uint32_t i = 0; i < 1000; i++) {
+      ASSERT_EQ(**store.Get<uint32_t>("many/" + std::to_string(i)), i);
+    }
+  }
+}
+
+TEST(TrieStoreTest, CoroutinePutTest) {
+  TrieStore store;
+  std::promise<void> done;
+  PutInOrder(store, done);
+  done.get_future().get();
+  ASSERT_EQ(**store.Get<uint32_t>("x"), 2);
+  ASSERT_EQ(**store.Get<std::string>("y"), "2333");
+
+  // A failed write rethrows where it is awaited
+  auto failing = store.PutAsync<uint32_t>("z", []() -> uint32_t { throw std::runtime_error("no value"); });
+  bool thrown = false;
+  try {
+    failing.Wait();
+  } catch (const std::runtime_error &) {
+    thrown = true;
+  }
+  ASSERT_TRUE(thrown);
+  ASSERT_TRUE(!store.Get<uint32_t>("z").has_value());
+}
+
+TEST(TrieStoreTest, SubscribeTest) {
+  for (auto mode : {CommitMode::kLocked, CommitMode::kOptimistic}) {
+    auto store = TrieStore(mode);
+    store.Put<uint32_t>("a", 1);
+    std::vector<std::vector<std::pair<ChangeKind, std::string>>> seen;
+    auto id = store.Subscribe([&](const TrieDiff &diff) {
+      auto &changes = seen.emplace_back();
+      for (const auto &change : diff) {
+        changes.emplace_back(change.kind_, change.key_);
+      }
+    });
+    store.Put<uint32_t>("b", 2);
+    WriteBatch batch;
+    batch.Put<uint32_t>("a", 3);
+    batch.Put<uint32_t>("c", 4);
+    store.Apply(std::move(batch));
+    store.Remove("b");
+    // A write that changes nothing is not delivered
+    store.Remove("z");
+    store.Unsubscribe(id);
+    store.Put<uint32_t>("d", 5);
+
+    using Changes = std::vector<std::pair<ChangeKind, std::string>>;
+    ASSERT_EQ(seen.size(), 3);
+    ASSERT_TRUE(seen[0] == Changes({{ChangeKind::kAdded, "b"}}));
+    ASSERT_TRUE(seen[1] == Changes({{ChangeKind::kUpdated, "a"}, {ChangeKind::kAdded, "c"}}));
+    ASSERT_TRUE(seen[2] == Changes({{ChangeKind::kRemoved, "b"}}));
+  }
+}
+
+TEST(TrieStoreTest, SubscribeWriteBackTest) {
+  for (auto mode : {CommitMode::kLocked, CommitMode::kOptimistic}) {
+    // A callback that mirrors every key under "copy/" writes back into the store it is subscribed to. Its writes are
+    // delivered after it returns, in the order they were committed.
+    auto store = TrieStore(mode);
+    std::vector<std::string> seen;
+    store.Subscribe([&](const TrieDiff &diff) {
+      for (const auto &change : diff) {
+        seen.push_back(change.key_);
+        if (change.key_.rfind("copy/", 0) != 0) {
+          store.Put<uint32_t>("copy/" + change.key_, *change.NewValue<uint32_t>());
+        }
+      }
+    });
+    store.Put<uint32_t>("a", 1);
+    store.Put<uint32_t>("b", 2);
+    ASSERT_EQ(**store.Get<uint32_t>("copy/a"), 1);
+    ASSERT_EQ(**store.Get<uint32_t>("copy/b"), 2);
+    ASSERT_TRUE(seen == std::vector<std::string>({"a", "copy/a", "b", "copy/b"}));
+
+    // Concurrent writers with a callback that writes back do not deadlock, and every write is mirrored.
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++) {
+      threads.emplace_back([&store, t] {
+        for (uint32_t i = 0; i < 100; i++) {
+          store.Put<uint32_t>(std::to_string(t) + "/" + std::to_string(i), i);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    for (uint32_t t = 0; t < 4; t++) {
+      for (uint32_t i = 0; i < 100; i++) {
+        ASSERT_EQ(**store.Get<uint32_t>("copy/" + std::to_string(t) + "/" + std::to_string(i)), i);
+      }
+    }
+  }
+}
+
+TEST(TrieStoreTest, ConcurrentSubscribeTest) {
+  // A cache that applies the diffs in order ends up with the same keys as the store, however writes interleave
+  for (auto mode : {CommitMode::kLocked, CommitMode::kOptimistic}) {
+    auto store = TrieStore(TrieLayout::kPathCompressed, nullptr, mode);
+    std::map<std::string, uint32_t> cache;
+    store.Subscribe([&](const TrieDiff &diff) {
+      for (const auto &change : diff) {
+        if (change.kind_ == ChangeKind::kRemoved) {
+          cache.erase(change.key_);
+        } else {
+          cache[change.key_] = *change.NewValue<uint32_t>();
+        }
+      }
+    });
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++) {
+      threads.emplace_back([&store, t] {
+        for (uint32_t i = 0; i < 500; i++) {
+          auto key = std::to_string(i % 50) + "/" + std::to_string(t);
+          if (i % 3 == 2) {
+            store.Remove(key);
+          } else {
+            store.Put<uint32_t>(key, i);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::map<std::string, uint32_t> expected;
+    for (auto [key, value] : store.Snapshot().Scan<uint32_t>("")) {
+      expected[std::string(key)] = value;
+    }
+    ASSERT_TRUE(cache == expected);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,267 @@
+#include "trie_wal.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "durable_file.h"
+#include "trie_snapshot.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr uint8_t kPutRecord = 1;
+constexpr uint8_t kRemoveRecord = 2;
+constexpr uint8_t kBatchRecord = 3;
+constexpr size_t kRecordHeaderSize = 2 * sizeof(uint32_t);
+
+auto Checksum(std::string_view data) -> uint32_t {
+  uint32_t hash = 2166136261U;
+  for (char c : data) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 16777619U;
+  }
+  return hash;
+}
+
+template <class V>
+void AppendBytes(std::string &out, const V &value) {
+  out.append(reinterpret_cast<const char *>(&value), sizeof(value));
+}
+
+template <class V>
+auto Load(const char *data) -> V {
+  V value;
+  std::memcpy(&value, data, sizeof(V));
+  return value;
+}
+
+// Decode one Put or Remove into `batch`. Returns false, adding nothing, if the payload is malformed.
+auto DecodeOperation(std::string_view payload, WriteBatch &batch) -> bool {
+  constexpr size_t kKeyHeaderSize = sizeof(uint8_t) + sizeof(uint32_t);
+  if (payload.size() < kKeyHeaderSize) {
+    return false;
+  }
+  auto op = Load<uint8_t>(payload.data());
+  auto key_size = Load<uint32_t>(payload.data() + sizeof(uint8_t));
+  if (payload.size() - kKeyHeaderSize < key_size) {
+    return false;
+  }
+  std::string_view key = payload.substr(kKeyHeaderSize, key_size);
+  std::string_view rest = payload.substr(kKeyHeaderSize + key_size);
+
+  if (op == kRemoveRecord) {
+    if (!rest.empty()) {
+      return false;
+    }
+    batch.Remove(key);
+    return true;
+  }
+  if (op != kPutRecord || rest.size() < sizeof(uint8_t) + sizeof(uint64_t)) {
+    return false;
+  }
+  auto value_type = Load<uint8_t>(rest.data());
+  auto score = Load<uint64_t>(rest.data() + sizeof(uint8_t));
+  std::string_view value = rest.substr(sizeof(uint8_t) + sizeof(uint64_t));
+  const auto *bytes = reinterpret_cast<const std::byte *>(value.data());
+  switch (value_type) {
+    case SnapshotValue<uint32_t>::kTypeId:
+      if (value.size() != sizeof(uint32_t)) {
+        return false;
+      }
+      batch.Put<uint32_t>(key, TrieView::Decode<uint32_t>(bytes), score);
+      return true;
+    case SnapshotValue<uint64_t>::kTypeId:
+      if (value.size() != sizeof(uint64_t)) {
+        return false;
+      }
+      batch.Put<uint64_t>(key, TrieView::Decode<uint64_t>(bytes), score);
+      return true;
+    case SnapshotValue<std::string>::kTypeId:
+      if (value.size() < sizeof(uint64_t) || value.size() - sizeof(uint64_t) != Load<uint64_t>(value.data())) {
+        return false;
+      }
+      batch.Put<std::string>(key, std::string(TrieView::Decode<std::string>(bytes)), score);
+      return true;
+    default:
+      return false;
+  }
+}
+
+// Decode one record payload into `batch`: a whole batch, or a single Put or Remove as older logs hold them. Returns
+// false, adding nothing, if the payload is malformed.
+auto DecodeRecord(std::string_view payload, WriteBatch &batch) -> bool {
+  if (payload.empty() || Load<uint8_t>(payload.data()) != kBatchRecord) {
+    return DecodeOperation(payload, batch);
+  }
+  payload.remove_prefix(sizeof(uint8_t));
+  WriteBatch decoded;
+  while (!payload.empty()) {
+    if (payload.size() < sizeof(uint32_t)) {
+      return false;
+    }
+    auto size = Load<uint32_t>(payload.data());
+    payload.remove_prefix(sizeof(uint32_t));
+    if (payload.size() < size || !DecodeOperation(payload.substr(0, size), decoded)) {
+      return false;
+    }
+    payload.remove_prefix(size);
+  }
+  batch.Append(std::move(decoded));
+  return true;
+}
+
+}  // namespace
+
+WriteAheadLog::WriteAheadLog(const std::string &path, WalSyncPolicy sync) : path_(path), sync_(sync) {
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+  if (fd_ < 0) {
+    throw std::runtime_error("WriteAheadLog: cannot open " + path + ": " + std::strerror(errno));
+  }
+  struct stat st {};
+  if (::fstat(fd_, &st) != 0) {
+    int error = errno;
+    ::close(fd_);
+    throw std::runtime_error("WriteAheadLog: cannot stat " + path + ": " + std::strerror(error));
+  }
+  end_ = st.st_size;
+}
+
+WriteAheadLog::~WriteAheadLog() {
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void WriteAheadLog::Encode(const WriteBatch &batch, std::string &out) {
+  std::string payload;
+  AppendBytes(payload, kBatchRecord);
+  for (const auto &op : batch.Operations()) {
+    size_t size_offset = payload.size();
+    AppendBytes(payload, uint32_t{0});
+    AppendBytes(payload, op.leaf_ == nullptr ? kRemoveRecord : kPutRecord);
+    AppendBytes(payload, static_cast<uint32_t>(op.key_.size()));
+    payload.append(op.key_);
+    if (op.leaf_ != nullptr) {
+      auto [value_type, value_size] = SnapshotFormat::ValueInfo(*op.leaf_);
+      AppendBytes(payload, value_type);
+      AppendBytes(payload, op.leaf_->Score());
+      size_t value_offset = payload.size();
+      payload.resize(value_offset + value_size);
+      SnapshotFormat::EncodeValue(*op.leaf_, reinterpret_cast<std::byte *>(payload.data() + value_offset));
+    }
+    auto size = static_cast<uint32_t>(payload.size() - size_offset - sizeof(uint32_t));
+    std::memcpy(payload.data() + size_offset, &size, sizeof(size));
+  }
+  AppendBytes(out, static_cast<uint32_t>(payload.size()));
+  AppendBytes(out, Checksum(payload));
+  out.append(payload);
+}
+
+void WriteAheadLog::Append(std::string_view records) {
+  if (broken_) {
+    throw std::runtime_error("WriteAheadLog: " + path_ + " is unusable since a failed append could not be undone");
+  }
+  try {
+    std::string_view rest = records;
+    while (!rest.empty()) {
+      ssize_t written = ::write(fd_, rest.data(), rest.size());
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error("WriteAheadLog: cannot append to " + path_ + ": " + std::strerror(errno));
+      }
+      rest.remove_prefix(written);
+    }
+    if (sync_ == WalSyncPolicy::kEveryCommit) {
+      RunDurabilityHook(DurabilityStep::kSyncLog, path_);
+      if (::fdatasync(fd_) != 0) {
+        throw std::runtime_error("WriteAheadLog: cannot sync " + path_ + ": " + std::strerror(errno));
+      }
+    }
+  } catch (...) {
+    // Whatever part of the records made it to the file must not be replayed, nor have later records follow it
+    if (::ftruncate(fd_, end_) != 0 || ::fdatasync(fd_) != 0) {
+      broken_ = true;
+    }
+    throw;
+  }
+  end_ += static_cast<off_t>(records.size());
+}
+
+void WriteAheadLog::Sync() {
+  if (broken_) {
+    throw std::runtime_error("WriteAheadLog: " + path_ + " is unusable since a failed append could not be undone");
+  }
+  RunDurabilityHook(DurabilityStep::kSyncLog, path_);
+  if (::fdatasync(fd_) != 0) {
+    // The kernel may have dropped the pages it failed to write, so a later sync could succeed without them
+    broken_ = true;
+    throw std::runtime_error("WriteAheadLog: cannot sync " + path_ + ": " + std::strerror(errno));
+  }
+}
+
+void WriteAheadLog::Truncate() {
+  RunDurabilityHook(DurabilityStep::kTruncateLog, path_);
+  if (::ftruncate(fd_, 0) != 0) {
+    throw std::runtime_error("WriteAheadLog: cannot truncate " + path_ + ": " + std::strerror(errno));
+  }
+  end_ = 0;
+  if (::fdatasync(fd_) != 0) {
+    throw std::runtime_error("WriteAheadLog: cannot sync " + path_ + ": " + std::strerror(errno));
+  }
+}
+
+auto WriteAheadLog::Recover(WriteBatch &batch) -> size_t {
+  struct stat st {};
+  if (::fstat(fd_, &st) != 0) {
+    throw std::runtime_error("WriteAheadLog: cannot stat " + path_ + ": " + std::strerror(errno));
+  }
+  std::string data(st.st_size, '\0');
+  size_t read_size = 0;
+  while (read_size < data.size()) {
+    ssize_t n = ::pread(fd_, data.data() + read_size, data.size() - read_size, static_cast<off_t>(read_size));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      throw std::runtime_error("WriteAheadLog: cannot read " + path_ + ": " + std::strerror(errno));
+    }
+    read_size += n;
+  }
+
+  size_t pos = 0;
+  size_t recovered = batch.Size();
+  while (data.size() - pos >= kRecordHeaderSize) {
+    auto size = Load<uint32_t>(data.data() + pos);
+    auto checksum = Load<uint32_t>(data.data() + pos + sizeof(uint32_t));
+    if (data.size() - pos - kRecordHeaderSize < size) {
+      break;
+    }
+    std::string_view payload(data.data() + pos + kRecordHeaderSize, size);
+    if (Checksum(payload) != checksum || !DecodeRecord(payload, batch)) {
+      break;
+    }
+    pos += kRecordHeaderSize + size;
+  }
+
+  if (pos != data.size()) {
+    // A crash tore the last append: drop it, so that new records follow the last good one
+    if (::ftruncate(fd_, static_cast<off_t>(pos)) != 0) {
+      throw std::runtime_error("WriteAheadLog: cannot truncate " + path_ + ": " + std::strerror(errno));
+    }
+    if (::fdatasync(fd_) != 0) {
+      throw std::runtime_error("WriteAheadLog: cannot sync " + path_ + ": " + std::strerror(errno));
+    }
+  }
+  end_ = static_cast<off_t>(pos);
+  return batch.Size() - recovered;
+}
+
+}  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// trie_wal.h
+//
+// Identification: src/include/primer/trie_wal.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "trie.h"
+
+namespace bustub {
+
+// When a WriteAheadLog forces appended records to stable storage.
+enum class WalSyncPolicy : uint8_t {
+  // fdatasync after every append: a write is durable once its commit returns.
+  kEveryCommit,
+  // Leave write-back to the OS (or to explicit `Sync` calls): a crash may lose the latest commits, never corrupt the
+  // log.
+  kNone,
+};
+
+// A WriteAheadLog is an append-only file of records, one per committed WriteBatch. Every record carries its length
+// and a checksum, so that recovery stops cleanly at a record torn by a crash, and a batch is replayed whole or not at
+// all.
+//
+// Record format: uint32_t payload length, uint32_t FNV-1a checksum of the payload, then the payload: uint8_t 3 and,
+// for each operation of the batch, uint32_t operation length and the operation. An operation is uint8_t op (1 = Put,
+// 2 = Remove), uint32_t key length, the key and, for a Put, uint8_t value type, uint64_t score and the value encoded
+// as in trie_snapshot.h. Logs written before batches were framed hold a bare operation as the payload of each record,
+// and still recover.
+class WriteAheadLog {
+ public:
+  // Open (or create) the log at `path` for appending.
+  WriteAheadLog(const std::string &path, WalSyncPolicy sync);
+  WriteAheadLog(const WriteAheadLog &) = delete;
+  auto operator=(const WriteAheadLog &) -> WriteAheadLog & = delete;
+  ~WriteAheadLog();
+
+  // Append `batch` to `out` as one log record. Throws std::invalid_argument if a value cannot be
+  // encoded (see `SnapshotFormat::ValueInfo`).
+  static void Encode(const WriteBatch &batch, std::string &out);
+
+  // Append encoded records with a single write, then sync according to the policy. Throws std::runtime_error on
+  // I/O errors, after cutting the log back to where the append started, so that none of its records is replayed. If
+  // even that fails, the log is unusable and every later `Append` and `Sync` throws.
+  void Append(std::string_view records);
+
+  // Force everything appended so far to stable storage. A failure makes the log unusable, since the kernel may have
+  // dropped the pages it could not write.
+  void Sync();
+
+  // Drop every record, e.g. once a checkpoint holds their effects.
+  void Truncate();
+
+  // Read back every complete record of the log into `batch`, and cut off a torn tail so that new records follow the
+  // last good one. Returns the number of operations recovered.
+  auto Recover(WriteBatch &batch) -> size_t;
+
+  auto GetSyncPolicy() const -> WalSyncPolicy { return sync_; }
+
+ private:
+  std::string path_;
+  WalSyncPolicy sync_;
+  int fd_{-1};
+  // The end of the last complete append.
+  off_t end_{0};
+  // Set when a failed append could not be cut off, or a sync failed.
+  bool broken_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// typed_trie.h
+//
+// Identification: src/include/primer/typed_trie.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "node_pool.h"
+#include "trie.h"
+#include "trie_children.h"
+
+namespace bustub {
+
+// A node of a TypedTrie<T>. Unlike a TrieNode, it has no virtual methods and no type tag: every node of the trie may
+// only hold a T, so the value is a member of the node itself, held the way a TrieNodeWithValue<T> holds it.
+template <class T>
+class TypedTrieNode {
+ public:
+  using Children = ChildArray<const TypedTrieNode>;
+
+  TypedTrieNode() = default;
+  TypedTrieNode(Children children, std::string segment, std::optional<NodeValue<T>> value)
+      : children_(std::move(children)), segment_(std::move(segment)), value_(std::move(value)) {}
+
+  auto HasValue() const -> bool { return value_.has_value(); }
+
+  Children children_;
+
+  // As `TrieNode::segment_`.
+  std::string segment_;
+
+  // The value of this node, if it has one.
+  std::optional<NodeValue<T>> value_;
+};
+
+// A TypedTrie<T> is a copy-on-write trie whose values all have the type T. It shares its write path, its child
+// arrays, its layouts and its node pools with `Trie`, and behaves like a Trie holding only values of type T; but as
+// the value type is known at compile time, every node carries its value directly, `Get` returns it without checking
+// a type tag, and `Put` and `Remove` rebuild nodes without a virtual call. Use it for tries that only ever hold one
+// value type, which is most of them. Scores, `TopK`, batches and the other extensions of Trie are not supported.
+//
+// It is instantiated for the value types `Trie` is instantiated for, at the bottom of trie.cpp.
+template <class T>
+class TypedTrie {
+ public:
+  using Node = TypedTrieNode<T>;
+
+  // Create an empty trie.
+  TypedTrie() = default;
+
+  // Create an empty trie with the given node layout.
+  explicit TypedTrie(TrieLayout layout) : layout_(layout) {}
+
+  // Create an empty trie with the given node layout, whose nodes and values are allocated from `pool`.
+  TypedTrie(TrieLayout layout, std::shared_ptr<NodePool> pool) : layout_(layout), pool_(std::move(pool)) {}
+
+  // Get the value at `key`, or nullptr if there is none.
+  auto Get(std::string_view key) const -> const T *;
+
+  // Put `value` at `key`, replacing any previous value.
+  auto Put(std::string_view key, T value) const -> TypedTrie;
+
+  auto Remove(std::string_view key) const -> TypedTrie;
+
+  auto GetRoot() const -> std::shared_ptr<const Node> { return root_; }
+
+  auto GetLayout() const -> TrieLayout { return layout_; }
+
+  auto GetNodePool() const -> const std::shared_ptr<NodePool> & { return pool_; }
+
+ private:
+  TypedTrie(std::shared_ptr<const Node> root, TrieLayout layout, std::shared_ptr<NodePool> pool)
+      : root_(std::move(root)), layout_(layout), pool_(std::move(pool)) {}
+
+  auto WithRoot(std::shared_ptr<const Node> root) const -> TypedTrie {
+    return TypedTrie(std::move(root), layout_, pool_);
+  }
+
+  std::shared_ptr<const Node> root_{nullptr};
+  TrieLayout layout_{TrieLayout::kPerCharacter};
+  std::shared_ptr<NodePool> pool_{nullptr};
+};
+
+}  // namespace bustub
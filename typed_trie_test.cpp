@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// typed_trie_test.cpp
+//
+// Identification: test/primer/typed_trie_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test.h"
+#include "trie_metrics.h"
+#include "typed_trie.h"
+
+namespace bustub {
+
+namespace {
+
+// Whether the subtrees of `typed` and `dynamic` have the same shape, segments and values.
+auto SameShape(const TypedTrieNode<uint32_t> *typed, const TrieNode *dynamic) -> bool {
+  if (typed == nullptr || dynamic == nullptr) {
+    return typed == nullptr && dynamic == nullptr;
+  }
+  if (typed->segment_ != dynamic->segment_ || typed->HasValue() != dynamic->is_value_node_ ||
+      typed->children_.size() != dynamic->children_.size()) {
+    return false;
+  }
+  if (typed->HasValue() && **typed->value_ != *static_cast<const TrieNodeWithValue<uint32_t> *>(dynamic)->value_) {
+    return false;
+  }
+  for (const auto &[ch, child] : typed->children_) {
+    const auto *other = dynamic->children_.Lookup(ch);
+    if (other == nullptr || !SameShape(child.get(), other->get())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+TEST(TypedTrieTest, BasicTest) {
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto trie = TypedTrie<std::string>(layout);
+    ASSERT_TRUE(trie.Get("") == nullptr);
+    trie = trie.Put("test", "233").Put("te", "23").Put("", "root");
+    ASSERT_EQ(*trie.Get("test"), "233");
+    ASSERT_EQ(*trie.Get("te"), "23");
+    ASSERT_EQ(*trie.Get(""), "root");
+    ASSERT_TRUE(trie.Get("tes") == nullptr);
+    ASSERT_TRUE(trie.Get("tester") == nullptr);
+
+    // Writes leave older versions untouched
+    auto removed = trie.Remove("te").Put("test", "2333");
+    ASSERT_EQ(*trie.Get("te"), "23");
+    ASSERT_EQ(*trie.Get("test"), "233");
+    ASSERT_TRUE(removed.Get("te") == nullptr);
+    ASSERT_EQ(*removed.Get("test"), "2333");
+    ASSERT_TRUE(removed.Remove("missing").GetRoot() == removed.GetRoot());
+    ASSERT_TRUE(removed.Remove("test").Remove("").GetRoot() == nullptr);
+  }
+}
+
+TEST(TypedTrieTest, SameShapeAsTrieTest) {
+  // A TypedTrie shares the write path of Trie, so the same writes build the same nodes
+  std::mt19937 rng(233);
+  for (auto layout : {TrieLayout::kPerCharacter, TrieLayout::kPathCompressed}) {
+    auto typed = TypedTrie<uint32_t>(layout);
+    auto dynamic = Trie(layout);
+    for (int i = 0; i < 3000; i++) {
+      std::string key(rng() % 8, 'a');
+      for (auto &c : key) {
+        c = static_cast<char>('a' + rng() % 4);
+      }
+      if (rng() % 3 == 0) {
+        typed = typed.Remove(key);
+        dynamic = dynamic.Remove(key);
+      } else {
+        typed = typed.Put(key, i);
+        dynamic = dynamic.Put<uint32_t>(key, i);
+      }
+      ASSERT_TRUE(typed.Get(key) == nullptr ? dynamic.Get<uint32_t>(key) == nullptr
+                                            : *typed.Get(key) == *dynamic.Get<uint32_t>(key));
+    }
+    ASSERT_TRUE(SameShape(typed.GetRoot().get(), dynamic.GetRoot().get()));
+  }
+}
+
+TEST(TypedTrieTest, NonCopyableTest) {
+  auto pool = NodePool::Create();
+  auto trie = TypedTrie<std::unique_ptr<uint32_t>>(TrieLayout::kPathCompressed, pool);
+  trie = trie.Put("key1", std::make_unique<uint32_t>(1)).Put("key2", std::make_unique<uint32_t>(2));
+  auto next = trie.Put("key3", std::make_unique<uint32_t>(3));
+  // The values are shared by both versions, not copied
+  ASSERT_EQ(**trie.Get("key1"), 1);
+  ASSERT_TRUE(trie.Get("key1") == next.Get("key1"));
+  ASSERT_EQ(**next.Get("key3"), 3);
+  ASSERT_TRUE(trie.Get("key3") == nullptr);
+  ASSERT_TRUE(next.GetNodePool() == pool);
+}
+
+TEST(TypedTrieTest, NoVirtualDispatchTest) {
+  auto before = TrieMetrics::Collect();
+  auto trie = TypedTrie<uint32_t>(TrieLayout::kPathCompressed);
+  for (uint32_t i = 0; i < 100; i++) {
+    trie = trie.Put("key/" + std::to_string(i), i);
+  }
+  trie = trie.Remove("key/50");
+  for (uint32_t i = 0; i < 100; i++) {
+    trie.Get("key/" + std::to_string(i));
+  }
+  auto after = TrieMetrics::Collect();
+  auto delta = [&](TrieCounter counter) {
+    return after[static_cast<size_t>(counter)] - before[static_cast<size_t>(counter)];
+  };
+  ASSERT_EQ(delta(TrieCounter::kVirtualClones), 0);
+  ASSERT_EQ(delta(TrieCounter::kTypeChecks), 0);
+  if (TrieMetrics::kEnabled) {
+    ASSERT_EQ(delta(TrieCounter::kPuts), 100);
+    ASSERT_EQ(delta(TrieCounter::kGets), 100);
+    ASSERT_TRUE(delta(TrieCounter::kPathCopies) > 0);
+  }
+}
+
+}  // namespace bustub
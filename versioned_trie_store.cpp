@@ -0,0 +1,131 @@
+#include "versioned_trie_store.h"
+
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+namespace bustub {
+
+VersionedTrieStore::VersionedTrieStore(size_t keep_last, std::chrono::steady_clock::duration keep_for,
+                                       TrieLayout layout)
+    : keep_last_(keep_last), keep_for_(keep_for) {
+  if (keep_last == 0) {
+    throw std::invalid_argument("VersionedTrieStore: the latest version must be retained");
+  }
+  auto trie = std::make_shared<const Trie>(layout);
+  versions_.emplace(0, Version{trie, trie, std::chrono::steady_clock::now(), {}});
+}
+
+template <class T>
+auto VersionedTrieStore::Put(std::string_view key, T value) -> uint64_t {
+  std::lock_guard<std::mutex> guard(write_lock_);
+  return Publish(Snapshot().GetTrie().Put<T>(key, std::move(value)));
+}
+
+auto VersionedTrieStore::Remove(std::string_view key) -> uint64_t {
+  std::lock_guard<std::mutex> guard(write_lock_);
+  return Publish(Snapshot().GetTrie().Remove(key));
+}
+
+auto VersionedTrieStore::Apply(WriteBatch batch) -> uint64_t {
+  std::lock_guard<std::mutex> guard(write_lock_);
+  return Publish(Snapshot().GetTrie().Apply(std::move(batch)));
+}
+
+auto VersionedTrieStore::Snapshot() const -> VersionedSnapshot {
+  std::lock_guard<std::mutex> guard(latch_);
+  return *Open(std::prev(versions_.end()));
+}
+
+auto VersionedTrieStore::Snapshot(uint64_t version) const -> std::optional<VersionedSnapshot> {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = versions_.find(version);
+  if (it == versions_.end()) {
+    return std::nullopt;
+  }
+  return Open(it);
+}
+
+auto VersionedTrieStore::SnapshotAsOf(std::chrono::steady_clock::time_point time) const
+    -> std::optional<VersionedSnapshot> {
+  std::lock_guard<std::mutex> guard(latch_);
+  // Commit times grow with version numbers: look for the newest version committed by `time`
+  for (auto it = versions_.end(); it != versions_.begin();) {
+    --it;
+    if (it->second.commit_time_ <= time) {
+      // It was current at `time`, unless a version collected since had already replaced it
+      bool replaced = std::next(it) != versions_.end() && it->second.replaced_time_ <= time;
+      if (replaced) {
+        return std::nullopt;
+      }
+      return Open(it);
+    }
+  }
+  return std::nullopt;
+}
+
+auto VersionedTrieStore::LatestVersion() const -> uint64_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  return versions_.rbegin()->first;
+}
+
+auto VersionedTrieStore::VersionCount() const -> size_t {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t count = 0;
+  for (const auto &[number, version] : versions_) {
+    count += version.trie_.expired() ? 0 : 1;
+  }
+  return count;
+}
+
+auto VersionedTrieStore::Open(std::map<uint64_t, Version>::const_iterator it) const
+    -> std::optional<VersionedSnapshot> {
+  auto trie = it->second.trie_.lock();
+  if (trie == nullptr) {
+    return std::nullopt;
+  }
+  return VersionedSnapshot(std::move(trie), it->first, it->second.commit_time_);
+}
+
+auto VersionedTrieStore::Publish(Trie trie) -> uint64_t {
+  auto next = std::make_shared<const Trie>(std::move(trie));
+  auto now = std::chrono::steady_clock::now();
+
+  // Dropped after the latch is released: freeing a version can take a while
+  std::vector<std::shared_ptr<const Trie>> released;
+  std::lock_guard<std::mutex> guard(latch_);
+  auto &latest = versions_.rbegin()->second;
+  latest.replaced_time_ = now;
+  uint64_t number = versions_.rbegin()->first + 1;
+  versions_.emplace_hint(versions_.end(), number, Version{next, next, now, {}});
+
+  // Older versions are replaced earlier and have smaller numbers, so the versions no longer retained are exactly the
+  // ones before the first retained version.
+  for (auto it = versions_.begin(); it != versions_.end();) {
+    bool by_count = number - it->first < keep_last_;
+    bool by_age = now - it->second.replaced_time_ < keep_for_;
+    if (by_count || by_age) {
+      break;
+    }
+    if (it->second.retained_ != nullptr) {
+      released.push_back(std::move(it->second.retained_));
+    }
+    // A collected version is forgotten once no reader holds it. `released` still holds it if it was retained until
+    // now, so it is only forgotten by a later write.
+    it = it->second.trie_.expired() ? versions_.erase(it) : std::next(it);
+  }
+  return number;
+}
+
+// Below are explicit instantiation of template functions.
+
+template auto VersionedTrieStore::Put(std::string_view key, uint32_t value) -> uint64_t;
+template auto VersionedTrieStore::Put(std::string_view key, uint64_t value) -> uint64_t;
+template auto VersionedTrieStore::Put(std::string_view key, std::string value) -> uint64_t;
+
+using Integer = std::unique_ptr<uint32_t>;
+
+template auto VersionedTrieStore::Put(std::string_view key, Integer value) -> uint64_t;
+template auto VersionedTrieStore::Put(std::string_view key, MoveBlocked value) -> uint64_t;
+
+}  // namespace bustub
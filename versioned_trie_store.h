@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// versioned_trie_store.h
+//
+// Identification: src/include/primer/versioned_trie_store.h
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
+#include <string_view>
+#include <utility>
+
+#include "trie.h"
+
+namespace bustub {
+
+// One version of a VersionedTrieStore. Holding it keeps the version alive, and openable with
+// `VersionedTrieStore::Snapshot(version)`, even once the store no longer retains it.
+class VersionedSnapshot {
+ public:
+  template <class T>
+  auto Get(std::string_view key) const -> const T * {
+    return trie_->Get<T>(key);
+  }
+
+  auto GetTrie() const -> const Trie & { return *trie_; }
+
+  // The version number: 0 for the empty store, then one more per write.
+  auto Version() const -> uint64_t { return version_; }
+
+  // When the write that produced this version was committed.
+  auto CommitTime() const -> std::chrono::steady_clock::time_point { return commit_time_; }
+
+ private:
+  friend class VersionedTrieStore;
+
+  VersionedSnapshot(std::shared_ptr<const Trie> trie, uint64_t version, std::chrono::steady_clock::time_point time)
+      : trie_(std::move(trie)), version_(version), commit_time_(time) {}
+
+  std::shared_ptr<const Trie> trie_;
+  uint64_t version_;
+  std::chrono::steady_clock::time_point commit_time_;
+};
+
+// A VersionedTrieStore keeps past versions of a trie for "as-of" reads: every write creates a new version, and a
+// reader can open the latest version, a given version, or the version that was current at a given time. Versions
+// share every node that did not change between them, so retaining one costs only the nodes its successor rewrote.
+//
+// The store retains the `keep_last` newest versions, plus every version replaced less than `keep_for` ago. Other
+// versions are garbage-collected when the last reader holding them releases its VersionedSnapshot: until then they
+// can still be opened by number.
+class VersionedTrieStore {
+ public:
+  static constexpr size_t kDefaultKeepLast = 16;
+
+  explicit VersionedTrieStore(size_t keep_last = kDefaultKeepLast,
+                              std::chrono::steady_clock::duration keep_for = std::chrono::steady_clock::duration::zero(),
+                              TrieLayout layout = TrieLayout::kPerCharacter);
+
+  // Write, and return the new version number.
+  template <class T>
+  auto Put(std::string_view key, T value) -> uint64_t;
+
+  auto Remove(std::string_view key) -> uint64_t;
+
+  auto Apply(WriteBatch batch) -> uint64_t;
+
+  // Open the latest version.
+  auto Snapshot() const -> VersionedSnapshot;
+
+  // Open the version numbered `version`, or std::nullopt if it has been garbage-collected or does not exist yet.
+  auto Snapshot(uint64_t version) const -> std::optional<VersionedSnapshot>;
+
+  // Open the latest version committed at or before `time`, or std::nullopt if that version has been
+  // garbage-collected.
+  auto SnapshotAsOf(std::chrono::steady_clock::time_point time) const -> std::optional<VersionedSnapshot>;
+
+  auto LatestVersion() const -> uint64_t;
+
+  // Number of versions that can still be opened.
+  auto VersionCount() const -> size_t;
+
+ private:
+  struct Version {
+    // Set while the store retains the version.
+    std::shared_ptr<const Trie> retained_;
+    // Lets readers reopen the version as long as any of them holds it.
+    std::weak_ptr<const Trie> trie_;
+    std::chrono::steady_clock::time_point commit_time_;
+    // When the next version was committed. Unset for the latest version.
+    std::chrono::steady_clock::time_point replaced_time_;
+  };
+
+  // Publish `trie` as a new version and collect the versions that are no longer retained. The caller must hold
+  // `write_lock_`.
+  auto Publish(Trie trie) -> uint64_t;
+
+  // Open the version `it` points to if it is still alive. The caller must hold `latch_`.
+  auto Open(std::map<uint64_t, Version>::const_iterator it) const -> std::optional<VersionedSnapshot>;
+
+  const size_t keep_last_;
+  const std::chrono::steady_clock::duration keep_for_;
+
+  // Sequences all writes.
+  std::mutex write_lock_;
+
+  // Protects `versions_`.
+  mutable std::mutex latch_;
+  // Every version that can still be opened, by number. The latest one is always retained.
+  std::map<uint64_t, Version> versions_;
+};
+
+}  // namespace bustub
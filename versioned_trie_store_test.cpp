@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// versioned_trie_store_test.cpp
+//
+// Identification: test/primer/versioned_trie_store_test.cpp
+//
+// Copyright (c) 2015-2025, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "test.h"
+#include "versioned_trie_store.h"
+
+namespace bustub {
+
+TEST(VersionedTrieStoreTest, RetentionTest) {
+  auto store = VersionedTrieStore(4);
+  ASSERT_EQ(store.LatestVersion(), 0);
+  for (uint32_t i = 1; i <= 10; i++) {
+    ASSERT_EQ(store.Put<uint32_t>("key", i), i);
+  }
+  ASSERT_EQ(store.Remove("key"), 11);
+
+  // Versions 8 to 11 are retained.
+  ASSERT_EQ(store.VersionCount(), 4);
+  ASSERT_TRUE(!store.Snapshot(7).has_value());
+  ASSERT_TRUE(!store.Snapshot(12).has_value());
+  ASSERT_EQ(*store.Snapshot(8)->Get<uint32_t>("key"), 8);
+  ASSERT_EQ(store.Snapshot(11)->Get<uint32_t>("key"), nullptr);
+  ASSERT_EQ(store.Snapshot().Version(), 11);
+}
+
+TEST(VersionedTrieStoreTest, ReaderHoldsVersionTest) {
+  auto store = VersionedTrieStore(2);
+  store.Put<std::string>("report", "draft");
+  auto report = store.Snapshot();
+  ASSERT_EQ(report.Version(), 1);
+  for (uint32_t i = 0; i < 100; i++) {
+    store.Put<std::string>("report", "edit " + std::to_string(i));
+  }
+
+  // No longer retained, but the reader still holds it: it can be reopened and read.
+  ASSERT_EQ(*report.Get<std::string>("report"), "draft");
+  auto reopened = store.Snapshot(1);
+  ASSERT_TRUE(reopened.has_value());
+  ASSERT_EQ(*reopened->Get<std::string>("report"), "draft");
+  ASSERT_EQ(store.VersionCount(), 3);
+
+  // Once the last reader releases it, it is gone.
+  std::weak_ptr<const TrieNode> root = report.GetTrie().GetRoot();
+  reopened.reset();
+  report = store.Snapshot();
+  store.Put<std::string>("report", "final");
+  ASSERT_TRUE(root.expired());
+  ASSERT_TRUE(!store.Snapshot(1).has_value());
+  ASSERT_EQ(store.VersionCount(), 2);
+}
+
+TEST(VersionedTrieStoreTest, AsOfTest) {
+  auto store = VersionedTrieStore(1, std::chrono::hours(1));
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::chrono::steady_clock::time_point> times;
+  for (uint32_t i = 1; i <= 5; i++) {
+    store.Put<uint32_t>("balance", i * 100);
+    times.push_back(std::chrono::steady_clock::now());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  // Versions replaced within the hour are retained, whatever `keep_last` says.
+  ASSERT_EQ(store.VersionCount(), 6);
+  for (uint32_t i = 1; i <= 5; i++) {
+    auto snapshot = store.SnapshotAsOf(times[i - 1]);
+    ASSERT_EQ(snapshot->Version(), i);
+    ASSERT_EQ(*snapshot->Get<uint32_t>("balance"), i * 100);
+  }
+  ASSERT_EQ(store.SnapshotAsOf(start)->Version(), 0);
+  // Before the store was created
+  ASSERT_TRUE(!store.SnapshotAsOf(start - std::chrono::hours(1)).has_value());
+
+  // Without the age rule, the versions current at these times are collected.
+  auto short_lived = VersionedTrieStore(1);
+  short_lived.Put<uint32_t>("balance", 1);
+  auto before = std::chrono::steady_clock::now();
+  short_lived.Put<uint32_t>("balance", 2);
+  ASSERT_TRUE(!short_lived.SnapshotAsOf(before).has_value());
+  ASSERT_EQ(short_lived.SnapshotAsOf(std::chrono::steady_clock::now())->Version(), 2);
+}
+
+TEST(VersionedTrieStoreTest, ConcurrentReportTest) {
+  auto store = VersionedTrieStore(8);
+  std::atomic<bool> stop{false};
+  std::thread writer([&] {
+    for (uint32_t i = 1; i <= 5000; i++) {
+      // Both keys always change together
+      WriteBatch batch;
+      batch.Put<uint32_t>("debit", i);
+      batch.Put<uint32_t>("credit", i);
+      store.Apply(std::move(batch));
+    }
+    stop = true;
+  });
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 2; t++) {
+    readers.emplace_back([&] {
+      while (!stop.load()) {
+        auto snapshot = store.Snapshot();
+        const auto *debit = snapshot.Get<uint32_t>("debit");
+        const auto *credit = snapshot.Get<uint32_t>("credit");
+        ASSERT_TRUE((debit == nullptr) == (credit == nullptr));
+        if (debit != nullptr) {
+          ASSERT_EQ(*debit, *credit);
+          ASSERT_EQ(*debit, snapshot.Version());
+        }
+      }
+    });
+  }
+  writer.join();
+  for (auto &t : readers) {
+    t.join();
+  }
+  ASSERT_EQ(store.VersionCount(), 8);
+}
+
+}  // namespace bustub